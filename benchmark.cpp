@@ -0,0 +1,1341 @@
+/**
+ * Student Information System - Benchmarks
+ *
+ * This program measures the data structures of the system on synthetic
+ * data sets. Run it without arguments to execute every benchmark.
+ */
+
+#include "student.h"    // Include student structure definitions
+#include "student_parser.h" // Include the memory-mapped loader
+#include "student_snapshot.h" // Include the binary snapshot format
+#include "grade_scale.h" // Include the batch grade conversion
+#include "student_analytics.h" // Include the cohort statistics
+#include "grade_import.h" // Include the grade sheet import
+#include "student_export.h" // Include the export writers
+#include "student_replicas.h" // Include the replicas for concurrent readers
+#include "student_journal.h" // Include the journal for the edit benchmark
+#include "student_edit.h" // Include staged course and study plan changes
+#include "student_repository.h" // Include the storage engines
+#include <iostream>     // Include for console output
+#include <iomanip>      // Include for output formatting
+#include <fstream>      // Include for writing the synthetic data file
+#include <sstream>      // Include for the legacy line parser
+#include <chrono>       // Include for timing
+#include <cstdio>       // Include for remove
+#include <cstring>      // Include for strlen
+#include <cmath>        // Include for fabs
+#include <strings.h>    // Include for strcasecmp
+#include <algorithm>    // Include for transform
+#include <thread>       // Include for hardware_concurrency and the reader threads
+#include <atomic>       // Include for stopping the reader threads
+#include <shared_mutex> // Include for the locked baseline of concurrent reads
+#include <sys/stat.h>   // Include for stat (file sizes)
+
+// Scratch files used by the loader and snapshot benchmarks
+static const char BENCH_FILENAME[] = "benchmark_students.txt";
+static const char BENCH_SNAPSHOT_FILENAME[] = "benchmark_students.dat";
+
+// Global store required by the linked modules
+StudentStore students;
+
+/**
+ * Course and student layout used before the StudentStore, kept for comparison
+ */
+struct LegacyCourse {
+    string name;
+    float grade;
+};
+
+struct LegacyStudent {
+    int id;
+    string name;
+    string nationalId;
+    LegacyCourse courses[MAX_COURSES];
+    int numCourses = 0;
+    float gpa = 0.0;
+    string studyPlan[MAX_STUDY_PLAN];
+    int numStudyPlan = 0;
+};
+
+// Synthetic course names shared by every generated student
+static const char* const COURSE_NAMES[] = {
+    "Mathematics", "Database Systems", "Physics", "Operating Systems", "Chemistry"
+};
+static const int NUM_COURSE_NAMES = 5;
+
+/**
+ * Seconds elapsed since the given start time
+ */
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Approximate heap bytes owned by a string (zero while it fits the small buffer)
+ */
+static size_t heapBytes(const string& s) {
+    static const size_t inlineCapacity = string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+/**
+ * Fill a student record with synthetic data
+ */
+static Student makeStudent(int i) {
+    Student s;
+    s.id = 100000 + i;
+    s.name = "Student Number " + to_string(i);
+    s.nationalId = "29901011234567";
+    return s;
+}
+
+/**
+ * Compare memory use and fill time of the legacy layout and the StudentStore
+ */
+static void benchmarkStudentStore() {
+    const int sizes[] = { 100, 10000, 1000000 };
+    const int coursesPerStudent = 3;
+    const int planPerStudent = 2;
+
+    cout << "\nStudent storage (" << coursesPerStudent << " courses, "
+         << planPerStudent << " plan entries per student)\n";
+    cout << "Records\tLegacy MB\tLegacy s\tStore MB\tStore s\n";
+
+    for (int n : sizes) {
+        // Legacy layout: every record carries all course and plan slots inline
+        auto start = chrono::steady_clock::now();
+        vector<LegacyStudent> legacy(n);
+        for (int i = 0; i < n; i++) {
+            Student s = makeStudent(i);
+            LegacyStudent& l = legacy[i];
+            l.id = s.id;
+            l.name = s.name;
+            l.nationalId = s.nationalId;
+            for (int c = 0; c < coursesPerStudent; c++) {
+                l.courses[c].name = COURSE_NAMES[(i + c) % NUM_COURSE_NAMES];
+                l.courses[c].grade = 60.0f + (i + c) % 40;
+            }
+            l.numCourses = coursesPerStudent;
+            for (int p = 0; p < planPerStudent; p++) {
+                l.studyPlan[p] = COURSE_NAMES[(i + p + 3) % NUM_COURSE_NAMES];
+            }
+            l.numStudyPlan = planPerStudent;
+        }
+        double legacySeconds = secondsSince(start);
+        size_t legacyBytes = legacy.capacity() * sizeof(LegacyStudent);
+        for (const LegacyStudent& l : legacy) {
+            legacyBytes += heapBytes(l.name) + heapBytes(l.nationalId);
+            for (int c = 0; c < MAX_COURSES; c++) legacyBytes += heapBytes(l.courses[c].name);
+            for (int p = 0; p < MAX_STUDY_PLAN; p++) legacyBytes += heapBytes(l.studyPlan[p]);
+        }
+        vector<LegacyStudent>().swap(legacy);
+
+        // StudentStore: records plus shared pools
+        start = chrono::steady_clock::now();
+        StudentStore store;
+        for (int i = 0; i < n; i++) {
+            int index = store.add(makeStudent(i));
+            for (int c = 0; c < coursesPerStudent; c++) {
+                store.addCourse(index, Course(COURSE_NAMES[(i + c) % NUM_COURSE_NAMES], 60.0f + (i + c) % 40));
+            }
+            for (int p = 0; p < planPerStudent; p++) {
+                store.addStudyPlanEntry(index, COURSE_NAMES[(i + p + 3) % NUM_COURSE_NAMES]);
+            }
+        }
+        double storeSeconds = secondsSince(start);
+        size_t storeBytes = store.memoryUsage() + courseNames.memoryUsage();
+
+        cout << n << "\t" << fixed << setprecision(2)
+             << legacyBytes / 1048576.0 << "\t\t" << setprecision(4) << legacySeconds << "\t\t"
+             << setprecision(2) << storeBytes / 1048576.0 << "\t\t"
+             << setprecision(4) << storeSeconds << "\n";
+    }
+}
+
+/**
+ * Compare ID lookup by linear scan, by the hash index and by batch lookup
+ */
+static void benchmarkIdLookup() {
+    const int sizes[] = { 1000, 100000, 1000000 };
+    const int hashLookups = 1000000;
+    const int scanLookups = 200;
+
+    cout << "\nStudent ID lookup (ns per lookup)\n";
+    cout << "Records\tLinear scan\tHash index\tBatch lookup\n";
+
+    for (int n : sizes) {
+        StudentStore store;
+        store.reserve(n, 0, 0);
+        for (int i = 0; i < n; i++) store.add(makeStudent(i));
+
+        // IDs spread over the whole store, about one in ten absent
+        vector<int> ids(hashLookups);
+        for (int i = 0; i < hashLookups; i++) {
+            ids[i] = 100000 + (int)(((long long)i * 7919) % (n + n / 10));
+        }
+
+        long long checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < scanLookups; i++) {
+            int found = -1;
+            for (int j = 0; j < store.size(); j++) {
+                if (store[j].id == ids[i]) { found = j; break; }
+            }
+            checksum += found;
+        }
+        double scanNs = secondsSince(start) * 1e9 / scanLookups;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < hashLookups; i++) checksum += store.find(ids[i]);
+        double hashNs = secondsSince(start) * 1e9 / hashLookups;
+
+        vector<int> indices;
+        start = chrono::steady_clock::now();
+        store.findBatch(ids, indices);
+        double batchNs = secondsSince(start) * 1e9 / hashLookups;
+        for (int index : indices) checksum += index;
+
+        cout << n << "\t" << fixed << setprecision(1) << scanNs << "\t\t"
+             << hashNs << "\t\t" << batchNs << "\t(checksum " << checksum << ")\n";
+    }
+}
+
+/**
+ * Write a synthetic students file in the format of saveStudents()
+ */
+static void writeSyntheticFile(const char* path, int n) {
+    ofstream file(path);
+    for (int i = 0; i < n; i++) {
+        Student s = makeStudent(i);
+        int numCourses = i % 4;
+        file << s.id << "," << s.name << "," << s.nationalId << "," << numCourses << ",";
+        for (int c = 0; c < numCourses; c++) {
+            file << COURSE_NAMES[(i + c) % NUM_COURSE_NAMES] << ":" << 60 + (i + c) % 40;
+            if (c < numCourses - 1) file << ",";
+        }
+        file << "," << 2.5 << "," << 2 << ","
+             << COURSE_NAMES[(i + 3) % NUM_COURSE_NAMES] << ","
+             << COURSE_NAMES[(i + 4) % NUM_COURSE_NAMES] << "\n";
+    }
+}
+
+/**
+ * The getline/stringstream loader used before the memory-mapped parser
+ */
+static void legacyLoad(const char* path, StudentStore& store) {
+    ifstream file(path);
+    string line;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+        try {
+            Student s;
+            vector<LegacyCourse> courses;
+            vector<string> studyPlan;
+            stringstream ss(line);
+            string token;
+            getline(ss, token, ',');
+            s.id = stoi(token);
+            getline(ss, s.name, ',');
+            getline(ss, s.nationalId, ',');
+            getline(ss, token, ',');
+            int numCourses = stoi(token);
+            for (int i = 0; i < numCourses; i++) {
+                LegacyCourse c;
+                getline(ss, c.name, ':');
+                getline(ss, token, ',');
+                c.grade = token.empty() ? 0.0f : stof(token);
+                courses.push_back(c);
+            }
+            getline(ss, token, ',');
+            s.gpa = token.empty() ? 0.0f : stof(token);
+            getline(ss, token, ',');
+            int numStudyPlan = token.empty() ? 0 : stoi(token);
+            for (int i = 0; i < numStudyPlan; i++) {
+                string entry;
+                if (i == numStudyPlan - 1) getline(ss, entry);
+                else getline(ss, entry, ',');
+                studyPlan.push_back(entry);
+            }
+            int index = store.add(s);
+            if (index == -1) continue;
+            for (const LegacyCourse& c : courses) store.addCourse(index, Course(c.name, c.grade));
+            for (const string& entry : studyPlan) store.addStudyPlanEntry(index, entry);
+        } catch (const exception&) {
+            continue;
+        }
+    }
+}
+
+/**
+ * Compare the legacy loader with the memory-mapped parser on a 1M-line file
+ */
+static void benchmarkLoader() {
+    const int n = 1000000;
+    writeSyntheticFile(BENCH_FILENAME, n);
+
+    cout << "\nLoading a " << n << "-line students file (seconds)\n";
+    cout << "Legacy loader\tMapped parse\tMapped load\n";
+
+    StudentStore legacyStore;
+    auto start = chrono::steady_clock::now();
+    legacyLoad(BENCH_FILENAME, legacyStore);
+    double legacySeconds = secondsSince(start);
+
+    // Parse alone, then parse plus copying into a store
+    MappedFile mapped;
+    ParsedFile parsed;
+    start = chrono::steady_clock::now();
+    mapped.open(BENCH_FILENAME);
+    parseStudentBuffer(mapped.data(), mapped.size(), 1, parsed);
+    double parseSeconds = secondsSince(start);
+    mapped.close();
+
+    StudentStore store;
+    vector<ParseError> errors;
+    start = chrono::steady_clock::now();
+    loadStudentsFromFile(BENCH_FILENAME, store, errors);
+    double loadSeconds = secondsSince(start);
+
+    cout << fixed << setprecision(3) << legacySeconds << "\t\t" << parseSeconds
+         << "\t\t" << loadSeconds << "\t(" << legacyStore.size() << " / "
+         << parsed.students.size() << " / " << store.size() << " students, "
+         << errors.size() << " errors)\n";
+
+    // Parallel chunked loading
+    cout << "Threads\tParallel load s\tSpeedup\n";
+    double baseSeconds = 0.0;
+    for (int threads : { 1, 2, 4, 8 }) {
+        StudentStore parallelStore;
+        errors.clear();
+        start = chrono::steady_clock::now();
+        loadStudentsFromFile(BENCH_FILENAME, parallelStore, errors, threads);
+        double seconds = secondsSince(start);
+        if (threads == 1) baseSeconds = seconds;
+        cout << threads << "\t" << setprecision(3) << seconds << "\t\t"
+             << setprecision(2) << baseSeconds / seconds << "x\n";
+    }
+    cout << "(" << thread::hardware_concurrency() << " hardware threads available)\n";
+    remove(BENCH_FILENAME);
+}
+
+/**
+ * Size of a file in bytes
+ */
+static long long fileBytes(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0 ? (long long)info.st_size : 0;
+}
+
+/**
+ * Compare save/load throughput and file size of the text and binary formats
+ */
+static void benchmarkSnapshot() {
+    const int n = 1000000;
+    writeSyntheticFile(BENCH_FILENAME, n);
+    StudentStore store;
+    vector<ParseError> errors;
+    loadStudentsFromFile(BENCH_FILENAME, store, errors);
+
+    cout << "\nSaving and loading " << n << " students (seconds, MB)\n";
+    cout << "Format\tSave s\tLoad s\tFile MB\tLoad MB/s\n";
+
+    auto start = chrono::steady_clock::now();
+    writeStudentsFile(BENCH_FILENAME, store);
+    double textSave = secondsSince(start);
+    StudentStore textStore;
+    errors.clear();
+    start = chrono::steady_clock::now();
+    loadStudentsFromFile(BENCH_FILENAME, textStore, errors);
+    double textLoad = secondsSince(start);
+    double textMb = fileBytes(BENCH_FILENAME) / 1048576.0;
+
+    start = chrono::steady_clock::now();
+    writeStudentSnapshot(BENCH_SNAPSHOT_FILENAME, store);
+    double binarySave = secondsSince(start);
+    StudentStore binaryStore;
+    string error;
+    start = chrono::steady_clock::now();
+    loadStudentSnapshot(BENCH_SNAPSHOT_FILENAME, binaryStore, error);
+    double binaryLoad = secondsSince(start);
+    double binaryMb = fileBytes(BENCH_SNAPSHOT_FILENAME) / 1048576.0;
+
+    cout << fixed << "Text\t" << setprecision(3) << textSave << "\t" << textLoad << "\t"
+         << setprecision(1) << textMb << "\t" << textMb / textLoad << "\n";
+    cout << "Binary\t" << setprecision(3) << binarySave << "\t" << binaryLoad << "\t"
+         << setprecision(1) << binaryMb << "\t" << binaryMb / binaryLoad
+         << "\t(" << textStore.size() << " / " << binaryStore.size() << " students)\n";
+    remove(BENCH_FILENAME);
+    remove(BENCH_SNAPSHOT_FILENAME);
+}
+
+/**
+ * Compare a full GPA recompute (serial and parallel) with incremental upkeep
+ */
+static void benchmarkGpa() {
+    const int n = 1000000;
+    const int coursesPerStudent = 5;
+    StudentStore store;
+    store.reserve(n, n * coursesPerStudent, 0);
+    for (int i = 0; i < n; i++) {
+        int index = store.add(makeStudent(i));
+        for (int c = 0; c < coursesPerStudent; c++) {
+            store.addCourse(index, Course{ COURSE_NAMES[(i + c) % NUM_COURSE_NAMES],
+                                           50.0f + (i * 7 + c * 13) % 50 });
+        }
+    }
+
+    cout << "\nGPA upkeep for " << n << " students with " << coursesPerStudent << " courses\n";
+
+    // One grade change: running-sum update versus walking the student's courses
+    const int changes = 1000000;
+    float checksum = 0.0f;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++) {
+        int index = (int)(((long long)i * 7919) % n);
+        store.setCourseGrade(index, i % coursesPerStudent, 50.0f + i % 50);
+        checksum += store[index].gpa;
+    }
+    double incrementalNs = secondsSince(start) * 1e9 / changes;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++) checksum += calculateGPA(store, (int)(((long long)i * 7919) % n));
+    double walkNs = secondsSince(start) * 1e9 / changes;
+    cout << "Per grade change: incremental " << fixed << setprecision(1) << incrementalNs
+         << " ns, full walk " << walkNs << " ns\n";
+
+    // Repair path over the whole store
+    cout << "Threads\tRecompute all s\n";
+    for (int threads : { 1, 2, 4 }) {
+        start = chrono::steady_clock::now();
+        int repaired = recomputeAllGPAs(store, threads);
+        cout << threads << "\t" << setprecision(3) << secondsSince(start)
+             << "\t(" << repaired << " GPAs changed, checksum " << setprecision(1) << checksum << ")\n";
+    }
+}
+
+/**
+ * The if/else chain convertGradeTo4Scale() used before the GradeScale
+ */
+static float legacyConvertGrade(float numericGrade) {
+    if (numericGrade >= 93.0) return 4.00;
+    else if (numericGrade >= 90.0) return 3.70;
+    else if (numericGrade >= 87.0) return 3.33;
+    else if (numericGrade >= 83.0) return 3.00;
+    else if (numericGrade >= 80.0) return 2.70;
+    else if (numericGrade >= 77.0) return 2.30;
+    else if (numericGrade >= 73.0) return 2.00;
+    else if (numericGrade >= 70.0) return 1.70;
+    else if (numericGrade >= 67.0) return 1.30;
+    else if (numericGrade >= 63.0) return 1.00;
+    else if (numericGrade >= 60.0) return 0.70;
+    else return 0.00;
+}
+
+/**
+ * Compare the legacy if/else chain with the batch grade conversions
+ */
+static void benchmarkGradeConversion() {
+    const int n = 10000000;
+    vector<float> grades(n), points(n);
+    for (int i = 0; i < n; i++) grades[i] = (float)((i * 7919LL) % 1001) / 10.0f;   // 0.0 to 100.0
+
+    cout << "\nConverting " << n << " grades to the 4.0 scale (ns per grade)\n";
+    cout << "Method\t\tns\tMismatches\n";
+
+    vector<float> expected(n);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) expected[i] = legacyConvertGrade(grades[i]);
+    cout << "If/else chain\t" << fixed << setprecision(2) << secondsSince(start) * 1e9 / n << "\t-\n";
+
+    const GradeScale& scale = gradeScale();
+    const struct { GradeKernel kernel; const char* name; } kernels[] = {
+        { GRADE_KERNEL_SCALAR, "Batch table" }, { GRADE_KERNEL_SSE2, "Batch SSE2" },
+        { GRADE_KERNEL_AVX2, "Batch AVX2" }
+    };
+    for (const auto& k : kernels) {
+        if (!GradeScale::kernelSupported(k.kernel)) {
+            cout << k.name << "\tnot supported by this CPU\n";
+            continue;
+        }
+        start = chrono::steady_clock::now();
+        scale.convertBatch(grades.data(), points.data(), n, k.kernel);
+        double ns = secondsSince(start) * 1e9 / n;
+        int mismatches = 0;
+        for (int i = 0; i < n; i++) mismatches += points[i] != expected[i];
+        cout << k.name << "\t" << ns << "\t" << mismatches << "\n";
+    }
+}
+
+/**
+ * Compare sorting indices per listing with the maintained orders
+ */
+static void benchmarkOrders() {
+    const int n = 100000;
+    const int changes = 10000;
+    StudentStore store;
+    store.reserve(n + changes, n, 0);
+    for (int i = 0; i < n; i++) {
+        Student s = makeStudent((int)(((long long)i * 7919) % n));   // IDs and names out of order
+        int index = store.add(std::move(s));
+        store.addCourse(index, Course{ COURSE_NAMES[i % NUM_COURSE_NAMES], (float)(50 + i % 50) });
+    }
+
+    cout << "\nListing " << n << " students in order (ms)\n";
+    cout << "Order	Sort indices	First view	Maintained view\n";
+    const struct { StudentOrder by; const char* name; } orderNames[] = {
+        { ORDER_BY_ID, "ID" }, { ORDER_BY_NAME, "Name" }, { ORDER_BY_GPA, "GPA" }
+    };
+    long long checksum = 0;
+    for (const auto& o : orderNames) {
+        auto less = [&store, &o](int a, int b) {
+            const Student& x = store[a];
+            const Student& y = store[b];
+            if (o.by == ORDER_BY_NAME && x.name != y.name) return x.name < y.name;
+            if (o.by == ORDER_BY_GPA && x.gpa != y.gpa) return x.gpa > y.gpa;
+            return x.id < y.id;
+        };
+        auto start = chrono::steady_clock::now();
+        vector<int> order(store.size());
+        for (int i = 0; i < store.size(); i++) order[i] = i;
+        sort(order.begin(), order.end(), less);
+        for (int index : order) checksum += store[index].id;
+        double sortMs = secondsSince(start) * 1e3;
+
+        start = chrono::steady_clock::now();
+        StudentOrderView view = store.ordered(o.by);   // Sorted once here
+        double firstMs = secondsSince(start) * 1e3;
+
+        start = chrono::steady_clock::now();
+        view = store.ordered(o.by);
+        int mismatches = 0;
+        for (int i = 0; i < view.size(); i++) {
+            checksum += store[view[i]].id;
+            mismatches += view[i] != order[i];
+        }
+        double viewMs = secondsSince(start) * 1e3;
+        cout << o.name << "\t" << fixed << setprecision(2) << sortMs << "\t\t" << firstMs << "\t\t"
+             << viewMs << (mismatches ? "\tMISMATCH" : "") << "\n";
+    }
+
+    // Cost of keeping all three orders current
+    cout << "Maintenance with all three orders built (us per operation)\n";
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++) store.add(makeStudent(n + i));
+    cout << "Insert\t" << setprecision(2) << secondsSince(start) * 1e6 / changes << "\n";
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++) {
+        int index = (int)(((long long)i * 104729) % n);   // Students that have a course
+        store.setCourseGrade(index, 0, (float)(40 + (i * 37) % 60));
+    }
+    cout << "Grade change (GPA moves)\t" << secondsSince(start) * 1e6 / changes << "\n";
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++) store.remove((int)(((long long)i * 104729) % store.size()));
+    cout << "Delete\t" << secondsSince(start) * 1e6 / changes << "\t(checksum " << checksum << ")\n";
+}
+
+/**
+ * Fill a store with students whose IDs and names are in no particular order
+ */
+static void fillShuffled(StudentStore& store, int n) {
+    static const char* const SYLLABLES[] = { "ka", "mo", "ri", "sa", "el", "no", "ta", "vi" };
+    store.clear();
+    store.reserve(n, n, 0);
+    for (int i = 0; i < n; i++) {
+        int key = (int)(((long long)i * 7919) % n);   // 7919 is prime, so keys are a permutation
+        Student s;
+        s.id = 100000 + key;
+        for (int k = key; s.name.size() < 12; k = k / 8 + 3) s.name += SYLLABLES[k % 8];
+        s.name += " " + to_string(key);
+        s.nationalId = "29901011234567";
+        int index = store.add(std::move(s));
+        store.addCourse(index, Course{ COURSE_NAMES[i % NUM_COURSE_NAMES], 75.0f });
+    }
+}
+
+/**
+ * Compare sorting whole records with sorting (key, index) pairs
+ */
+static void benchmarkSorting() {
+    const int n = 1000000;
+    int hardwareThreads = max(1, (int)thread::hardware_concurrency());
+    cout << "\nSorting " << n << " students (seconds, " << hardwareThreads << " hardware threads)\n";
+    cout << "Order\tRecord sort\tKey sort\tKey sort, parallel\n";
+
+    for (int byName = 0; byName < 2; byName++) {
+        fillShuffled(students, n);
+        auto start = chrono::steady_clock::now();
+        if (byName) {
+            students.sort([](const Student& a, const Student& b) { return a.name < b.name; });
+        } else {
+            students.sort([](const Student& a, const Student& b) { return a.id < b.id; });
+        }
+        double recordSeconds = secondsSince(start);
+        vector<int> expected(n);
+        for (int i = 0; i < n; i++) expected[i] = students[i].id;
+
+        double keySeconds[2];
+        int mismatches = 0;
+        for (int parallel = 0; parallel < 2; parallel++) {
+            fillShuffled(students, n);
+            start = chrono::steady_clock::now();
+            if (byName) sortStudentsByName(parallel ? 0 : 1);
+            else sortStudentsById(parallel ? 0 : 1);
+            keySeconds[parallel] = secondsSince(start);
+            for (int i = 0; i < n; i++) mismatches += students[i].id != expected[i];
+        }
+        cout << (byName ? "Name" : "ID") << "\t" << fixed << setprecision(3) << recordSeconds << "\t\t"
+             << keySeconds[0] << "\t\t" << keySeconds[1] << (mismatches ? "\tMISMATCH" : "") << "\n";
+    }
+    students.clear();
+}
+
+/**
+ * Compare the per-query lowercase scan with the name index
+ */
+static void benchmarkNameSearch() {
+    const int n = 1000000;
+    StudentStore store;
+    store.reserve(n, 0, 0);
+    for (int i = 0; i < n; i++) store.add(makeStudent(i));
+
+    vector<int> page;
+    auto start = chrono::steady_clock::now();
+    store.searchNames("x", 0, 0, page);   // The first search builds the index
+    double buildSeconds = secondsSince(start);
+    cout << "\nName search over " << n << " students (index built in " << fixed << setprecision(2)
+         << buildSeconds << " s)\n";
+    cout << "Query			Matches	Lowercase scan (ms)	Index, first 10 (ms)\n";
+
+    const char* const queries[] = { "NUMBER 123456", "54321", "number 99", "stu", "be" };
+    for (const char* query : queries) {
+        // The search students used before the index: lowercase every name per query
+        start = chrono::steady_clock::now();
+        string searchLower = query;
+        transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::tolower);
+        int scanMatches = 0;
+        for (int i = 0; i < store.size(); i++) {
+            string nameLower = store[i].name;
+            transform(nameLower.begin(), nameLower.end(), nameLower.begin(), ::tolower);
+            if (nameLower.find(searchLower) != string::npos) scanMatches++;
+        }
+        double scanMs = secondsSince(start) * 1e3;
+
+        start = chrono::steady_clock::now();
+        int total = store.searchNames(query, 0, 10, page);
+        double indexMs = secondsSince(start) * 1e3;
+
+        cout << query << "\t" << (strlen(query) < 8 ? "\t\t" : "\t") << total << "\t"
+             << setprecision(2) << scanMs << "\t\t\t" << setprecision(3) << indexMs;
+        if (scanMatches != total) cout << "\t(scan found " << scanMatches << ")";
+        cout << "\n";
+    }
+}
+
+/**
+ * Compare finding a course's students by scanning every course slot with the
+ * catalog roster
+ */
+static void benchmarkCourseRoster() {
+    const int n = 1000000;
+    StudentStore store;
+    store.reserve(n, n * 3, 0);
+    for (int i = 0; i < n; i++) {
+        int index = store.add(makeStudent(i));
+        store.addCourse(index, Course{ COURSE_NAMES[i % NUM_COURSE_NAMES], (float)(i % 101) });
+        store.addCourse(index, Course{ COURSE_NAMES[(i / 7) % NUM_COURSE_NAMES], (float)(i % 89) });
+        // A small elective taken by one student in a thousand
+        if (i % 1000 == 0) store.addCourse(index, Course{ "Astronomy", (float)(i % 97) });
+    }
+
+    auto start = chrono::steady_clock::now();
+    const CourseCatalog& catalog = store.courseCatalog();   // Built on first use
+    double buildSeconds = secondsSince(start);
+    cout << "\nStudents of a course among " << n << " students (catalog built in " << fixed
+         << setprecision(2) << buildSeconds << " s)\n";
+    cout << "Course\t\tStudents\tSlot scan (ms)\tRoster (ms)\tAverage\n";
+
+    const char* const courses[] = { "Mathematics", "Astronomy" };
+    vector<int> roster;
+    for (const char* course : courses) {
+        start = chrono::steady_clock::now();
+        int scanned = 0;
+        for (int i = 0; i < store.size(); i++) {
+            const Course* studentCourses = store.courses(i);
+            for (int c = 0; c < store[i].numCourses; c++) {
+                if (strcasecmp(courseNames.c_str(studentCourses[c].nameId), course) == 0) {
+                    scanned++;
+                    break;
+                }
+            }
+        }
+        double scanMs = secondsSince(start) * 1e3;
+
+        start = chrono::steady_clock::now();
+        int id = catalog.find(course);
+        int total = store.courseRoster(id, roster);
+        double rosterMs = secondsSince(start) * 1e3;
+
+        cout << course << "	" << (strlen(course) < 8 ? "\t" : "") << total << "\t\t" << setprecision(2)
+             << scanMs << "\t\t" << setprecision(3) << rosterMs << "\t\t" << setprecision(2)
+             << catalog.averageGrade(id);
+        if (scanned != total) cout << "\t(scan found " << scanned << ")";
+        cout << "\n";
+    }
+}
+
+/**
+ * Compare course data held as one string per slot with interned name IDs,
+ * on a synthetic 1M-student file
+ */
+static void benchmarkCourseNameInterning() {
+    const int n = 1000000;
+    writeSyntheticFile(BENCH_FILENAME, n);
+    StudentStore store;
+    vector<ParseError> errors;
+    loadStudentsFromFile(BENCH_FILENAME, store, errors);
+    remove(BENCH_FILENAME);
+
+    // The course slots as loaded, and the same data in the string-per-slot
+    // layout used before interning
+    vector<Course> internedCourses;
+    vector<LegacyCourse> legacyCourses;
+    vector<string> legacyPlan;
+    for (int i = 0; i < store.size(); i++) {
+        for (int c = 0; c < store[i].numCourses; c++) {
+            const Course& course = store.courses(i)[c];
+            internedCourses.push_back(course);
+            legacyCourses.push_back(LegacyCourse{ string(course.name()), course.grade });
+        }
+        for (int p = 0; p < store[i].numStudyPlan; p++) legacyPlan.push_back(string(store.studyPlanEntry(i, p)));
+    }
+    size_t legacyBytes = legacyCourses.size() * sizeof(LegacyCourse) + legacyPlan.size() * sizeof(string);
+    for (const LegacyCourse& c : legacyCourses) legacyBytes += heapBytes(c.name);
+    for (const string& entry : legacyPlan) legacyBytes += heapBytes(entry);
+    size_t internedBytes = internedCourses.size() * sizeof(Course) + legacyPlan.size() * sizeof(int)
+                         + courseNames.memoryUsage();
+
+    cout << "\nCourse data of " << store.size() << " students (" << legacyCourses.size()
+         << " course slots, " << legacyPlan.size() << " plan entries, " << courseNames.size()
+         << " interned strings)\n";
+    cout << "Layout\t\tMB\tCase-insensitive name match (ms)\n";
+
+    // Count the slots of one course, ignoring case, in each layout
+    auto start = chrono::steady_clock::now();
+    int legacyMatches = 0;
+    for (const LegacyCourse& c : legacyCourses) {
+        if (strcasecmp(c.name.c_str(), "database systems") == 0) legacyMatches++;
+    }
+    double legacyMs = secondsSince(start) * 1e3;
+
+    start = chrono::steady_clock::now();
+    int wanted = courseNames.intern("database systems");
+    int internedMatches = 0;
+    for (const Course& c : internedCourses) {
+        if (courseNames.folded(c.nameId) == wanted) internedMatches++;
+    }
+    double internedMs = secondsSince(start) * 1e3;
+
+    cout << "String per slot\t" << fixed << setprecision(2) << legacyBytes / 1048576.0 << "\t" << legacyMs
+         << "\n";
+    cout << "Interned IDs\t" << internedBytes / 1048576.0 << "\t" << internedMs;
+    if (internedMatches != legacyMatches) cout << "\t(" << internedMatches << " vs " << legacyMatches << " matches)";
+    cout << "\n";
+}
+
+/**
+ * Compute cohort statistics of 1M students row by row with full sorts, and
+ * from the columns with each kernel
+ */
+static void benchmarkCohortStatistics() {
+    const int n = 1000000;
+    writeSyntheticFile(BENCH_FILENAME, n);
+    StudentStore store;
+    vector<ParseError> errors;
+    loadStudentsFromFile(BENCH_FILENAME, store, errors);
+    remove(BENCH_FILENAME);
+    const CourseCatalog& catalog = store.courseCatalog();
+
+    cout << "\nCohort statistics of " << store.size() << " students\n";
+    cout << "Method\t\tms\tMedian GPA\tMismatches\n";
+
+    // Row by row: gather each student's values, then sort every list
+    auto start = chrono::steady_clock::now();
+    vector<float> gpas;
+    vector<vector<float>> courseGrades(catalog.size());
+    for (int i = 0; i < store.size(); i++) {
+        if (store[i].numCourses == 0) continue;
+        gpas.push_back(store[i].gpa);
+        for (int c = 0; c < store[i].numCourses; c++) {
+            courseGrades[catalog.find(store.courses(i)[c].nameId)].push_back(store.courses(i)[c].grade);
+        }
+    }
+    std::sort(gpas.begin(), gpas.end());
+    for (vector<float>& grades : courseGrades) std::sort(grades.begin(), grades.end());
+    double rowMs = secondsSince(start) * 1e3;
+    float median = 0.0f;
+    if (!gpas.empty()) {
+        double rank = 0.5 * (gpas.size() - 1);
+        size_t lower = (size_t)rank;
+        median = lower + 1 < gpas.size() ? (float)(gpas[lower] + (rank - lower) * (gpas[lower + 1] - gpas[lower]))
+                                         : gpas[lower];
+    }
+    cout << "Rows and sort\t" << fixed << setprecision(2) << rowMs << "\t" << median << "\t\t-\n";
+
+    const struct { ColumnKernel kernel; const char* name; } kernels[] = {
+        { COLUMN_KERNEL_SCALAR, "Columns scalar" }, { COLUMN_KERNEL_SSE2, "Columns SSE2" },
+        { COLUMN_KERNEL_AVX2, "Columns AVX2" }
+    };
+    for (const auto& k : kernels) {
+        if (!columnKernelSupported(k.kernel)) {
+            cout << k.name << "\tnot supported by this CPU\n";
+            continue;
+        }
+        CohortReport report = analyzeCohort(store, 10, k.kernel);
+        // Medians and fail rates must agree with the sorted lists
+        int mismatches = report.gpa.count != gpas.size() || report.gpaPercentiles[2] != median;
+        for (const CourseStatistics& c : report.courses) {
+            const vector<float>& grades = courseGrades[c.course];
+            size_t failing = lower_bound(grades.begin(), grades.end(), report.failingGrade) - grades.begin();
+            mismatches += c.grades != (int)grades.size() || c.min != grades.front() || c.max != grades.back()
+                       || c.failRate != (double)failing / grades.size();
+        }
+        cout << k.name << "\t" << report.seconds * 1e3 << "\t" << report.gpaPercentiles[2] << "\t\t" << mismatches
+             << "\n";
+    }
+}
+
+/**
+ * Store of n students with two of the benchmark courses each
+ */
+static void fillGraded(StudentStore& store, int n) {
+    store.reserve(n, n * 2, 0);
+    for (int i = 0; i < n; i++) {
+        int index = store.add(makeStudent(i));
+        store.addCourse(index, Course{ COURSE_NAMES[i % NUM_COURSE_NAMES], (float)((i * 7919LL) % 101) });
+        store.addCourse(index, Course{ COURSE_NAMES[(i / 7) % NUM_COURSE_NAMES], (float)((i * 104729LL) % 89) });
+    }
+}
+
+/**
+ * Compare sorting for the dean's list with the maintained GPA rankings, and
+ * measure what keeping the rankings current adds to grade changes
+ */
+static void benchmarkRanking() {
+    const int n = 1000000;
+    const int k = 10;
+    StudentStore store;
+    fillGraded(store, n);
+    int course = store.courseCatalog().find("Mathematics");
+
+    cout << "\nTop " << k << " by GPA among " << n << " students\n";
+    cout << "Method\t\tAll (ms)\tOne course (ms)\tMismatches\n";
+
+    // Sorting: gather the candidates and sort them all
+    auto better = [&store](int a, int b) {
+        if (store[a].gpa != store[b].gpa) return store[a].gpa > store[b].gpa;
+        return store[a].id < store[b].id;
+    };
+    auto start = chrono::steady_clock::now();
+    vector<int> sortedAll(n);
+    for (int i = 0; i < n; i++) sortedAll[i] = i;
+    std::sort(sortedAll.begin(), sortedAll.end(), better);
+    double sortAllMs = secondsSince(start) * 1e3;
+    start = chrono::steady_clock::now();
+    vector<int> sortedCourse;
+    store.courseRoster(course, sortedCourse);
+    std::sort(sortedCourse.begin(), sortedCourse.end(), better);
+    double sortCourseMs = secondsSince(start) * 1e3;
+    cout << "Full sort\t" << fixed << setprecision(3) << sortAllMs << "\t\t" << sortCourseMs << "\t\t-\n";
+
+    start = chrono::steady_clock::now();
+    vector<int> top;
+    store.topStudents(GpaRanking::OVERALL, k, top);   // Builds the rankings
+    double buildMs = secondsSince(start) * 1e3;
+
+    start = chrono::steady_clock::now();
+    store.topStudents(GpaRanking::OVERALL, k, top);
+    double rankAllMs = secondsSince(start) * 1e3;
+    int mismatches = 0;
+    for (int i = 0; i < k; i++) mismatches += top[i] != sortedAll[i];
+    start = chrono::steady_clock::now();
+    store.topStudents(course, k, top);
+    double rankCourseMs = secondsSince(start) * 1e3;
+    for (int i = 0; i < k; i++) mismatches += top[i] != sortedCourse[i];
+    cout << "Ranking\t\t" << rankAllMs << "\t\t" << rankCourseMs << "\t\t" << mismatches << "\t(built in "
+         << setprecision(1) << buildMs << " ms)\n";
+
+    // Grade changes move each student across the students its GPA passes
+    const int changes = 100000;
+    start = chrono::steady_clock::now();
+    for (int c = 0; c < changes; c++) {
+        int index = (int)((c * 7919LL) % n);
+        store.setCourseGrade(index, c % 2, (float)((c * 31) % 101));
+    }
+    cout << "Grade change with rankings kept current: " << setprecision(2) << secondsSince(start) * 1e6 / changes
+         << " us\n";
+}
+
+/**
+ * Compare applying grade sheets row by row with the batched import, which
+ * updates each student once for all of its rows
+ */
+static void benchmarkGradeImport() {
+    const int n = 1000000;
+    const int numSheets = 10;
+    StudentStore rowStore, batchStore;
+    fillGraded(rowStore, n);
+    fillGraded(batchStore, n);
+
+    // Half the sheets grade the benchmark courses, regrading the two each
+    // student takes, half add electives; every sheet grades every student, in
+    // a different order, until students run out of course slots
+    vector<GradeSheet> sheets;
+    for (int s = 0; s < numSheets; s++) {
+        string course = s < NUM_COURSE_NAMES ? COURSE_NAMES[s] : "Elective " + to_string(s - NUM_COURSE_NAMES + 1);
+        string path = "benchmark_grades_" + to_string(s) + ".csv";
+        ofstream file(path);
+        file << "student_id,grade\n";
+        for (int r = 0; r < n; r++) {
+            int i = (int)((r * 7919LL + s * 104729LL) % n);
+            file << 100000 + i << "," << (r * 31 + s) % 101 << "\n";
+        }
+        sheets.push_back(GradeSheet{ path, course });
+    }
+
+    cout << "\nImport of " << numSheets << " grade sheets of " << n << " rows\n";
+    cout << "Method\t\tRows\tSeconds\tRows/s\n";
+
+    // Row by row: read, look up and apply each row as it comes
+    auto start = chrono::steady_clock::now();
+    long long rowCount = 0;
+    for (const GradeSheet& sheet : sheets) {
+        int lowercaseId = courseNames.folded(courseNames.intern(sheet.course));
+        ifstream file(sheet.path);
+        string line;
+        getline(file, line);   // Header
+        while (getline(file, line)) {
+            size_t comma = line.find(',');
+            int index = rowStore.find(stoi(line.substr(0, comma)));
+            float grade = stof(line.substr(comma + 1));
+            const Course* studentCourses = rowStore.courses(index);
+            int slot = -1;
+            for (int c = 0; c < rowStore[index].numCourses && slot == -1; c++) {
+                if (courseNames.folded(studentCourses[c].nameId) == lowercaseId) slot = c;
+            }
+            if (slot != -1) rowStore.setCourseGrade(index, slot, grade);
+            else if (rowStore[index].numCourses < MAX_COURSES) rowStore.addCourse(index, Course{ sheet.course, grade });
+            else continue;
+            rowCount++;
+        }
+    }
+    double rowSeconds = secondsSince(start);
+    cout << "Row by row\t" << rowCount << "\t" << fixed << setprecision(2) << rowSeconds << "\t"
+         << setprecision(0) << rowCount / rowSeconds << "\n";
+
+    GradeImportReport report = importGradeSheets(sheets, batchStore);
+    long long imported = 0;
+    for (const GradeSheetResult& result : report.sheets) imported += result.imported;
+    cout << "Batched import\t" << imported << "\t" << setprecision(2) << report.seconds << "\t"
+         << setprecision(0) << imported / report.seconds << "\n";
+
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) mismatches += rowStore[i].gpa != batchStore[i].gpa;
+    cout << "GPA mismatches: " << mismatches << "\n";
+    for (const GradeSheet& sheet : sheets) remove(sheet.path.c_str());
+}
+
+/**
+ * Compare the ofstream text writer with the export writers
+ */
+static void benchmarkExport() {
+    const int n = 1000000;
+    const char exportFile[] = "benchmark_export.out";
+    writeSyntheticFile(BENCH_FILENAME, n);
+    StudentStore store;
+    vector<ParseError> errors;
+    loadStudentsFromFile(BENCH_FILENAME, store, errors);
+    remove(BENCH_FILENAME);
+    store.ordered(ORDER_BY_ID);   // Exports list by ID; keep the first sort out of the timings
+
+    cout << "\nExporting " << n << " students\n";
+    cout << "Writer\t\tSeconds\tFile MB\tMB/s\n";
+
+    auto start = chrono::steady_clock::now();
+    writeStudentsFile(exportFile, store);
+    double seconds = secondsSince(start);
+    double mb = fileBytes(exportFile) / 1048576.0;
+    cout << fixed << "ofstream text\t" << setprecision(3) << seconds << "\t" << setprecision(1) << mb << "\t"
+         << mb / seconds << "\n";
+
+    const char* const names[NUM_EXPORT_FORMATS] = { "CSV\t", "JSON Lines", "Columnar" };
+    for (int format = 0; format < NUM_EXPORT_FORMATS; format++) {
+        ExportReport report = exportStudents(exportFile, store, (ExportFormat)format);
+        mb = report.bytes / 1048576.0;
+        cout << names[format] << "\t" << setprecision(3) << report.seconds << "\t" << setprecision(1) << mb << "\t"
+             << mb / report.seconds << (report.ok ? "" : "\tfailed") << "\n";
+    }
+    remove(exportFile);
+}
+
+/**
+ * Store of n students in pairs: student i and student i + n / 2 always have
+ * the same grades and the same batch number in their names
+ */
+static void fillPairs(StudentStore& store, int n) {
+    fillGraded(store, n);
+    for (int i = 0; i < n; i++) {
+        store.setCourseGrade(i, 0, 50.0f);
+        store.setCourseGrade(i, 1, 50.0f);
+        store.setName(i, "Pair " + to_string(i % (n / 2)) + " Batch 0");
+    }
+}
+
+/**
+ * Change whole pairs of students between two publishes, while reader threads
+ * check that no replica ever shows half of a change, a stale index or an
+ * unsorted order
+ */
+static void benchmarkReplicaConsistency() {
+    const int n = 100000;
+    const int pairs = n / 2;
+    const int batches = 500;
+    const int pairsPerBatch = 20;
+    const int numReaders = 4;
+    StudentStore store;
+    fillPairs(store, n);
+    StudentReplicas replicas;
+    replicas.attach(store);
+
+    atomic<bool> done{ false };
+    atomic<long long> checks{ 0 };
+    atomic<long long> violations{ 0 };
+    auto readPairs = [&](int number) {
+        StudentReplicas::Reader reader(replicas);
+        uint32_t state = 2463534242u + number;
+        long long checked = 0, bad = 0;
+        vector<int> found;
+        for (long long round = 0; !done.load(memory_order_relaxed); round++) {
+            StudentReplicas::View view(reader);
+            const StudentStore& copy = view.store;
+            for (int r = 0; r < 100; r++) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                int pair = (int)(state % pairs);
+                int a = copy.find(100000 + pair);
+                int b = copy.find(100000 + pair + pairs);
+                checked++;
+                if ((a == -1) != (b == -1)) {
+                    bad++;   // Half of a deletion or of an addition
+                    continue;
+                }
+                if (a == -1) continue;
+                const Student& x = copy[a];
+                const Student& y = copy[b];
+                if (x.gpa != y.gpa || x.name != y.name || x.gpa < 0.0f || x.gpa > 4.0f) bad++;
+            }
+            if (round % 200 == 0) {
+                // Whole indexes: each order holds every student once, sorted
+                checked++;
+                for (int by = 0; by < NUM_STUDENT_ORDERS; by++) {
+                    StudentOrderView order = copy.ordered((StudentOrder)by);
+                    if (order.size() != copy.size()) bad++;
+                    for (int i = 1; i < order.size(); i++) {
+                        const Student& prev = copy[order[i - 1]];
+                        const Student& next = copy[order[i]];
+                        bool sorted = by == ORDER_BY_ID ? prev.id < next.id
+                                    : by == ORDER_BY_GPA ? prev.gpa > next.gpa || (prev.gpa == next.gpa && prev.id < next.id)
+                                    : prev.name < next.name || (prev.name == next.name && prev.id < next.id);
+                        if (!sorted) {
+                            bad++;
+                            break;
+                        }
+                    }
+                }
+                copy.topStudents(GpaRanking::OVERALL, 10, found);
+                for (size_t i = 1; i < found.size(); i++) bad += copy[found[i - 1]].gpa < copy[found[i]].gpa;
+            }
+        }
+        checks += checked;
+        violations += bad;
+    };
+
+    vector<thread> readers;
+    for (int r = 0; r < numReaders; r++) readers.emplace_back(readPairs, r);
+    auto start = chrono::steady_clock::now();
+    for (int batch = 1; batch <= batches; batch++) {
+        for (int p = 0; p < pairsPerBatch; p++) {
+            int pair = (int)(((long long)batch * pairsPerBatch + p) * 7919 % pairs);
+            float grade = (float)((batch * 31 + p) % 101);
+            string name = "Pair " + to_string(pair) + " Batch " + to_string(batch);
+            bool remove = p == 0;   // Each batch also deletes a pair and adds it back
+            for (int id : { 100000 + pair, 100000 + pair + pairs }) {
+                int index = store.find(id);
+                if (remove) {
+                    store.remove(index);
+                    Student s = makeStudent(id - 100000);
+                    s.name = name;
+                    index = store.add(std::move(s));
+                    store.addCourse(index, Course{ COURSE_NAMES[0], grade });
+                    store.addCourse(index, Course{ COURSE_NAMES[1], grade });
+                    continue;
+                }
+                store.setCourseGrade(index, 0, grade);
+                store.setCourseGrade(index, 1, grade);
+                store.setName(index, name);
+            }
+        }
+        replicas.publish();
+    }
+    double seconds = secondsSince(start);
+    done = true;
+    for (thread& t : readers) t.join();
+    replicas.detach();
+
+    cout << "\nReplica consistency: " << batches << " publishes of " << pairsPerBatch << " pairs among " << n
+         << " students, " << numReaders << " readers\n";
+    cout << fixed << setprecision(1) << "Publishes/s " << batches / seconds << ", reader checks " << checks.load()
+         << ", violations " << violations.load() << "\n";
+}
+
+/**
+ * Compare reads under a shared_mutex with reads of the replicas while one
+ * writer keeps changing grades
+ */
+static void benchmarkConcurrentReads() {
+    const int n = 200000;
+    const double seconds = 0.5;
+    const int batch = 100;   // Grade changes per lock or per publish
+    StudentStore store;
+    fillGraded(store, n);
+    store.prepareForReaders();
+    StudentReplicas replicas;
+    int hardwareThreads = max(1, (int)thread::hardware_concurrency());
+
+    cout << "\nReads of " << n << " students beside a writer (millions of reads/s, " << hardwareThreads
+         << " hardware threads)\n";
+    cout << "Readers\tshared_mutex\tReplicas\tWrites/s locked\tWrites/s replicated\n";
+
+    // One read: a lookup, and a name search for every 64th
+    auto readOne = [n](const StudentStore& copy, uint32_t& state, vector<int>& page) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        if (state % 64 == 0) return copy.searchNames("number " + to_string(state % n), 0, 10, page);
+        int index = copy.find(100000 + (int)(state % n));
+        return index == -1 ? 0 : (int)copy[index].gpa;
+    };
+
+    for (int numReaders : { 1, 2, 4, 8 }) {
+        double readRate[2], writeRate[2];
+        for (int replicated = 0; replicated < 2; replicated++) {
+            shared_mutex lock;
+            if (replicated) replicas.attach(store);
+            else store.prepareForReaders();
+            // Readers stop on their own: one that keeps the shared lock
+            // taken can keep the writer out for the whole run
+            auto start = chrono::steady_clock::now();
+            auto done = [&] { return secondsSince(start) >= seconds; };
+            atomic<long long> reads{ 0 };
+            atomic<int> sink{ 0 };
+            vector<thread> readers;
+            for (int r = 0; r < numReaders; r++) {
+                readers.emplace_back([&, r] {
+                    uint32_t state = 2463534242u + r;
+                    vector<int> page;
+                    long long count = 0;
+                    int sum = 0;
+                    if (replicated) {
+                        StudentReplicas::Reader reader(replicas);
+                        while (!done()) {
+                            StudentReplicas::View view(reader);
+                            for (int i = 0; i < 64; i++) sum += readOne(view.store, state, page);
+                            count += 64;
+                        }
+                    } else {
+                        while (!done()) {
+                            shared_lock<shared_mutex> reading(lock);
+                            for (int i = 0; i < 64; i++) sum += readOne(store, state, page);
+                            count += 64;
+                        }
+                    }
+                    reads += count;
+                    sink += sum;
+                });
+            }
+
+            long long writes = 0;
+            while (!done()) {
+                if (!replicated) lock.lock();
+                for (int i = 0; i < batch; i++, writes++) {
+                    store.setCourseGrade((int)((writes * 7919) % n), (int)(writes % 2), (float)(writes % 101));
+                }
+                if (replicated) {
+                    replicas.publish();
+                } else {
+                    store.prepareForReaders();
+                    lock.unlock();
+                }
+            }
+            for (thread& t : readers) t.join();
+            double elapsed = secondsSince(start);
+            replicas.detach();
+            readRate[replicated] = reads.load() / elapsed / 1e6;
+            writeRate[replicated] = writes / elapsed;
+        }
+        cout << numReaders << "\t" << fixed << setprecision(2) << readRate[0] << "\t\t" << readRate[1] << "\t\t"
+             << setprecision(0) << writeRate[0] << "\t\t" << writeRate[1] << "\n";
+    }
+}
+
+/**
+ * Compare five course and study plan changes applied one by one with the
+ * same changes staged in a StudentEdit and committed at once, both with a
+ * journal attached
+ */
+static void benchmarkStudentEdit() {
+    const int n = 200000;
+    const char* paths[2] = { "benchmark_steps.journal", "benchmark_edit.journal" };
+    StudentStore stepStore, editStore;
+    fillGraded(stepStore, n);
+    fillGraded(editStore, n);
+    remove(paths[0]);
+    remove(paths[1]);
+    StudentJournal stepJournal, editJournal;
+    stepJournal.open(paths[0]);
+    editJournal.open(paths[1]);
+    stepStore.attachJournal(&stepJournal);
+    editStore.attachJournal(&editJournal);
+
+    cout << "\nEdits of 5 changes to " << n << " students, journal attached\n";
+    cout << "Method\t\tus/edit\tJournal (MB)\n";
+
+    // Two electives added, the first course regraded, a plan entry added and
+    // the second elective removed again
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        stepStore.addCourse(i, Course{ "Elective 1", (float)(i % 101) });
+        stepStore.addCourse(i, Course{ "Elective 2", (float)((i * 7) % 101) });
+        stepStore.setCourseGrade(i, 0, (float)((i * 13) % 101));
+        stepStore.addStudyPlanEntry(i, "Thesis");
+        stepStore.removeCourse(i, stepStore[i].numCourses - 1);
+    }
+    stepJournal.close();
+    double stepSeconds = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    string error;
+    for (int i = 0; i < n; i++) {
+        StudentEdit edit(editStore, i);
+        edit.addCourse(Course{ "Elective 1", (float)(i % 101) }, error);
+        edit.addCourse(Course{ "Elective 2", (float)((i * 7) % 101) }, error);
+        edit.setCourseGrade(edit.courses()[0].name(), (float)((i * 13) % 101), error);
+        edit.addPlanEntry("Thesis", error);
+        edit.removeCourse((int)edit.courses().size() - 1, error);
+        commitEdit(editStore, edit, error);
+    }
+    editJournal.close();
+    double editSeconds = secondsSince(start);
+
+    struct stat info[2];
+    stat(paths[0], &info[0]);
+    stat(paths[1], &info[1]);
+    cout << "One by one\t" << fixed << setprecision(2) << stepSeconds * 1e6 / n << "\t"
+         << info[0].st_size / 1e6 << "\n";
+    cout << "StudentEdit\t" << editSeconds * 1e6 / n << "\t" << info[1].st_size / 1e6 << "\n";
+
+    // The edit sums the grade points afresh, so the GPAs differ in rounding
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) {
+        mismatches += fabs(stepStore[i].gpa - editStore[i].gpa) > 1e-4f
+                      || stepStore[i].numCourses != editStore[i].numCourses
+                      || stepStore[i].numStudyPlan != editStore[i].numStudyPlan;
+    }
+    cout << "Mismatches: " << mismatches << "\n";
+    stepStore.attachJournal(nullptr);
+    editStore.attachJournal(nullptr);
+    remove(paths[0]);
+    remove(paths[1]);
+}
+
+/**
+ * Compare finding students in an archive held as a snapshot, which must be
+ * loaded whole, with a page file, which reads one page per tree level
+ */
+static void benchmarkRepositories() {
+    const int n = 1000000;
+    const int finds = 1000;
+    const char* paths[2] = { "benchmark_archive.dat", "benchmark_archive.pages" };
+    StudentStore store;
+    fillGraded(store, n);
+    string error;
+    makeStudentRepository(REPOSITORY_SNAPSHOT, paths[0])->saveAll(store, error);
+    makeStudentRepository(REPOSITORY_PAGES, paths[1])->saveAll(store, error);
+
+    cout << "\nFinding " << finds << " of " << n << " archived students\n";
+    cout << "Engine\t\tOpen (ms)\tus/find\tFile (MB)\n";
+
+    int mismatches = 0;
+    for (int engine = 0; engine < 2; engine++) {
+        struct stat info = {};
+        stat(paths[engine], &info);
+        auto start = chrono::steady_clock::now();
+        double openSeconds = 0.0, findSeconds = 0.0;
+        if (engine == 0) {
+            // A snapshot is loaded once, then searched in memory
+            StudentStore loaded;
+            vector<ParseError> skipped;
+            makeStudentRepository(REPOSITORY_SNAPSHOT, paths[0])->loadAll(loaded, error, skipped);
+            openSeconds = secondsSince(start);
+            start = chrono::steady_clock::now();
+            for (int k = 0; k < finds; k++) {
+                int i = (int)((k * 7919LL) % n);
+                int index = loaded.find(100000 + i);
+                mismatches += index == -1 || loaded[index].numCourses != store[i].numCourses;
+            }
+            findSeconds = secondsSince(start);
+        } else {
+            unique_ptr<StudentRepository> pages = makeStudentRepository(REPOSITORY_PAGES, paths[1]);
+            StudentImage image;
+            openSeconds = secondsSince(start);
+            start = chrono::steady_clock::now();
+            for (int k = 0; k < finds; k++) {
+                int i = (int)((k * 7919LL) % n);
+                mismatches += !pages->find(100000 + i, image, error) || (int)image.courses.size() != store[i].numCourses;
+            }
+            findSeconds = secondsSince(start);
+        }
+        cout << (engine == 0 ? "Snapshot\t" : "Page file\t") << fixed << setprecision(2) << openSeconds * 1e3
+             << "\t\t" << findSeconds * 1e6 / finds << "\t" << info.st_size / 1e6 << "\n";
+    }
+    cout << "Mismatches: " << mismatches << "\n";
+    remove(paths[0]);
+    remove(paths[1]);
+}
+
+/**
+ * Main function - runs every benchmark
+ */
+int main() {
+    benchmarkStudentStore();
+    benchmarkIdLookup();
+    benchmarkLoader();
+    benchmarkSnapshot();
+    benchmarkGpa();
+    benchmarkGradeConversion();
+    benchmarkNameSearch();
+    benchmarkOrders();
+    benchmarkSorting();
+    benchmarkCourseRoster();
+    benchmarkCourseNameInterning();
+    benchmarkCohortStatistics();
+    benchmarkRanking();
+    benchmarkGradeImport();
+    benchmarkExport();
+    benchmarkReplicaConsistency();
+    benchmarkConcurrentReads();
+    benchmarkStudentEdit();
+    benchmarkRepositories();
+    return 0;
+}
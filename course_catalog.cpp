@@ -0,0 +1,145 @@
+/**
+ * Course Catalog Module
+ *
+ * This file contains the course catalog with its per-course rosters, and
+ * the store code that keeps the catalog in step with course changes.
+ */
+
+#include "student.h"   // Include student structure definitions
+#include <algorithm>   // Include for remove_if
+#include <cctype>      // Include for tolower
+#include <utility>     // Include for as_const
+
+int CourseCatalog::find(int nameId) const {
+    int lowercaseId = courseNames.folded(nameId);
+    return lowercaseId < (int)byLowercaseName.size() ? byLowercaseName[lowercaseId] : -1;
+}
+
+int CourseCatalog::find(string_view name) const {
+    string lowered(name);
+    for (char& c : lowered) c = (char)tolower((unsigned char)c);
+    int lowercaseId = courseNames.find(lowered);
+    return lowercaseId == -1 ? -1 : find(lowercaseId);
+}
+
+int CourseCatalog::intern(int nameId) {
+    int lowercaseId = courseNames.folded(nameId);
+    if (lowercaseId >= (int)byLowercaseName.size()) byLowercaseName.resize(courseNames.size(), -1);
+    int& course = byLowercaseName[lowercaseId];
+    if (course == -1) {
+        course = (int)courses.size();
+        courses.emplace_back();
+        courses.back().nameId = nameId;
+    }
+    return course;
+}
+
+double CourseCatalog::averageGrade(int course) const {
+    const CourseEntry& c = courses[course];
+    return c.grades > 0 ? c.gradeSum / c.grades : 0.0;
+}
+
+void CourseCatalog::enroll(int course, int entry, float grade, bool newStudent) {
+    CourseEntry& c = courses[course];
+    if (newStudent) c.students.push_back(entry);
+    c.gradeSum += grade;
+    c.grades++;
+}
+
+void CourseCatalog::withdraw(int course, int entry, float grade, bool lastSlot) {
+    CourseEntry& c = courses[course];
+    c.gradeSum -= grade;
+    c.grades--;
+    if (c.grades == 0) c.gradeSum = 0.0;   // Drop accumulated rounding error
+    if (!lastSlot) return;
+    // Rosters are unordered, so the entry is swapped with the last one
+    for (size_t i = 0; i < c.students.size(); i++) {
+        if (c.students[i] == entry) {
+            c.students[i] = c.students.back();
+            c.students.pop_back();
+            break;
+        }
+    }
+}
+
+void CourseCatalog::regrade(int course, float oldGrade, float newGrade) {
+    courses[course].gradeSum += (double)newGrade - oldGrade;
+}
+
+void CourseCatalog::withdrawAll(const vector<char>& leaving, const vector<int>& slots) {
+    for (CourseEntry& c : courses) {
+        c.students.erase(remove_if(c.students.begin(), c.students.end(),
+                                   [&](int entry) { return leaving[slots[entry]] != 0; }),
+                         c.students.end());
+    }
+}
+
+void CourseCatalog::clear() {
+    byLowercaseName.clear();
+    courses.clear();
+}
+
+size_t CourseCatalog::memoryUsage() const {
+    size_t bytes = byLowercaseName.capacity() * sizeof(int) + courses.capacity() * sizeof(CourseEntry);
+    for (const CourseEntry& c : courses) bytes += c.students.capacity() * sizeof(int);
+    return bytes;
+}
+
+int StudentStore::otherSlotOf(int index, int courseIndex) const {
+    const Student& s = records[index];
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    int lowercaseId = courseNames.folded(studentCourses[courseIndex].nameId);
+    for (int c = 0; c < s.numCourses; c++) {
+        if (c != courseIndex && courseNames.folded(studentCourses[c].nameId) == lowercaseId) return c;
+    }
+    return -1;
+}
+
+void StudentStore::enrollInCatalog(int index) {
+    const Student& s = records[index];
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    for (int c = 0; c < s.numCourses; c++) {
+        // A student joins the roster with the first slot carrying the course
+        int earlier = otherSlotOf(index, c);
+        catalog.enroll(catalog.intern(studentCourses[c].nameId), s.handleEntry, studentCourses[c].grade,
+                       earlier == -1 || earlier > c);
+    }
+}
+
+void StudentStore::rebuildCatalog() {
+    catalog.clear();
+    for (int i = 0; i < (int)records.size(); i++) enrollInCatalog(i);
+    catalogReady = true;
+}
+
+void StudentStore::withdrawFromCatalog(int index) {
+    if (!catalogReady) return;
+    const Student& s = records[index];
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    for (int c = 0; c < s.numCourses; c++) {
+        // The roster entry goes with the last slot carrying the course
+        int lowercaseId = courseNames.folded(studentCourses[c].nameId);
+        bool lastSlot = true;
+        for (int later = c + 1; later < s.numCourses && lastSlot; later++) {
+            lastSlot = courseNames.folded(studentCourses[later].nameId) != lowercaseId;
+        }
+        catalog.withdraw(catalog.find(studentCourses[c].nameId), s.handleEntry, studentCourses[c].grade, lastSlot);
+    }
+}
+
+const CourseCatalog& StudentStore::courseCatalog() {
+    if (!catalogReady) rebuildCatalog();
+    return catalog;
+}
+
+int StudentStore::courseRoster(int course, vector<int>& indices) {
+    courseCatalog();
+    return std::as_const(*this).courseRoster(course, indices);
+}
+
+int StudentStore::courseRoster(int course, vector<int>& indices) const {
+    const vector<int>& entries = catalog.enrolled(course);
+    indices.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) indices[i] = handleSlots[entries[i]];
+    return (int)indices.size();
+}
@@ -1,106 +1,48 @@
 #include "student.h"
+#include "student_parser.h"
+#include "student_journal.h"
+#include "student_repository.h"
+#include "grade_scale.h"
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
 
-void loadStudents() {
-    ifstream file(FILENAME);
-    if (!file.is_open()) {
-        cout << "No existing student data found. Starting with empty database.\n";
-        return;
-    }
-
-    string line;
-    numStudents = 0; // Reset student count
-    
-    while (getline(file, line) && numStudents < MAX_STUDENTS) {
-        if (line.empty()) continue; // Skip empty lines
-        
-        try {
-            Student s;
-            stringstream ss(line);
-            string token;
-
-            // Read ID
-            getline(ss, token, ',');
-            s.id = stoi(token);
-
-            // Read Name
-            getline(ss, s.name, ',');
-
-            // Read National ID
-            getline(ss, s.nationalId, ',');
-
-            // Read Courses
-            getline(ss, token, ',');
-            s.numCourses = stoi(token);
-            for(int i = 0; i < s.numCourses; i++) {
-                getline(ss, token, ':');
-                s.courses[i].name = token;
-                if (token.empty()) {
-                    s.numCourses = 0; // Reset if there's an issue
-                    break;
-                }
-                getline(ss, token, (i == s.numCourses - 1) ? ',' : ',');
-                if (!token.empty()) {
-                    s.courses[i].grade = stof(token);
-                } else {
-                    s.courses[i].grade = 0.0;
-                }
-            }
-
-            // Read GPA
-            getline(ss, token, ',');
-            if (!token.empty()) {
-                s.gpa = stof(token);
-            } else {
-                s.gpa = 0.0;
-            }
+int loaderThreads = 0;   // Use every hardware thread by default
 
-            // Read Study Plan
-            getline(ss, token, ',');
-            if (!token.empty()) {
-                s.numStudyPlan = stoi(token);
-                for(int i = 0; i < s.numStudyPlan; i++) {
-                    if (i == s.numStudyPlan - 1) {
-                        getline(ss, s.studyPlan[i]);
-                    } else {
-                        getline(ss, s.studyPlan[i], ',');
-                    }
-                }
-            } else {
-                s.numStudyPlan = 0;
-            }
+// Changes since the last snapshot are appended to the journal; the snapshot
+// is rewritten by a checkpoint once the journal grows past this size, or once
+// it holds any change and this much time has passed since the last checkpoint
+static const size_t CHECKPOINT_JOURNAL_BYTES = 4 << 20;
+static const chrono::seconds CHECKPOINT_INTERVAL(300);
 
-            students[numStudents++] = s;
-        } catch (const exception &e) {
-            cout << "Error parsing student data: " << e.what() << endl;
-            // Skip this record but continue with others
-            continue;
-        }
-    }
-    
-    file.close();
-    cout << numStudents << " students loaded from file.\n";
-}
+static StudentJournal journal;            // Journal of the global store
+static pid_t checkpointChild = -1;        // Process writing the snapshot, -1 if none
+static chrono::steady_clock::time_point lastCheckpoint = chrono::steady_clock::now();
 
-void saveStudents() {
-    ofstream file(FILENAME);
-    if (!file.is_open()) {
-        cout << "Error: Could not open file for saving.\n";
-        return;
-    }
+/**
+ * Write a store in the students.txt format
+ */
+bool writeStudentsFile(const char* path, const StudentStore& store) {
+    ofstream file(path);
+    if (!file.is_open()) return false;
     
-    for(int i = 0; i < numStudents; i++) {
+    for(int i = 0; i < store.size(); i++) {
         try {
-            Student& s = students[i];
+            const Student& s = store[i];
+            const Course* courses = store.courses(i);
+            const int* studyPlan = store.studyPlan(i);
             file << s.id << "," << s.name << "," << s.nationalId << ","
                  << s.numCourses << ",";
             
             // Write courses and grades
             if (s.numCourses > 0) {
                 for(int j = 0; j < s.numCourses; j++) {
-                    file << s.courses[j].name << ":" << s.courses[j].grade;
+                    file << courses[j].name() << ":" << courses[j].grade;
                     if (j < s.numCourses - 1) file << ",";
                 }
             }
@@ -110,7 +52,7 @@ void saveStudents() {
             // Write study plan
             if (s.numStudyPlan > 0) {
                 for(int j = 0; j < s.numStudyPlan; j++) {
-                    file << s.studyPlan[j];
+                    file << courseNames.view(studyPlan[j]);
                     if (j < s.numStudyPlan - 1) file << ",";
                 }
             }
@@ -122,5 +64,205 @@ void saveStudents() {
     }
     
     file.close();
-    cout << numStudents << " students saved to file.\n";
+    return !file.fail();
+}
+
+/**
+ * Engine of the data file, picked by its extension
+ */
+static unique_ptr<StudentRepository> dataFile() {
+    return makeStudentRepository(repositoryKindOf(SNAPSHOT_FILENAME), SNAPSHOT_FILENAME);
+}
+
+/**
+ * Replace the data file with the students of a store
+ *
+ * The engine writes a temporary file and renames it over the old one, so a
+ * crash leaves either the old or the new data file, never a partial one.
+ */
+static bool writeSnapshot(const StudentStore& store) {
+    string error;
+    return dataFile()->saveAll(store, error);
+}
+
+/**
+ * Report what replay could not use of a journal
+ *
+ * Returns false if a corrupt journal is still in place; appending to it
+ * would put new records where replay never reaches them.
+ */
+static bool reportJournalDamage(const char* path, const JournalDamage& damage) {
+    if (damage.discarded == 0) return true;
+    if (!damage.corrupt) {
+        cout << "Warning: " << damage.discarded << " bytes of an unfinished write cut from " << path << ".\n";
+        return true;
+    }
+    if (damage.movedTo.empty()) {
+        cout << "Error: " << path << " is corrupt and could not be moved away (" << damage.discarded
+             << " bytes not replayed). Move it away to start without them.\n";
+        return false;
+    }
+    cout << "Warning: " << path << " is corrupt, " << damage.discarded << " bytes not replayed. "
+         << "It was moved to " << damage.movedTo << ".\n";
+    return true;
+}
+
+void loadStudents() {
+    students.attachJournal(nullptr);
+    journal.close();
+    students.clear(); // Reset the store
+
+    // An institution's own grade boundaries replace the standard scale
+    GradeScale scale;
+    string scaleError;
+    if (loadGradeScale(GRADE_SCALE_FILENAME, scale, scaleError)) {
+        setGradeScale(scale);
+        cout << "Grade scale loaded from " << GRADE_SCALE_FILENAME << ".\n";
+    } else if (access(GRADE_SCALE_FILENAME, F_OK) == 0) {
+        cout << "Error: " << scaleError << ". Using the standard grade scale.\n";
+    }
+
+    // The data file is authoritative; students.txt is read only until the
+    // first checkpoint has written one
+    string snapshotError, textError;
+    int threads = loaderThreads > 0 ? loaderThreads : (int)thread::hardware_concurrency();
+    vector<ParseError> errors;
+    if (dataFile()->loadAll(students, snapshotError, errors)) {
+        if (!snapshotError.empty()) cout << "Warning: " << snapshotError << " in " << SNAPSHOT_FILENAME << ".\n";
+        cout << students.size() << " students loaded from snapshot.\n";
+    } else if (!snapshotError.empty()) {
+        // Starting without it would let the next checkpoint overwrite the data
+        cout << "Error: " << SNAPSHOT_FILENAME << " is unreadable (" << snapshotError
+             << "). Restore it or move it away to start from " << FILENAME << ".\n";
+        exit(1);
+    } else if (makeStudentRepository(REPOSITORY_TEXT, FILENAME)->loadAll(students, textError, errors)) {
+        // Malformed records are skipped, the rest of the file is still loaded
+        for (const ParseError& e : errors) {
+            cout << "Error parsing student data (line " << e.line << "): " << e.message << endl;
+        }
+        cout << students.size() << " students loaded from file.\n";
+    } else {
+        cout << "No existing student data found. Starting with empty database.\n";
+    }
+
+    // Replay changes made after the snapshot; the journal of an unfinished
+    // checkpoint comes first because it holds the older changes
+    JournalDamage oldDamage, damage;
+    int interrupted = replayJournal(OLD_JOURNAL_FILENAME, students, oldDamage);
+    int replayed = replayJournal(JOURNAL_FILENAME, students, damage);
+    if (interrupted > 0 || replayed > 0) {
+        cout << max(interrupted, 0) + max(replayed, 0) << " changes recovered from journal.\n";
+    }
+    if (!reportJournalDamage(OLD_JOURNAL_FILENAME, oldDamage) || !reportJournalDamage(JOURNAL_FILENAME, damage)) {
+        exit(1);
+    }
+
+    // GPAs saved under a different grade scale are brought up to date
+    int regraded = recomputeAllGPAs(students, threads);
+    if (regraded > 0) cout << regraded << " GPAs updated for the current grade scale.\n";
+    if (interrupted >= 0 || damage.corrupt) {
+        // Finish the interrupted checkpoint: the new snapshot covers both journals.
+        // A journal set aside is covered the same way, up to its bad record.
+        // The older journal must go first, replaying it alone would undo newer changes.
+        if (writeSnapshot(students)) {
+            remove(OLD_JOURNAL_FILENAME);
+            remove(JOURNAL_FILENAME);
+        }
+    }
+
+    if (journal.open(JOURNAL_FILENAME)) {
+        students.attachJournal(&journal);
+    } else {
+        cout << "Warning: Could not open journal, changes are saved on exit only.\n";
+    }
+}
+
+/**
+ * Reap the checkpoint process if it has finished (or wait for it)
+ *
+ * Returns true when no checkpoint is running any more.
+ */
+static bool checkpointFinished(bool wait) {
+    if (checkpointChild < 0) return true;
+    int status;
+    pid_t result = waitpid(checkpointChild, &status, wait ? 0 : WNOHANG);
+    if (result == 0) return false;   // Still writing
+    checkpointChild = -1;
+    // A failed checkpoint leaves the old journal behind; the next one covers it
+    return true;
+}
+
+void saveStudents() {
+    // A restart must not race with a snapshot that is still being renamed
+    // into place, so wait for a running checkpoint (normally already done)
+    checkpointFinished(true);
+
+    if (journal.isOpen()) {
+        // Every change is already in the journal, only the tail needs committing;
+        // if a group was lost, a snapshot saves the store instead
+        if (!commitChanges()) {
+            cout << "Error: Could not write journal or file for saving.\n";
+            return;
+        }
+    } else if (!writeSnapshot(students)) {
+        cout << "Error: Could not open file for saving.\n";
+        return;
+    }
+    cout << students.size() << " students saved to file.\n";
+}
+
+/**
+ * Make the whole store durable after the journal lost a group
+ *
+ * The lost changes are only in memory. A full snapshot covers them, and a
+ * fresh journal clears the journal's failure, so later rounds commit again.
+ */
+static bool snapshotOverJournal() {
+    checkpointFinished(true);   // Its snapshot would be older than this one
+    if (!writeSnapshot(students)) return false;
+    journal.close();
+    remove(OLD_JOURNAL_FILENAME);
+    remove(JOURNAL_FILENAME);
+    lastCheckpoint = chrono::steady_clock::now();
+    if (!journal.open(JOURNAL_FILENAME)) {
+        cout << "Warning: Could not open journal, changes are saved on exit only.\n";
+    }
+    return true;
+}
+
+bool commitChanges() {
+    // Without a journal changes are only saved on exit
+    if (!journal.isOpen() || journal.sync()) return true;
+    return snapshotOverJournal();
+}
+
+void checkpointIfNeeded() {
+    if (!journal.isOpen() || !checkpointFinished(false)) return;
+    bool full = journal.size() >= CHECKPOINT_JOURNAL_BYTES;
+    bool due = chrono::steady_clock::now() - lastCheckpoint >= CHECKPOINT_INTERVAL;
+    if (!full && !(due && journal.hasRecords())) return;
+
+    // Start a fresh journal, unless an earlier checkpoint failed and its
+    // journal is still waiting; then the new snapshot covers both journals
+    FILE* leftover = fopen(OLD_JOURNAL_FILENAME, "r");
+    if (leftover) fclose(leftover);
+    else if (!journal.rotate(OLD_JOURNAL_FILENAME)) return;
+
+    lastCheckpoint = chrono::steady_clock::now();
+
+    // The snapshot is written by a child process. fork() gives it a
+    // copy-on-write image of the store that matches the old journal exactly,
+    // without copying the store here; later changes go to the new journal.
+    cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        bool ok = writeSnapshot(students) && remove(OLD_JOURNAL_FILENAME) == 0;
+        _exit(ok ? 0 : 1);   // Skip destructors, they belong to the parent
+    }
+    if (child < 0) {
+        // No process available, write the snapshot here instead
+        if (writeSnapshot(students)) remove(OLD_JOURNAL_FILENAME);
+        return;
+    }
+    checkpointChild = child;
 }
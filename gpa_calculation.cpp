@@ -6,60 +6,123 @@
  */
 
 #include "student.h"   // Include student structure definitions
+#include "grade_scale.h" // Include the configurable grade scale
 #include <iostream>    // Include for input/output operations
 #include <iomanip>     // Include for output formatting
 #include <algorithm>   // Include for min/max functions
+#include <thread>      // Include for the parallel recompute
 
 /**
  * Convert numerical grade (0-100) to 4.0 scale
  * 
+ * Uses the active grade scale (see grade_scale.h), by default the standard
+ * scale from A (93-100) = 4.00 down to D- (60-62.9) = 0.70 and F = 0.00.
+ * 
  * @param numericGrade The percentage grade (0-100)
  * @return The equivalent grade on 4.0 scale
  */
 float convertGradeTo4Scale(float numericGrade) {
-    // Convert percentage grade to 4.0 scale using standard grade scale
-    if (numericGrade >= 93.0) return 4.00;      // A  (93-100)
-    else if (numericGrade >= 90.0) return 3.70; // A- (90-92.9)
-    else if (numericGrade >= 87.0) return 3.33; // B+ (87-89.9)
-    else if (numericGrade >= 83.0) return 3.00; // B  (83-86.9)
-    else if (numericGrade >= 80.0) return 2.70; // B- (80-82.9)
-    else if (numericGrade >= 77.0) return 2.30; // C+ (77-79.9)
-    else if (numericGrade >= 73.0) return 2.00; // C  (73-76.9)
-    else if (numericGrade >= 70.0) return 1.70; // C- (70-72.9)
-    else if (numericGrade >= 67.0) return 1.30; // D+ (67-69.9)
-    else if (numericGrade >= 63.0) return 1.00; // D  (63-66.9)
-    else if (numericGrade >= 60.0) return 0.70; // D- (60-62.9)
-    else return 0.00;                           // F  (0-59.9)
+    return gradeScale().convert(numericGrade);
+}
+
+/**
+ * GPA for a sum of 4.0-scale grade points
+ * 
+ * @param gradePoints Sum of the converted grades of all courses
+ * @param numCourses Number of courses in the sum
+ * @return The GPA, 0.0 without courses and capped at 4.0
+ */
+float calculateGPA(double gradePoints, int numCourses) {
+    if (numCourses == 0) return 0.0f;
+    return min((float)(gradePoints / numCourses), 4.0f);
+}
+
+/**
+ * GPA of a student recomputed from its courses, without touching the store
+ * 
+ * @param store The store holding the student
+ * @param index The index of the student in the store
+ * @return The GPA on the 4.0 scale
+ */
+float calculateGPA(const StudentStore& store, int index) {
+    const Student& s = store[index];
+    const Course* courses = store.courses(index);
+    double total = 0.0;
+    for (int i = 0; i < s.numCourses; i++) total += convertGradeTo4Scale(courses[i].grade);
+    return calculateGPA(total, s.numCourses);
+}
+
+/**
+ * Recompute the running grade point sum of every student from its courses
+ * 
+ * Used to repair the sums and GPAs, e.g. after the grade scale changes. The sums are
+ * computed in parallel over slices of the store; only students whose sum
+ * differs are then updated (and journaled) on the calling thread.
+ * 
+ * @param store The store to repair
+ * @param threads Worker threads, 0 for every hardware thread
+ * @return The number of students whose GPA changed
+ */
+int recomputeAllGPAs(StudentStore& store, int threads) {
+    int n = store.size();
+    if (threads < 1) threads = max(1, (int)thread::hardware_concurrency());
+    const int minimumSlice = 16384;   // Smaller slices do not pay for a thread
+    threads = max(1, min(threads, n / minimumSlice));
+
+    vector<double> sums(n);
+    auto sumSlice = [&store, &sums](int begin, int end) {
+        // Convert the grades of a whole slice in one batch
+        vector<float> grades, points;
+        for (int i = begin; i < end; i++) {
+            const Course* courses = store.courses(i);
+            for (int c = 0; c < store[i].numCourses; c++) grades.push_back(courses[c].grade);
+        }
+        points.resize(grades.size());
+        gradeScale().convertBatch(grades.data(), points.data(), grades.size());
+
+        size_t next = 0;
+        for (int i = begin; i < end; i++) {
+            double total = 0.0;
+            for (int c = 0; c < store[i].numCourses; c++) total += points[next++];
+            sums[i] = total;
+        }
+    };
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(sumSlice, (int)((long long)n * t / threads),
+                             (int)((long long)n * (t + 1) / threads));
+    }
+    sumSlice(0, n / threads);
+    for (thread& worker : workers) worker.join();
+
+    int repaired = 0;
+    for (int i = 0; i < n; i++) {
+        const Student& s = store[i];
+        if (sums[i] == s.gradePoints && calculateGPA(sums[i], s.numCourses) == s.gpa) continue;
+        float before = store[i].gpa;
+        store.setGradePoints(i, sums[i]);
+        if (store[i].gpa != before) repaired++;
+    }
+    return repaired;
 }
 
 /**
- * Compute the GPA for a student based on their courses
+ * Report the GPA for a student based on their courses
+ * 
+ * The store keeps the GPA current as courses are added and removed, so
+ * this only handles students without courses and prints the result.
  * 
- * @param index The index of the student in the global array
+ * @param index The index of the student in the global store
  */
 void computeGPA(int index) {
-    Student& s = students[index];  // Get reference to student object
+    const Student& s = students[index];  // Get reference to student object
     
     // Check if student has any courses
     if(s.numCourses == 0) {
-        s.gpa = 0.0;              // Set GPA to 0 if no courses
+        students.setGpa(index, 0.0f); // Set GPA to 0 if no courses
         cout << "No courses available. GPA set to 0.0\n";  // Inform user
         return;                    // Exit the function
     }
-
-    float total = 0.0;            // Variable to store sum of grade points
-    
-    // Loop through all courses and sum up grade points
-    for(int i = 0; i < s.numCourses; i++) {
-        // Convert each course grade to 4.0 scale before adding
-        total += convertGradeTo4Scale(s.courses[i].grade);
-    }
-    
-    // Calculate GPA by dividing total by number of courses
-    s.gpa = total / s.numCourses;
-    
-    // Ensure GPA doesn't exceed 4.0 (cap it if necessary)
-    s.gpa = min(s.gpa, 4.0f);     // Cap at 4.0
     
     // Display GPA with 2 decimal places for readability
     cout << "GPA updated: " << fixed << setprecision(2) << s.gpa << endl;
@@ -0,0 +1,200 @@
+/**
+ * Grade Import Module
+ *
+ * This file contains the grade sheet parser and the import that groups the
+ * parsed rows by student and applies them to the store.
+ */
+
+#include "grade_import.h"   // Include grade import declarations
+#include <algorithm>        // Include for sort, find, min and upper_bound
+#include <atomic>           // Include for handing out sheets to workers
+#include <cctype>           // Include for isdigit
+#include <charconv>         // Include for from_chars
+#include <chrono>           // Include for timing the import
+#include <cstring>          // Include for memchr
+#include <thread>           // Include for parallel parsing
+
+/**
+ * Rows of one sheet that parsed; index is the store index once looked up
+ */
+struct SheetRow {
+    int index;
+    float grade;
+    int line;
+};
+
+string courseNameFromPath(const string& path) {
+    size_t start = path.find_last_of('/');
+    start = start == string::npos ? 0 : start + 1;
+    size_t end = path.find_last_of('.');
+    if (end == string::npos || end <= start) end = path.size();
+    return path.substr(start, end - start);
+}
+
+static string_view trimmed(string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * Parse one sheet into rows, look up their students and reject what cannot
+ * be applied. seenLine has one zeroed entry per student and is zeroed again
+ * on return.
+ */
+static void parseSheet(const GradeSheet& sheet, const StudentStore& store, GradeSheetResult& result,
+                       vector<SheetRow>& rows, vector<int>& seenLine) {
+    MappedFile file;
+    if (!file.open(sheet.path.c_str())) return;
+    result.opened = true;
+
+    vector<int> ids;
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    bool firstLine = true;
+    for (int lineNumber = 1; pos < end; lineNumber++) {
+        const char* newline = (const char*)memchr(pos, '\n', end - pos);
+        const char* lineEnd = newline ? newline : end;
+        string_view line(pos, lineEnd - pos);
+        pos = lineEnd + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);   // Tolerate CRLF files
+        line = trimmed(line);
+        if (line.empty()) continue;
+
+        // A header names the columns instead of starting with an ID
+        bool header = firstLine && !isdigit((unsigned char)line[0]) && line[0] != '-' && line[0] != '+';
+        firstLine = false;
+        if (header) continue;
+        result.rows++;
+
+        size_t comma = line.find(',');
+        string_view idField = trimmed(line.substr(0, comma));
+        string_view gradeField = comma == string_view::npos ? string_view() : trimmed(line.substr(comma + 1));
+        int id;
+        float grade;
+        const char* idEnd = idField.data() + idField.size();
+        const char* gradeEnd = gradeField.data() + gradeField.size();
+        if (from_chars(idField.data(), idEnd, id).ptr != idEnd || idField.empty()) {
+            result.rejected.push_back(ParseError{ lineNumber, "invalid student ID" });
+        } else if (gradeField.empty()) {
+            result.rejected.push_back(ParseError{ lineNumber, "missing grade" });
+        } else if (from_chars(gradeField.data(), gradeEnd, grade).ptr != gradeEnd) {
+            result.rejected.push_back(ParseError{ lineNumber, "invalid grade" });
+        } else if (!(grade >= 0.0f && grade <= 100.0f)) {
+            result.rejected.push_back(ParseError{ lineNumber, "grade must be between 0 and 100" });
+        } else {
+            ids.push_back(id);
+            rows.push_back(SheetRow{ -1, grade, lineNumber });
+        }
+    }
+
+    // Look the students up in one batch, keeping the first row per student
+    vector<int> indices;
+    store.findBatch(ids, indices);
+    size_t kept = 0;
+    for (size_t r = 0; r < rows.size(); r++) {
+        int index = indices[r];
+        if (index == -1) {
+            result.rejected.push_back(ParseError{ rows[r].line, "unknown student ID " + to_string(ids[r]) });
+        } else if (seenLine[index] != 0) {
+            result.rejected.push_back(ParseError{ rows[r].line, "student " + to_string(ids[r]) +
+                                                  " already graded on line " + to_string(seenLine[index]) });
+        } else {
+            seenLine[index] = rows[r].line;
+            rows[kept] = rows[r];
+            rows[kept++].index = index;
+        }
+    }
+    rows.resize(kept);
+    for (const SheetRow& row : rows) seenLine[row.index] = 0;
+}
+
+GradeImportReport importGradeSheets(const vector<GradeSheet>& sheets, StudentStore& store, int threads) {
+    auto start = chrono::steady_clock::now();
+    GradeImportReport report;
+    int numSheets = (int)sheets.size();
+    report.sheets.resize(numSheets);
+
+    // Course names are interned up front; courseNames is not thread-safe
+    vector<int> nameIds(numSheets);
+    for (int i = 0; i < numSheets; i++) {
+        GradeSheetResult& result = report.sheets[i];
+        result.course = sheets[i].course.empty() ? courseNameFromPath(sheets[i].path) : sheets[i].course;
+        nameIds[i] = courseNames.intern(result.course);
+    }
+
+    // Workers take whole sheets; the store is only read until they finish
+    if (threads < 1) threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(threads, numSheets));
+    vector<vector<SheetRow>> rows(numSheets);
+    atomic<int> nextSheet(0);
+    auto worker = [&]() {
+        vector<int> seenLine(store.size(), 0);
+        for (int i = nextSheet++; i < numSheets; i = nextSheet++) {
+            parseSheet(sheets[i], store, report.sheets[i], rows[i], seenLine);
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool) t.join();
+
+    // Group the rows by student with a counting sort; row numbers run
+    // across sheets, sheet i starting at firstRow[i]
+    vector<int> firstRow(numSheets + 1, 0);
+    for (int i = 0; i < numSheets; i++) firstRow[i + 1] = firstRow[i] + (int)rows[i].size();
+    vector<int> studentStart(store.size() + 1, 0);
+    for (const vector<SheetRow>& sheetRows : rows) {
+        for (const SheetRow& row : sheetRows) studentStart[row.index + 1]++;
+    }
+    for (int i = 0; i < store.size(); i++) studentStart[i + 1] += studentStart[i];
+    vector<int> grouped(firstRow[numSheets]);
+    vector<int> next(studentStart.begin(), studentStart.end() - 1);
+    for (int i = 0; i < numSheets; i++) {
+        for (int r = 0; r < (int)rows[i].size(); r++) grouped[next[rows[i][r].index]++] = firstRow[i] + r;
+    }
+
+    // One update per student; new courses stop at MAX_COURSES
+    vector<Course> updates;
+    vector<int> courses;   // Lowercase name IDs the student takes or is being given
+    for (int index = 0; index < store.size(); index++) {
+        if (studentStart[index] == studentStart[index + 1]) continue;
+        updates.clear();
+        courses.clear();
+        const Course* studentCourses = store.courses(index);
+        int numCourses = store[index].numCourses;
+        for (int c = 0; c < numCourses; c++) courses.push_back(courseNames.folded(studentCourses[c].nameId));
+
+        for (int g = studentStart[index]; g < studentStart[index + 1]; g++) {
+            int sheet = (int)(upper_bound(firstRow.begin(), firstRow.end(), grouped[g]) - firstRow.begin()) - 1;
+            const SheetRow& row = rows[sheet][grouped[g] - firstRow[sheet]];
+            int lowercaseId = courseNames.folded(nameIds[sheet]);
+            if (std::find(courses.begin(), courses.end(), lowercaseId) == courses.end()) {
+                if (numCourses >= MAX_COURSES) {
+                    report.sheets[sheet].rejected.push_back(ParseError{ row.line,
+                        "student " + to_string(store[index].id) + " already has " + to_string(MAX_COURSES) + " courses" });
+                    continue;
+                }
+                courses.push_back(lowercaseId);
+                numCourses++;
+            }
+            Course update;
+            update.nameId = nameIds[sheet];
+            update.grade = row.grade;
+            updates.push_back(update);
+            report.sheets[sheet].imported++;
+        }
+        if (updates.empty()) continue;
+        store.setCourseGrades(index, updates.data(), (int)updates.size());
+        report.studentsUpdated++;
+        report.updatedIds.push_back(store[index].id);
+    }
+
+    for (GradeSheetResult& result : report.sheets) {
+        std::sort(result.rejected.begin(), result.rejected.end(),
+             [](const ParseError& a, const ParseError& b) { return a.line < b.line; });
+        result.rejectedRows = (int)result.rejected.size();
+    }
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
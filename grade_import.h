@@ -0,0 +1,62 @@
+/**
+ * grade_import.h - Bulk import of grade sheets
+ *
+ * A grade sheet is a CSV file with the grades of one course, one
+ * "student_id,grade" row per line. A first line that does not start with a
+ * number is a header and is skipped, as are empty lines. Unless a course
+ * name is given, the course is named after the file, without directory and
+ * extension ("sheets/Mathematics.csv" holds Mathematics grades).
+ *
+ * The sheets are memory-mapped and parsed in parallel, and the student IDs
+ * are looked up in batches. The accepted rows of all sheets are then grouped
+ * by student and each student is updated once, so its GPA, the maintained
+ * orders and rankings and the journal see one change however many sheets
+ * grade the student. A row for a course the student already takes replaces
+ * that grade; otherwise the course is added. Rows that cannot be applied are
+ * reported with their line numbers and skipped; no exceptions are used.
+ */
+
+#ifndef GRADE_IMPORT_H
+#define GRADE_IMPORT_H
+
+#include "student.h"          // Include student structure definitions
+#include "student_parser.h"   // Include ParseError for rejected rows
+
+/**
+ * A sheet to import
+ */
+struct GradeSheet {
+    string path;      // CSV file
+    string course;    // Course name; empty to name it after the file
+};
+
+/**
+ * What happened to one sheet
+ */
+struct GradeSheetResult {
+    string course;                 // Course the sheet was imported as
+    bool opened = false;           // Whether the file could be read
+    int rows = 0;                  // Data rows (no header or empty lines)
+    int imported = 0;              // Rows applied to the store
+    int rejectedRows = 0;          // Rows that were skipped
+    vector<ParseError> rejected;   // Those rows by line number; only the first ones from a server
+};
+
+/**
+ * What happened to an import
+ */
+struct GradeImportReport {
+    vector<GradeSheetResult> sheets;   // One per sheet, in the order given
+    int studentsUpdated = 0;           // Students whose grades were set
+    vector<int> updatedIds;            // Their IDs
+    double seconds = 0.0;              // Time for the whole import
+};
+
+// Course name of a sheet named after its file
+string courseNameFromPath(const string& path);
+
+// Import grade sheets into a store; threads parse sheets in parallel (0 for
+// every hardware thread)
+GradeImportReport importGradeSheets(const vector<GradeSheet>& sheets, StudentStore& store, int threads = 0);
+
+#endif // GRADE_IMPORT_H
@@ -0,0 +1,227 @@
+/**
+ * Grade Scale Module
+ *
+ * This file contains the configurable grade scale and its scalar and SIMD
+ * batch conversions.
+ */
+
+#include "grade_scale.h"   // Include grade scale declarations
+#include <fstream>         // Include for reading scale files
+#include <sstream>         // Include for parsing scale lines
+#include <cstdint>         // Include for int32_t
+#include <cmath>           // Include for INFINITY
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>     // Include for SSE2 and AVX2 intrinsics
+#define GRADE_SCALE_X86 1
+#endif
+
+// The scale convertGradeTo4Scale() has always used
+static const GradeBoundary STANDARD_SCALE[] = {
+    { 93.0f, 4.00f },   // A  (93-100)
+    { 90.0f, 3.70f },   // A- (90-92.9)
+    { 87.0f, 3.33f },   // B+ (87-89.9)
+    { 83.0f, 3.00f },   // B  (83-86.9)
+    { 80.0f, 2.70f },   // B- (80-82.9)
+    { 77.0f, 2.30f },   // C+ (77-79.9)
+    { 73.0f, 2.00f },   // C  (73-76.9)
+    { 70.0f, 1.70f },   // C- (70-72.9)
+    { 67.0f, 1.30f },   // D+ (67-69.9)
+    { 63.0f, 1.00f },   // D  (63-66.9)
+    { 60.0f, 0.70f }    // D- (60-62.9), below is F (0.00)
+};
+
+GradeScale::GradeScale() {
+    string error;
+    setBoundaries(vector<GradeBoundary>(begin(STANDARD_SCALE), end(STANDARD_SCALE)), error);
+}
+
+bool GradeScale::setBoundaries(const vector<GradeBoundary>& newSteps, string& error) {
+    if (newSteps.empty()) {
+        error = "a grade scale needs at least one boundary";
+        return false;
+    }
+    for (size_t i = 0; i < newSteps.size(); i++) {
+        // Written as a negation so that NaN boundaries are rejected too
+        if (!(newSteps[i].points >= 0.0f && newSteps[i].points <= 4.0f)) {
+            error = "points must be between 0 and 4";
+            return false;
+        }
+        if (i > 0 && !(newSteps[i].minGrade < newSteps[i - 1].minGrade)) {
+            error = "minimum grades must be strictly decreasing";
+            return false;
+        }
+    }
+
+    // A grade that reaches c thresholds earns the points of the c-th lowest step
+    steps = newSteps;
+    thresholds.clear();
+    pointsReached.assign(1, 0.0f);
+    for (size_t i = steps.size(); i-- > 0;) {
+        thresholds.push_back(steps[i].minGrade);
+        pointsReached.push_back(steps[i].points);
+    }
+
+    // Bucket b holds the grades in [b, b + 1): they all reach the thresholds
+    // up to b, plus at most the one threshold that may lie inside the bucket
+    buckets.assign(GRADE_BUCKETS, GradeBucket());
+    for (int b = 0; b < GRADE_BUCKETS; b++) {
+        GradeBucket& bucket = buckets[b];
+        bucket.reached = slowReached((float)b);
+        bucket.split = INFINITY;
+        int inside = 0;
+        for (float threshold : thresholds) {
+            if (threshold > (float)b && threshold < (float)(b + 1)) {
+                bucket.split = threshold;
+                inside++;
+            }
+        }
+        if (inside > 1) bucket.reached = -1;   // Too fine for the table, search instead
+    }
+    return true;
+}
+
+int GradeScale::slowReached(float grade) const {
+    int reached = 0;
+    for (float threshold : thresholds) reached += grade >= threshold;   // NaN reaches none
+    return reached;
+}
+
+float GradeScale::convert(float grade) const {
+    return pointsReached[reached(grade)];
+}
+
+void GradeScale::convertPortable(const float* grades, float* points, size_t count) const {
+    for (size_t i = 0; i < count; i++) points[i] = pointsReached[reached(grades[i])];
+}
+
+#ifdef GRADE_SCALE_X86
+/**
+ * SSE2 batch conversion: comparison masks are -1, so subtracting them counts.
+ * Returns how many grades were converted (a multiple of 4).
+ */
+static size_t convertSse2(const float* thresholds, int numThresholds, const float* pointsReached,
+                          const float* grades, float* points, size_t count) {
+    size_t i = 0;
+    alignas(16) int32_t reached[4];
+    for (; i + 4 <= count; i += 4) {
+        __m128 grade = _mm_loadu_ps(grades + i);
+        __m128i counter = _mm_setzero_si128();
+        for (int k = 0; k < numThresholds; k++) {
+            __m128 mask = _mm_cmpge_ps(grade, _mm_set1_ps(thresholds[k]));
+            counter = _mm_sub_epi32(counter, _mm_castps_si128(mask));
+        }
+        _mm_store_si128((__m128i*)reached, counter);
+        points[i] = pointsReached[reached[0]];
+        points[i + 1] = pointsReached[reached[1]];
+        points[i + 2] = pointsReached[reached[2]];
+        points[i + 3] = pointsReached[reached[3]];
+    }
+    return i;
+}
+
+/**
+ * AVX2 batch conversion: counts as above, then one gather for the lookup.
+ * Returns how many grades were converted (a multiple of 8).
+ */
+__attribute__((target("avx2")))
+static size_t convertAvx2(const float* thresholds, int numThresholds, const float* pointsReached,
+                          const float* grades, float* points, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 grade = _mm256_loadu_ps(grades + i);
+        __m256i counter = _mm256_setzero_si256();
+        for (int k = 0; k < numThresholds; k++) {
+            __m256 mask = _mm256_cmp_ps(grade, _mm256_set1_ps(thresholds[k]), _CMP_GE_OQ);
+            counter = _mm256_sub_epi32(counter, _mm256_castps_si256(mask));
+        }
+        _mm256_storeu_ps(points + i, _mm256_i32gather_ps(pointsReached, counter, 4));
+    }
+    return i;
+}
+#endif
+
+bool GradeScale::kernelSupported(GradeKernel kernel) {
+    switch (kernel) {
+        case GRADE_KERNEL_AUTO:
+        case GRADE_KERNEL_SCALAR:
+            return true;
+#ifdef GRADE_SCALE_X86
+        case GRADE_KERNEL_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case GRADE_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+void GradeScale::convertBatch(const float* grades, float* points, size_t count,
+                              GradeKernel kernel) const {
+    if (kernel == GRADE_KERNEL_AUTO) {
+        static const GradeKernel best = kernelSupported(GRADE_KERNEL_AVX2) ? GRADE_KERNEL_AVX2
+                                      : kernelSupported(GRADE_KERNEL_SSE2) ? GRADE_KERNEL_SSE2
+                                      : GRADE_KERNEL_SCALAR;
+        kernel = best;
+    } else if (!kernelSupported(kernel)) {
+        kernel = GRADE_KERNEL_SCALAR;
+    }
+
+    int numThresholds = (int)thresholds.size();
+    size_t done = 0;
+    switch (kernel) {
+#ifdef GRADE_SCALE_X86
+        case GRADE_KERNEL_AVX2:
+            done = convertAvx2(thresholds.data(), numThresholds, pointsReached.data(), grades, points, count);
+            break;
+        case GRADE_KERNEL_SSE2:
+            done = convertSse2(thresholds.data(), numThresholds, pointsReached.data(), grades, points, count);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertPortable(grades + done, points + done, count - done);   // Remainder, or everything
+}
+
+static GradeScale activeScale;   // Scale used by convertGradeTo4Scale()
+
+const GradeScale& gradeScale() {
+    return activeScale;
+}
+
+void setGradeScale(const GradeScale& scale) {
+    activeScale = scale;
+}
+
+bool loadGradeScale(const char* path, GradeScale& scale, string& error) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        error = string("could not open ") + path;
+        return false;
+    }
+
+    vector<GradeBoundary> steps;
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#') continue;
+
+        stringstream fields(line);
+        GradeBoundary step;
+        string rest;
+        if (!(fields >> step.minGrade >> step.points) || (fields >> rest)) {
+            error = "line " + to_string(lineNumber) + ": expected \"<minimum grade> <points>\"";
+            return false;
+        }
+        steps.push_back(step);
+    }
+    if (!scale.setBoundaries(steps, error)) {
+        error = string(path) + ": " + error;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+/**
+ * grade_scale.h - Configurable conversion of numeric grades to the 4.0 scale
+ *
+ * A scale is a list of boundaries, each a minimum numeric grade and the
+ * points it earns; grades below the lowest boundary earn 0.0. Conversion
+ * counts the boundaries a grade reaches and looks the points up by that
+ * count. The scalar path finds the count in a table over whole-number
+ * grades; the batch conversion counts with SIMD comparisons (AVX2 or SSE2
+ * when the CPU has them). Both give bit-identical results.
+ */
+
+#ifndef GRADE_SCALE_H
+#define GRADE_SCALE_H
+
+#include "student.h"   // Include student structure definitions
+
+/**
+ * One step of a grade scale
+ */
+struct GradeBoundary {
+    float minGrade;   // Lowest numeric grade of the step
+    float points;     // 4.0-scale points earned from minGrade upwards
+};
+
+/**
+ * Implementations of the batch conversion
+ */
+enum GradeKernel {
+    GRADE_KERNEL_AUTO,     // Best kernel the CPU supports
+    GRADE_KERNEL_SCALAR,   // Portable table lookup
+    GRADE_KERNEL_SSE2,     // 4 grades per step
+    GRADE_KERNEL_AVX2      // 8 grades per step with a gathered lookup
+};
+
+/**
+ * GradeScale - Boundaries of a grading scale with fast conversion
+ */
+class GradeScale {
+public:
+    GradeScale();   // The standard scale (A = 93 and above ... D- = 60 to 62.9)
+
+    // Replace the boundaries; they must have strictly decreasing minimum grades.
+    // Returns false and describes the problem in error if they are invalid.
+    bool setBoundaries(const vector<GradeBoundary>& steps, string& error);
+    const vector<GradeBoundary>& boundaries() const { return steps; }
+
+    float convert(float grade) const;   // Points for one grade
+    void convertBatch(const float* grades, float* points, size_t count,
+                      GradeKernel kernel = GRADE_KERNEL_AUTO) const;
+
+    static bool kernelSupported(GradeKernel kernel);
+
+private:
+    // Quantised lookup: grades in [b, b + 1) share bucket b
+    struct GradeBucket {
+        float split;     // Threshold inside the bucket, or infinity if none
+        int reached;     // Thresholds reached at the start of the bucket, -1 to search
+    };
+    static const int GRADE_BUCKETS = 128;   // Covers grades 0 to 127.99
+
+    int slowReached(float grade) const;     // Compare against every threshold
+    int reached(float grade) const {        // Number of thresholds a grade reaches
+        if (grade >= 0.0f && grade < (float)GRADE_BUCKETS) {   // False for NaN
+            const GradeBucket& bucket = buckets[(int)grade];
+            if (bucket.reached >= 0) return bucket.reached + (grade >= bucket.split);
+        }
+        return slowReached(grade);
+    }
+    void convertPortable(const float* grades, float* points, size_t count) const;
+
+    vector<GradeBoundary> steps;    // Boundaries, highest minimum grade first
+    vector<float> thresholds;       // Minimum grades, lowest first
+    vector<float> pointsReached;    // Points by number of thresholds reached
+    vector<GradeBucket> buckets;    // Lookup table over quantised grades
+};
+
+const GradeScale& gradeScale();                  // Scale used by convertGradeTo4Scale()
+void setGradeScale(const GradeScale& scale);     // Replace it (running GPA sums then need recomputeAllGPAs)
+
+// Read a scale from a file with one "<minimum grade> <points>" pair per line;
+// blank lines and lines starting with '#' are ignored
+bool loadGradeScale(const char* path, GradeScale& scale, string& error);
+
+#endif // GRADE_SCALE_H
@@ -6,6 +6,11 @@
  */
 
 #include "student.h"   // Include student structure definitions
+#include "student_query.h" // Include the filter queries
+#include "student_analytics.h" // Include the cohort statistics
+#include "grade_import.h" // Include the grade sheet import
+#include "student_export.h" // Include the export writers
+#include "student_client.h" // Include the changes made locally or through a server
 #include <ncurses.h>   // Include ncurses library for terminal UI
 #include <menu.h>      // Include menu library for ncurses menus
 #include <string>      // Include string library for string manipulation
@@ -16,10 +21,10 @@
 #include <ctime>       // Include for date and time functions
 #include <algorithm>   // Include for sorting algorithms
 #include <functional>  // Include for function objects
+#include <iostream>    // Include for errors before the screen is set up
 
 // Define global variables
-Student students[MAX_STUDENTS];  // Array to store student data
-int numStudents = 0;             // Counter for number of students
+StudentStore students;           // Store holding the student records
 
 // Forward declarations of functions
 void initializeGUI();            // Initialize the ncurses GUI
@@ -29,6 +34,11 @@ void displayStudentList(bool sortedById);  // Display list of students
 void addStudentForm();           // Form to add a new student
 void deleteStudentForm();        // Form to delete a student
 void searchStudentForm();        // Form to search for a student
+void queryStudentsForm();        // Form to filter students by conditions
+void cohortDashboard();          // Screen with cohort statistics
+void rankStudentsForm();         // Form to list the best or worst students by GPA
+void importGradesForm();         // Form to import grade sheets
+void exportStudentsForm();       // Form to export all students
 void modifyStudentForm();        // Form to modify student data
 void manageCourseMenu();         // Menu for course management
 void computeGPAForm();           // Form to compute GPA
@@ -73,7 +83,7 @@ void initializeGUI() {
     getmaxyx(stdscr, termHeight, termWidth);
     
     // Define content area dimensions
-    menuHeight = 12;
+    menuHeight = 22;   // Title, fifteen items, prompt
     menuWidth = 40;
     contentHeight = termHeight - statusHeight - 2;  // -2 for header
     contentWidth = termWidth;
@@ -264,7 +274,12 @@ void displayMainMenu() {
     mvwprintw(menuwin, startRow + 6, indent, "7. Manage Courses");
     mvwprintw(menuwin, startRow + 7, indent, "8. Compute GPA");
     mvwprintw(menuwin, startRow + 8, indent, "9. Update Study Plan");
-    mvwprintw(menuwin, startRow + 9, indent, "0. Exit");
+    mvwprintw(menuwin, startRow + 9, indent, "10. Query Students");
+    mvwprintw(menuwin, startRow + 10, indent, "11. Cohort Statistics");
+    mvwprintw(menuwin, startRow + 11, indent, "12. Rank Students");
+    mvwprintw(menuwin, startRow + 12, indent, "13. Import Grade Sheets");
+    mvwprintw(menuwin, startRow + 13, indent, "14. Export Students");
+    mvwprintw(menuwin, startRow + 14, indent, "0. Exit");
     
     // Separator line above prompt
     mvwhline(menuwin, menuHeight - 3, 1, ACS_HLINE, menuWidth - 2);
@@ -288,6 +303,7 @@ void processMainMenu() {
     // Get user input
     wmove(menuwin, menuHeight - 2, 21);  // Position cursor for input
     wscanw(menuwin, "%d", &choice);
+    applyServerChanges();  // Take in what other clients of the server changed meanwhile
     
     noecho();  // Disable echo
     curs_set(0);  // Hide cursor
@@ -321,22 +337,47 @@ void processMainMenu() {
         case 9:
             updateStudyPlanForm();
             break;
-        case 0:
-            // Save and exit
-            saveStudents();
+        case 10:
+            queryStudentsForm();
+            break;
+        case 11:
+            cohortDashboard();
+            break;
+        case 12:
+            rankStudentsForm();
+            break;
+        case 13:
+            importGradesForm();
+            break;
+        case 14:
+            exportStudentsForm();
+            break;
+        case 0: {
+            // Let running exports finish, then save and exit
+            std::vector<FinishedExport> finished;
+            finishedBackgroundExports(true, finished);
+            if (!connectedToServer()) saveStudents();   // A server saves its own store
             cleanupGUI();
             exit(0);
             break;
+        }
         default:
             showMessage("Invalid choice! Please try again.");
             break;
     }
 }
 
-// Main GUI execution function
-void runGUI() {
+// Main GUI execution function; with a server socket the students are the
+// server's instead of those on disk
+void runGUI(const char* serverSocket) {
     // Load existing student data
-    loadStudents();
+    std::string error;
+    if (!serverSocket) {
+        loadStudents();
+    } else if (!connectToServer(serverSocket, error)) {
+        std::cout << "Error: " << error << ".\n";
+        return;
+    }
     
     // Initialize ncurses GUI
     initializeGUI();
@@ -350,6 +391,17 @@ void runGUI() {
         
         // Process user input
         processMainMenu();
+
+        // Keep the journal short between sessions
+        checkpointIfNeeded();
+
+        // Tell about background exports that finished meanwhile
+        std::vector<FinishedExport> finished;
+        finishedBackgroundExports(false, finished);
+        for (const FinishedExport& e : finished) {
+            showMessage((e.ok ? "Background export to " : "Background export failed: ") + e.path +
+                        (e.ok ? " finished." : ""));
+        }
     }
     
     // Clean up resources (should only reach here if there's an exit method 
@@ -357,7 +409,7 @@ void runGUI() {
     cleanupGUI();
     
     // Save student data before exiting
-    saveStudents();
+    if (!connectedToServer()) saveStudents();
 }
 
 // Handle Student Listing (Both by ID and Name)
@@ -366,7 +418,7 @@ void handleStudentListing(bool sortedById) {
     werase(contentwin);
     
     // If no students, show message
-    if (numStudents == 0) {
+    if (students.empty()) {
         showMessage("No students to display!");
         return;
     }
@@ -382,18 +434,8 @@ void handleStudentListing(bool sortedById) {
 
 // Display Student List
 void displayStudentList(bool sortedById) {
-    // Create a temporary array for sorting
-    Student tempStudents[MAX_STUDENTS];
-    copy(students, students + numStudents, tempStudents);
-    
-    // Sort the students
-    if (sortedById) {
-        sort(tempStudents, tempStudents + numStudents, 
-            [](const Student& a, const Student& b) { return a.id < b.id; });
-    } else {
-        sort(tempStudents, tempStudents + numStudents, 
-            [](const Student& a, const Student& b) { return a.name < b.name; });
-    }
+    // The store keeps both orders current, so nothing is sorted here
+    StudentOrderView order = students.ordered(sortedById ? ORDER_BY_ID : ORDER_BY_NAME);
     
     // Clear content window
     werase(contentwin);
@@ -415,20 +457,21 @@ void displayStudentList(bool sortedById) {
     mvwhline(contentwin, 4, 1, ACS_HLINE, contentWidth - 2);
     
     // Display student data
-    for (int i = 0; i < numStudents && i < contentHeight - 8; i++) {
-        mvwprintw(contentwin, i + 5, 2, "%d", tempStudents[i].id);
-        mvwprintw(contentwin, i + 5, 12, "%s", tempStudents[i].name.c_str());
-        mvwprintw(contentwin, i + 5, 42, "%s", tempStudents[i].nationalId.c_str());
+    for (int i = 0; i < students.size() && i < contentHeight - 8; i++) {
+        const Student& s = students[order[i]];
+        mvwprintw(contentwin, i + 5, 2, "%d", s.id);
+        mvwprintw(contentwin, i + 5, 12, "%s", s.name.c_str());
+        mvwprintw(contentwin, i + 5, 42, "%s", s.nationalId.c_str());
         
         // Format GPA with 2 decimal places
         std::stringstream gpaStream;
-        gpaStream << std::fixed << std::setprecision(2) << tempStudents[i].gpa;
+        gpaStream << std::fixed << std::setprecision(2) << s.gpa;
         mvwprintw(contentwin, i + 5, 62, "%s / 4.00", gpaStream.str().c_str());
     }
     
     // Status line
     std::stringstream statusStream;
-    statusStream << "Total students: " << numStudents;
+    statusStream << "Total students: " << students.size();
     mvwprintw(contentwin, contentHeight - 2, 2, "%s", statusStream.str().c_str());
     
     wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
@@ -437,11 +480,6 @@ void displayStudentList(bool sortedById) {
 
 // Add Student Form
 void addStudentForm() {
-    if (numStudents >= MAX_STUDENTS) {
-        showMessage("Maximum students reached!");
-        return;
-    }
-    
     // Clear the content window
     werase(contentwin);
     wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
@@ -503,7 +541,11 @@ void addStudentForm() {
         }
         
         // Add the student
-        students[numStudents++] = newStudent;
+        std::string error;
+        if (!addStudentRecord(newStudent, error)) {
+            showMessage(error + "!");
+            return;
+        }
         showMessage("Student added successfully!");
     } catch (const std::exception& e) {
         showMessage("Error: Invalid input format!");
@@ -559,12 +601,10 @@ void deleteStudentForm() {
     char confirm = wgetch(contentwin);
     
     if (confirm == 'y' || confirm == 'Y') {
-        // Delete student by shifting remaining elements
-        for (int i = index; i < numStudents - 1; i++) {
-            students[i] = students[i + 1];
-        }
-        numStudents--;
-        showMessage("Student deleted successfully!");
+        // Delete student
+        std::string error;
+        if (removeStudentRecord(index, error)) showMessage("Student deleted successfully!");
+        else showMessage(error + "!");
     } else {
         showMessage("Deletion cancelled.");
     }
@@ -636,43 +676,415 @@ void searchStudentForm() {
         noecho();
         
         std::string searchName(nameBuffer);
-        bool found = false;
-        int row = 11;
         
-        for (int i = 0; i < numStudents; i++) {
-            // Case-insensitive search
-            std::string studentNameLower = students[i].name;
-            std::string searchNameLower = searchName;
-            transform(studentNameLower.begin(), studentNameLower.end(), studentNameLower.begin(), ::tolower);
-            transform(searchNameLower.begin(), searchNameLower.end(), searchNameLower.begin(), ::tolower);
+        // Show one window-sized page of ranked matches at a time
+        int firstRow = 13;
+        int pageSize = std::max(1, contentHeight - 5 - firstRow);
+        int offset = 0;
+        std::vector<int> page;
+        while (true) {
+            int total = students.searchNames(searchName, offset, pageSize, page);
+            if (total == 0) {
+                mvwprintw(contentwin, 11, 10, "No matching students found!");
+                break;
+            }
             
-            if (studentNameLower.find(searchNameLower) != std::string::npos) {
-                if (!found) {
-                    wattron(contentwin, A_BOLD);
-                    mvwprintw(contentwin, row, 10, "Matching students:");
-                    wattroff(contentwin, A_BOLD);
-                    row += 2;
-                }
-                
+            for (int row = 11; row < contentHeight - 1; row++) {
+                wmove(contentwin, row, 1);
+                for (int col = 1; col < contentWidth - 1; col++) waddch(contentwin, ' ');
+            }
+            wattron(contentwin, A_BOLD);
+            mvwprintw(contentwin, 11, 10, "Matching students %d-%d of %d:",
+                      offset + 1, offset + (int)page.size(), total);
+            wattroff(contentwin, A_BOLD);
+            
+            int row = firstRow;
+            for (int index : page) {
                 // Format GPA
                 std::stringstream gpaStream;
-                gpaStream << std::fixed << std::setprecision(2) << students[i].gpa;
-                
-                mvwprintw(contentwin, row, 10, "ID: %d, Name: %s, GPA: %s / 4.00", 
-                          students[i].id, students[i].name.c_str(), gpaStream.str().c_str());
-                row += 1;
-                found = true;
+                gpaStream << std::fixed << std::setprecision(2) << students[index].gpa;
                 
-                // Avoid listing too many students
-                if (row > contentHeight - 5) break;
+                mvwprintw(contentwin, row++, 10, "ID: %d, Name: %s, GPA: %s / 4.00", 
+                          students[index].id, students[index].name.c_str(), gpaStream.str().c_str());
+            }
+            if (total <= pageSize) break;
+            
+            mvwprintw(contentwin, contentHeight - 2, (contentWidth - 46) / 2,
+                      "n: next page, p: previous page, other: return");
+            wrefresh(contentwin);
+            int key = wgetch(contentwin);
+            if (key == 'n' && offset + pageSize < total) {
+                offset += pageSize;
+            } else if (key == 'p' && offset > 0) {
+                offset -= pageSize;
+            } else if (key != 'n' && key != 'p') {
+                wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+                return;
             }
         }
+    } else {
+        mvwprintw(contentwin, 9, 10, "Invalid choice!");
+    }
+    
+    // Wait for user
+    mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, "Press any key to continue");
+    wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    wrefresh(contentwin);
+    wgetch(contentwin);
+}
+
+// Query Students Form
+void queryStudentsForm() {
+    // Clear the content window
+    werase(contentwin);
+    wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    box(contentwin, 0, 0);
+    
+    // Form title
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 1, (contentWidth - 14) / 2, "QUERY STUDENTS");
+    wattroff(contentwin, A_BOLD);
+    
+    mvwprintw(contentwin, 3, 4, "Example: gpa < 2.0 and course = Mathematics   (syntax: student_query.h)");
+    mvwprintw(contentwin, 4, 4, "Query:");
+    
+    // Get the query text
+    echo();
+    curs_set(1);
+    char queryBuffer[200] = {0};
+    wmove(contentwin, 4, 11);
+    wgetnstr(contentwin, queryBuffer, sizeof(queryBuffer) - 1);
+    noecho();
+    curs_set(0);
+    
+    StudentQuery query;
+    std::string error;
+    if (!query.parse(queryBuffer, error)) {
+        mvwprintw(contentwin, 6, 4, "Invalid query: %s", error.c_str());
+    } else {
+        QueryPlan plan = query.plan(students);
+        mvwprintw(contentwin, 5, 4, "Plan: %s", plan.describe().c_str());
+        mvwprintw(contentwin, 7, 4, "ID");
+        mvwprintw(contentwin, 7, 14, "Name");
+        mvwprintw(contentwin, 7, 44, "Courses");
+        mvwprintw(contentwin, 7, 54, "GPA");
+        mvwhline(contentwin, 8, 1, ACS_HLINE, contentWidth - 2);
         
-        if (!found) {
-            mvwprintw(contentwin, 11, 10, "No matching students found!");
+        // Rows are drawn as results arrive; a full page waits for a key
+        const int firstRow = 9;
+        int lastRow = contentHeight - 4;
+        int row = firstRow;
+        int shown = 0;
+        auto clearRows = [lastRow]() {
+            for (int r = firstRow; r <= lastRow + 1; r++) {
+                wmove(contentwin, r, 1);
+                for (int col = 1; col < contentWidth - 1; col++) waddch(contentwin, ' ');
+            }
+        };
+        query.run(students, plan, [&](int index) {
+            if (row > lastRow) {
+                mvwprintw(contentwin, lastRow + 1, 4, "%d shown. n: more results, other: stop", shown);
+                wrefresh(contentwin);
+                if (wgetch(contentwin) != 'n') return false;
+                clearRows();
+                row = firstRow;
+            }
+            const Student& s = students[index];
+            std::stringstream gpaStream;
+            gpaStream << std::fixed << std::setprecision(2) << s.gpa;
+            mvwprintw(contentwin, row, 4, "%d", s.id);
+            mvwprintw(contentwin, row, 14, "%.29s", s.name.c_str());
+            mvwprintw(contentwin, row, 44, "%d", s.numCourses);
+            mvwprintw(contentwin, row, 54, "%s", gpaStream.str().c_str());
+            row++;
+            shown++;
+            return true;
+        });
+        wmove(contentwin, lastRow + 1, 1);
+        for (int col = 1; col < contentWidth - 1; col++) waddch(contentwin, ' ');
+        mvwprintw(contentwin, lastRow + 1, 4, "%d matching student%s shown.", shown, shown == 1 ? "" : "s");
+    }
+    
+    // Wait for user
+    mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, "Press any key to continue");
+    wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    wrefresh(contentwin);
+    wgetch(contentwin);
+}
+
+// Cohort Statistics Dashboard
+void cohortDashboard() {
+    if (students.empty()) {
+        showMessage("No students to analyze!");
+        return;
+    }
+    // As many top students as there are histogram rows next to them
+    CohortReport report = analyzeCohort(students, GPA_HISTOGRAM_BINS);
+
+    // Clear the content window
+    werase(contentwin);
+    wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    box(contentwin, 0, 0);
+    
+    // Screen title
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 1, (contentWidth - 17) / 2, "COHORT STATISTICS");
+    wattroff(contentwin, A_BOLD);
+    
+    mvwprintw(contentwin, 3, 4, "Students: %d (%zu with courses)   GPA mean %.2f, min %.2f, max %.2f",
+              report.students, report.gpa.count, report.gpa.mean(), report.gpa.min, report.gpa.max);
+    std::stringstream percentiles;
+    percentiles << std::fixed << std::setprecision(2) << "Percentiles:";
+    for (int p = 0; p < NUM_GPA_PERCENTILES; p++) {
+        percentiles << "  " << (int)(GPA_PERCENTILES[p] * 100 + 0.5) << "%: " << report.gpaPercentiles[p];
+    }
+    mvwprintw(contentwin, 4, 4, "%s", percentiles.str().c_str());
+    
+    // GPA histogram on the left, top students on the right
+    const int right = contentWidth / 2;
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 6, 4, "GPA distribution");
+    mvwprintw(contentwin, 6, right, "Top students");
+    wattroff(contentwin, A_BOLD);
+    int largest = *std::max_element(report.gpaHistogram, report.gpaHistogram + GPA_HISTOGRAM_BINS);
+    int barWidth = std::max(right - 28, 1);
+    for (int b = 0; b < GPA_HISTOGRAM_BINS; b++) {
+        int bar = (int)((long long)report.gpaHistogram[b] * barWidth / std::max(largest, 1));
+        mvwprintw(contentwin, 7 + b, 4, "%.1f-%.1f", b * 0.5, b == GPA_HISTOGRAM_BINS - 1 ? 4.0 : (b + 1) * 0.5);
+        mvwhline(contentwin, 7 + b, 13, '#', bar);
+        mvwprintw(contentwin, 7 + b, 14 + bar, "%d", report.gpaHistogram[b]);
+    }
+    int nameWidth = std::max(right - 20, 8);
+    for (int i = 0; i < (int)report.topStudents.size(); i++) {
+        const Student& s = students[report.topStudents[i]];
+        mvwprintw(contentwin, 7 + i, right, "%-8d %-*.*s %.2f", s.id, nameWidth, nameWidth, s.name.c_str(), s.gpa);
+    }
+    
+    // Course table, as many rows as fit
+    const CourseCatalog& catalog = students.courseCatalog();
+    const int headerRow = 8 + GPA_HISTOGRAM_BINS;
+    mvwprintw(contentwin, headerRow, 4, "Course");
+    mvwprintw(contentwin, headerRow, 44, "Grades");
+    mvwprintw(contentwin, headerRow, 54, "Mean");
+    mvwprintw(contentwin, headerRow, 62, "Median");
+    mvwprintw(contentwin, headerRow, 72, "Fail %%");
+    mvwhline(contentwin, headerRow + 1, 1, ACS_HLINE, contentWidth - 2);
+    int lastRow = contentHeight - 4;
+    int shown = 0;
+    for (int row = headerRow + 2; row <= lastRow && shown < (int)report.courses.size(); row++, shown++) {
+        const CourseStatistics& c = report.courses[shown];
+        std::string name(catalog.name(c.course).substr(0, 39));
+        mvwprintw(contentwin, row, 4, "%s", name.c_str());
+        mvwprintw(contentwin, row, 44, "%d", c.grades);
+        mvwprintw(contentwin, row, 54, "%.1f", c.mean);
+        mvwprintw(contentwin, row, 62, "%.1f", c.median);
+        mvwprintw(contentwin, row, 72, "%.1f", c.failRate * 100);
+    }
+    if (shown < (int)report.courses.size()) {
+        mvwprintw(contentwin, lastRow + 1, 4, "%d more courses. Computed in %.1f ms.",
+                  (int)report.courses.size() - shown, report.seconds * 1000);
+    } else {
+        mvwprintw(contentwin, lastRow + 1, 4, "Computed in %.1f ms.", report.seconds * 1000);
+    }
+    
+    // Wait for user
+    mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, "Press any key to continue");
+    wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    wrefresh(contentwin);
+    wgetch(contentwin);
+}
+
+// Rank Students Form
+void rankStudentsForm() {
+    // Clear the content window
+    werase(contentwin);
+    wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    box(contentwin, 0, 0);
+    
+    // Form title
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 1, (contentWidth - 13) / 2, "RANK STUDENTS");
+    wattroff(contentwin, A_BOLD);
+    
+    mvwprintw(contentwin, 3, 4, "1. Top students (dean's list)   2. Bottom students (probation list)");
+    mvwprintw(contentwin, 4, 4, "Choice:");
+    mvwprintw(contentwin, 5, 4, "Number of students:");
+    mvwprintw(contentwin, 6, 4, "Course (empty for all students):");
+    
+    // Get the choice, count and course
+    echo();
+    curs_set(1);
+    int choice = 0, count = 0;
+    char courseBuffer[50] = {0};
+    wmove(contentwin, 4, 12);
+    wscanw(contentwin, "%d", &choice);
+    wmove(contentwin, 5, 24);
+    wscanw(contentwin, "%d", &count);
+    wmove(contentwin, 6, 37);
+    wgetnstr(contentwin, courseBuffer, sizeof(courseBuffer) - 1);
+    noecho();
+    curs_set(0);
+    
+    int course = GpaRanking::OVERALL;
+    if (courseBuffer[0] != '\0') course = students.courseCatalog().find(courseBuffer);
+    if (choice != 1 && choice != 2) {
+        mvwprintw(contentwin, 8, 4, "Invalid choice!");
+    } else if (course == -1) {
+        mvwprintw(contentwin, 8, 4, "Course not found!");
+    } else {
+        // As many rows as fit on the screen
+        const int firstRow = 10;
+        int lastRow = contentHeight - 4;
+        count = std::min(count, lastRow - firstRow + 1);
+        std::vector<int> ranked;
+        int total = choice == 1 ? students.topStudents(course, count, ranked)
+                                : students.bottomStudents(course, count, ranked);
+        mvwprintw(contentwin, 8, 4, "Rank");
+        mvwprintw(contentwin, 8, 12, "ID");
+        mvwprintw(contentwin, 8, 22, "Name");
+        mvwprintw(contentwin, 8, 54, "GPA");
+        mvwhline(contentwin, 9, 1, ACS_HLINE, contentWidth - 2);
+        for (int i = 0; i < (int)ranked.size(); i++) {
+            const Student& s = students[ranked[i]];
+            mvwprintw(contentwin, firstRow + i, 4, "%d", choice == 1 ? i + 1 : total - i);
+            mvwprintw(contentwin, firstRow + i, 12, "%d", s.id);
+            mvwprintw(contentwin, firstRow + i, 22, "%.30s", s.name.c_str());
+            mvwprintw(contentwin, firstRow + i, 54, "%.2f", s.gpa);
         }
+        mvwprintw(contentwin, lastRow + 1, 4, "%d of %d ranked students shown.", (int)ranked.size(), total);
+    }
+    
+    // Wait for user
+    mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, "Press any key to continue");
+    wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    wrefresh(contentwin);
+    wgetch(contentwin);
+}
+
+// Import Grade Sheets Form
+void importGradesForm() {
+    // Clear the content window
+    werase(contentwin);
+    wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    box(contentwin, 0, 0);
+    
+    // Form title
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 1, (contentWidth - 19) / 2, "IMPORT GRADE SHEETS");
+    wattroff(contentwin, A_BOLD);
+    
+    mvwprintw(contentwin, 3, 4, "CSV files of student_id,grade rows, named after their course (e.g. Mathematics.csv)");
+    mvwprintw(contentwin, 4, 4, "Files (separated by commas):");
+    
+    // Get the file names
+    echo();
+    curs_set(1);
+    char pathBuffer[400] = {0};
+    wmove(contentwin, 4, 33);
+    wgetnstr(contentwin, pathBuffer, sizeof(pathBuffer) - 1);
+    noecho();
+    curs_set(0);
+    
+    std::vector<GradeSheet> sheets;
+    std::stringstream paths(pathBuffer);
+    std::string path;
+    while (std::getline(paths, path, ',')) {
+        path.erase(0, path.find_first_not_of(" \t"));
+        path.erase(path.find_last_not_of(" \t") + 1);
+        if (!path.empty()) sheets.push_back(GradeSheet{ path, "" });
+    }
+    GradeImportReport report;
+    std::string error;
+    if (sheets.empty()) {
+        mvwprintw(contentwin, 6, 4, "No grade sheets given!");
+    } else if (!importStudentGrades(sheets, report, error)) {
+        mvwprintw(contentwin, 6, 4, "%.70s!", error.c_str());
     } else {
-        mvwprintw(contentwin, 9, 10, "Invalid choice!");
+        
+        // One line per sheet, then its rejected rows while they fit
+        int row = 6;
+        int lastRow = contentHeight - 4;
+        for (size_t i = 0; i < sheets.size() && row <= lastRow; i++) {
+            const GradeSheetResult& sheet = report.sheets[i];
+            if (!sheet.opened) {
+                mvwprintw(contentwin, row++, 4, "%.60s: cannot open file", sheets[i].path.c_str());
+                continue;
+            }
+            mvwprintw(contentwin, row++, 4, "%.40s (%.30s): %d of %d rows imported", sheets[i].path.c_str(),
+                      sheet.course.c_str(), sheet.imported, sheet.rows);
+            int shown = 0;
+            for (; shown < (int)sheet.rejected.size() && shown < 5 && row <= lastRow; shown++) {
+                mvwprintw(contentwin, row++, 6, "line %d: %.60s", sheet.rejected[shown].line,
+                          sheet.rejected[shown].message.c_str());
+            }
+            if (shown < sheet.rejectedRows && row <= lastRow) {
+                mvwprintw(contentwin, row++, 6, "%d more rejected rows", sheet.rejectedRows - shown);
+            }
+        }
+        mvwprintw(contentwin, lastRow + 1, 4, "%d student%s updated in %.2f s.", report.studentsUpdated,
+                  report.studentsUpdated == 1 ? "" : "s", report.seconds);
+    }
+    
+    // Wait for user
+    mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, "Press any key to continue");
+    wattroff(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    wrefresh(contentwin);
+    wgetch(contentwin);
+}
+
+// Export Students Form
+void exportStudentsForm() {
+    // Clear the content window
+    werase(contentwin);
+    wattron(contentwin, COLOR_PAIR(COLOR_CONTENT));
+    box(contentwin, 0, 0);
+    
+    // Form title
+    wattron(contentwin, A_BOLD);
+    mvwprintw(contentwin, 1, (contentWidth - 15) / 2, "EXPORT STUDENTS");
+    wattroff(contentwin, A_BOLD);
+    
+    mvwprintw(contentwin, 3, 4, "1. CSV   2. JSON Lines   3. Columnar (binary)");
+    mvwprintw(contentwin, 4, 4, "Format:");
+    mvwprintw(contentwin, 5, 4, "File (empty for students.<format>):");
+    mvwprintw(contentwin, 6, 4, "In the background (y/n):");
+    
+    // Get the format, file and mode
+    echo();
+    curs_set(1);
+    int choice = 0;
+    char pathBuffer[200] = {0};
+    char backgroundBuffer[4] = {0};
+    wmove(contentwin, 4, 12);
+    wscanw(contentwin, "%d", &choice);
+    wmove(contentwin, 5, 40);
+    wgetnstr(contentwin, pathBuffer, sizeof(pathBuffer) - 1);
+    wmove(contentwin, 6, 29);
+    wgetnstr(contentwin, backgroundBuffer, sizeof(backgroundBuffer) - 1);
+    noecho();
+    curs_set(0);
+    
+    if (choice < 1 || choice > NUM_EXPORT_FORMATS) {
+        mvwprintw(contentwin, 8, 4, "Invalid choice!");
+    } else {
+        ExportFormat format = (ExportFormat)(choice - 1);
+        std::string path = pathBuffer;
+        if (path.empty()) path = std::string("students") + makeExportWriter(format)->extension();
+        
+        // A background export works on a copy of the store as it is now
+        bool background = tolower(backgroundBuffer[0]) == 'y' &&
+                          startBackgroundExport(path.c_str(), students, format);
+        if (background) {
+            mvwprintw(contentwin, 8, 4, "Exporting to %.60s in the background.", path.c_str());
+        } else {
+            ExportReport report = exportStudents(path.c_str(), students, format);
+            if (report.ok) {
+                mvwprintw(contentwin, 8, 4, "%d students exported to %.40s (%llu bytes) in %.2f s.", report.students,
+                          path.c_str(), (unsigned long long)report.bytes, report.seconds);
+            } else {
+                mvwprintw(contentwin, 8, 4, "Error: %.80s", report.error.c_str());
+            }
+        }
     }
     
     // Wait for user
@@ -739,13 +1151,18 @@ void modifyStudentForm() {
     noecho();
     
     // Update student information if new values provided
-    if (strlen(nameBuffer) > 0) {
-        students[index].name = nameBuffer;
+    std::string error;
+    if (strlen(nameBuffer) > 0 && !setStudentName(index, nameBuffer, error)) {
+        showMessage(error + "!");
+        return;
     }
     
     if (strlen(nationalIdBuffer) > 0) {
         if (validateNationalId(nationalIdBuffer)) {
-            students[index].nationalId = nationalIdBuffer;
+            if (!setStudentNationalId(index, nationalIdBuffer, error)) {
+                showMessage(error + "!");
+                return;
+            }
         } else {
             showMessage("Invalid national ID format! Must be 14 digits.");
             return;
@@ -758,6 +1175,24 @@ void modifyStudentForm() {
     wrefresh(contentwin);
 }
 
+// Save the changes of a course or study plan session, all at once
+static void saveEditForm(const StudentEdit& edit, bool showGpa) {
+    if (edit.empty()) return;
+    std::string error;
+    if (!commitStudentEdit(edit, error)) {
+        showMessage(error + "! No changes were saved.");
+        return;
+    }
+    if (!showGpa) {
+        showMessage("Changes saved.");
+        return;
+    }
+    std::stringstream message;
+    message << "Changes saved. GPA: " << std::fixed << std::setprecision(2)
+            << students[students.find(edit.id())].gpa << " / 4.00";
+    showMessage(message.str());
+}
+
 // Manage Course Menu
 void manageCourseMenu() {
     // Clear the content window
@@ -787,7 +1222,8 @@ void manageCourseMenu() {
         return;
     }
     
-    // Course management loop
+    // Course management loop; nothing changes until the changes are saved
+    StudentEdit edit(students, index);
     bool exit = false;
     while (!exit) {
         // Clear the content window except the border and title
@@ -800,7 +1236,8 @@ void manageCourseMenu() {
         
         // Student name
         wattron(contentwin, A_BOLD);
-        std::string courseTitle = "Course Management for " + students[index].name;
+        std::string courseTitle = "Course Management for " + students[index].name +
+                                  (edit.empty() ? "" : " (unsaved changes)");
         mvwprintw(contentwin, 3, (contentWidth - courseTitle.length()) / 2, 
                  "%s", courseTitle.c_str());
         wattroff(contentwin, A_BOLD);
@@ -809,22 +1246,23 @@ void manageCourseMenu() {
         mvwprintw(contentwin, 5, 10, "1. Add Course");
         mvwprintw(contentwin, 6, 10, "2. Remove Course");
         mvwprintw(contentwin, 7, 10, "3. View Courses");
-        mvwprintw(contentwin, 8, 10, "4. Back to Main Menu");
+        mvwprintw(contentwin, 8, 10, "4. Save and Back");
+        mvwprintw(contentwin, 9, 10, "5. Discard and Back");
         
-        mvwprintw(contentwin, 10, 10, "Enter choice (1-4):");
+        mvwprintw(contentwin, 11, 10, "Enter choice (1-5):");
         wrefresh(contentwin);
         
         // Get course menu choice
         echo();
         int choice;
-        wmove(contentwin, 10, 30);
+        wmove(contentwin, 11, 30);
         wscanw(contentwin, "%d", &choice);
         noecho();
         
         switch (choice) {
             case 1: {
                 // Add Course
-                if (students[index].numCourses >= MAX_COURSES) {
+                if ((int)edit.courses().size() >= MAX_COURSES) {
                     showMessage("Maximum courses reached!");
                     break;
                 }
@@ -857,18 +1295,17 @@ void manageCourseMenu() {
                 }
                 
                 // Add course
-                students[index].courses[students[index].numCourses].name = courseBuffer;
-                students[index].courses[students[index].numCourses].grade = grade;
-                students[index].numCourses++;
-                
-                // Recalculate GPA
-                computeGPA(index);
-                showMessage("Course added successfully!");
+                std::string error;
+                if (edit.addCourse(Course(courseBuffer, grade), error)) {
+                    showMessage("Course added successfully!");
+                } else {
+                    showMessage(error + "!");
+                }
                 break;
             }
             case 2: {
                 // Remove Course
-                if (students[index].numCourses == 0) {
+                if (edit.courses().empty()) {
                     showMessage("No courses to remove!");
                     break;
                 }
@@ -886,43 +1323,42 @@ void manageCourseMenu() {
                 mvwprintw(contentwin, 12, 10, "Current Courses:");
                 wattroff(contentwin, A_BOLD);
                 
-                for (int i = 0; i < students[index].numCourses; i++) {
+                int numCourses = (int)edit.courses().size();
+                for (int i = 0; i < numCourses; i++) {
                     mvwprintw(contentwin, 14 + i, 10, "%d. %s (%.2f)", 
                              i + 1, 
-                             students[index].courses[i].name.c_str(),
-                             students[index].courses[i].grade);
+                             courseNames.c_str(edit.courses()[i].nameId),
+                             edit.courses()[i].grade);
                 }
                 
                 // Get course to remove
-                mvwprintw(contentwin, 14 + students[index].numCourses + 1, 10, 
+                mvwprintw(contentwin, 14 + numCourses + 1, 10, 
                          "Enter course number to remove:");
                 
                 echo();
                 int courseIndex;
-                wmove(contentwin, 14 + students[index].numCourses + 1, 40);
+                wmove(contentwin, 14 + numCourses + 1, 40);
                 wscanw(contentwin, "%d", &courseIndex);
                 noecho();
                 
                 // Validate and remove
-                if (courseIndex < 1 || courseIndex > students[index].numCourses) {
+                if (courseIndex < 1 || courseIndex > numCourses) {
                     showMessage("Invalid selection!");
                     break;
                 }
                 
-                // Shift courses to remove
-                for (int i = courseIndex - 1; i < students[index].numCourses - 1; i++) {
-                    students[index].courses[i] = students[index].courses[i + 1];
+                // Remove course
+                std::string error;
+                if (edit.removeCourse(courseIndex - 1, error)) {
+                    showMessage("Course removed successfully!");
+                } else {
+                    showMessage(error + "!");
                 }
-                students[index].numCourses--;
-                
-                // Recalculate GPA
-                computeGPA(index);
-                showMessage("Course removed successfully!");
                 break;
             }
             case 3: {
                 // View Courses
-                if (students[index].numCourses == 0) {
+                if (edit.courses().empty()) {
                     showMessage("No courses registered for this student!");
                     break;
                 }
@@ -942,26 +1378,33 @@ void manageCourseMenu() {
                 mvwprintw(contentwin, 14, 20, "Course Name");
                 mvwprintw(contentwin, 14, 40, "Grade");
                 mvwprintw(contentwin, 14, 60, "GPA Scale");
+                mvwprintw(contentwin, 14, 72, "Class Avg");
                 wattroff(contentwin, A_BOLD);
                 
                 // Horizontal line
-                mvwhline(contentwin, 15, 10, ACS_HLINE, 70);
+                mvwhline(contentwin, 15, 10, ACS_HLINE, 72);
                 
-                // Course listing
-                for (int i = 0; i < students[index].numCourses; i++) {
+                // Course listing; class averages are the saved ones
+                const CourseCatalog& catalog = students.courseCatalog();
+                const Course* courses = edit.courses().data();
+                int numCourses = (int)edit.courses().size();
+                for (int i = 0; i < numCourses; i++) {
                     mvwprintw(contentwin, 16 + i, 10, "%d", i + 1);
-                    mvwprintw(contentwin, 16 + i, 20, "%s", students[index].courses[i].name.c_str());
-                    mvwprintw(contentwin, 16 + i, 40, "%.2f", students[index].courses[i].grade);
-                    mvwprintw(contentwin, 16 + i, 60, "%.2f", convertGradeTo4Scale(students[index].courses[i].grade));
+                    mvwprintw(contentwin, 16 + i, 20, "%s", courseNames.c_str(courses[i].nameId));
+                    mvwprintw(contentwin, 16 + i, 40, "%.2f", courses[i].grade);
+                    mvwprintw(contentwin, 16 + i, 60, "%.2f", convertGradeTo4Scale(courses[i].grade));
+                    int course = catalog.find(courses[i].nameId);   // -1 for a course nobody takes yet
+                    if (course == -1) mvwprintw(contentwin, 16 + i, 72, "-");
+                    else mvwprintw(contentwin, 16 + i, 72, "%.2f", catalog.averageGrade(course));
                 }
                 
                 // Horizontal line
-                mvwhline(contentwin, 16 + students[index].numCourses, 10, ACS_HLINE, 70);
+                mvwhline(contentwin, 16 + numCourses, 10, ACS_HLINE, 72);
                 
                 // Total GPA
                 std::stringstream gpaStream;
-                gpaStream << std::fixed << std::setprecision(2) << students[index].gpa;
-                mvwprintw(contentwin, 17 + students[index].numCourses, 10, 
+                gpaStream << std::fixed << std::setprecision(2) << edit.gpa();
+                mvwprintw(contentwin, 17 + numCourses, 10, 
                          "Cumulative GPA: %s / 4.00", gpaStream.str().c_str());
                 
                 // Wait for user
@@ -972,6 +1415,12 @@ void manageCourseMenu() {
                 break;
             }
             case 4:
+                saveEditForm(edit, true);
+                exit = true;
+                break;
+            case 5:
+                edit.abort();
+                showMessage("Changes discarded.");
                 exit = true;
                 break;
             default:
@@ -1017,13 +1466,10 @@ void computeGPAForm() {
     // Calculate GPA and display
     if (students[index].numCourses == 0) {
         // No courses
-        students[index].gpa = 0.0;
+        students.setGpa(index, 0.0f);
         showMessage("No courses available. GPA set to 0.0");
     } else {
-        // Compute GPA
-        computeGPA(index);
-        
-        // Show result
+        // The store keeps the GPA current; show it (computeGPA would print to the console)
         std::stringstream message;
         message << "GPA updated: " << std::fixed << std::setprecision(2) 
                 << students[index].gpa << " / 4.00";
@@ -1063,7 +1509,8 @@ void updateStudyPlanForm() {
         return;
     }
     
-    // Study plan management loop
+    // Study plan management loop; nothing changes until the changes are saved
+    StudentEdit edit(students, index);
     bool exit = false;
     while (!exit) {
         // Clear the content window except the border and title
@@ -1076,7 +1523,8 @@ void updateStudyPlanForm() {
         
         // Student name
         wattron(contentwin, A_BOLD);
-        std::string planTitle = "Study Plan Management for " + students[index].name;
+        std::string planTitle = "Study Plan Management for " + students[index].name +
+                                (edit.empty() ? "" : " (unsaved changes)");
         mvwprintw(contentwin, 4, (contentWidth - planTitle.length()) / 2, 
                  "%s", planTitle.c_str());
         wattroff(contentwin, A_BOLD);
@@ -1085,22 +1533,23 @@ void updateStudyPlanForm() {
         mvwprintw(contentwin, 6, 10, "1. Add Course to Plan");
         mvwprintw(contentwin, 7, 10, "2. Remove Course from Plan");
         mvwprintw(contentwin, 8, 10, "3. View Plan");
-        mvwprintw(contentwin, 9, 10, "4. Back to Main Menu");
+        mvwprintw(contentwin, 9, 10, "4. Save and Back");
+        mvwprintw(contentwin, 10, 10, "5. Discard and Back");
         
-        mvwprintw(contentwin, 11, 10, "Enter choice (1-4):");
+        mvwprintw(contentwin, 12, 10, "Enter choice (1-5):");
         wrefresh(contentwin);
         
         // Get study plan menu choice
         echo();
         int choice;
-        wmove(contentwin, 11, 30);
+        wmove(contentwin, 12, 30);
         wscanw(contentwin, "%d", &choice);
         noecho();
         
         switch (choice) {
             case 1: {
                 // Add Course to Plan
-                if (students[index].numStudyPlan >= MAX_STUDY_PLAN) {
+                if ((int)edit.plan().size() >= MAX_STUDY_PLAN) {
                     showMessage("Study plan is full!");
                     break;
                 }
@@ -1122,13 +1571,14 @@ void updateStudyPlanForm() {
                 noecho();
                 
                 // Add course to plan
-                students[index].studyPlan[students[index].numStudyPlan++] = courseBuffer;
-                showMessage("Course added to study plan!");
+                std::string error;
+                if (edit.addPlanEntry(courseBuffer, error)) showMessage("Course added to study plan!");
+                else showMessage(error + "!");
                 break;
             }
             case 2: {
                 // Remove Course from Plan
-                if (students[index].numStudyPlan == 0) {
+                if (edit.plan().empty()) {
                     showMessage("Study plan is empty!");
                     break;
                 }
@@ -1146,40 +1596,38 @@ void updateStudyPlanForm() {
                 mvwprintw(contentwin, 13, 10, "Current Study Plan:");
                 wattroff(contentwin, A_BOLD);
                 
-                for (int i = 0; i < students[index].numStudyPlan; i++) {
+                int numPlan = (int)edit.plan().size();
+                for (int i = 0; i < numPlan; i++) {
                     mvwprintw(contentwin, 15 + i, 10, "%d. %s", 
                              i + 1, 
-                             students[index].studyPlan[i].c_str());
+                             courseNames.c_str(edit.plan()[i]));
                 }
                 
                 // Get course to remove
-                mvwprintw(contentwin, 15 + students[index].numStudyPlan + 1, 10, 
+                mvwprintw(contentwin, 15 + numPlan + 1, 10, 
                          "Enter item number to remove:");
                 
                 echo();
                 int planIndex;
-                wmove(contentwin, 15 + students[index].numStudyPlan + 1, 40);
+                wmove(contentwin, 15 + numPlan + 1, 40);
                 wscanw(contentwin, "%d", &planIndex);
                 noecho();
                 
                 // Validate and remove
-                if (planIndex < 1 || planIndex > students[index].numStudyPlan) {
+                if (planIndex < 1 || planIndex > numPlan) {
                     showMessage("Invalid selection!");
                     break;
                 }
                 
-                // Shift courses to remove
-                for (int i = planIndex - 1; i < students[index].numStudyPlan - 1; i++) {
-                    students[index].studyPlan[i] = students[index].studyPlan[i + 1];
-                }
-                students[index].numStudyPlan--;
-                
-                showMessage("Course removed from study plan!");
+                // Remove course from plan
+                std::string error;
+                if (edit.removePlanEntry(planIndex - 1, error)) showMessage("Course removed from study plan!");
+                else showMessage(error + "!");
                 break;
             }
             case 3: {
                 // View Study Plan
-                if (students[index].numStudyPlan == 0) {
+                if (edit.plan().empty()) {
                     showMessage("Study plan is empty for this student!");
                     break;
                 }
@@ -1201,17 +1649,19 @@ void updateStudyPlanForm() {
                 mvwhline(contentwin, 14, 10, ACS_HLINE, 50);
                 
                 // Course listing
-                for (int i = 0; i < students[index].numStudyPlan; i++) {
-                    mvwprintw(contentwin, 15 + i, 10, "%d. %s", 
-                             i + 1, students[index].studyPlan[i].c_str());
+                for (int i = 0; i < (int)edit.plan().size(); i++) {
+                    mvwprintw(contentwin, 15 + i, 10, "%d. %s (%s)", 
+                             i + 1, courseNames.c_str(edit.plan()[i]),
+                             studyPlanStatus(edit.courses().data(), (int)edit.courses().size(),
+                                             edit.plan()[i]).c_str());
                 }
                 
                 // Horizontal line
-                mvwhline(contentwin, 15 + students[index].numStudyPlan, 10, ACS_HLINE, 50);
+                mvwhline(contentwin, 15 + (int)edit.plan().size(), 10, ACS_HLINE, 50);
                 
                 // Total courses
-                mvwprintw(contentwin, 16 + students[index].numStudyPlan, 10, 
-                         "Total courses in plan: %d", students[index].numStudyPlan);
+                mvwprintw(contentwin, 16 + (int)edit.plan().size(), 10, 
+                         "Total courses in plan: %d", (int)edit.plan().size());
                 
                 // Wait for user
                 mvwprintw(contentwin, contentHeight - 2, (contentWidth - 25) / 2, 
@@ -1221,6 +1671,12 @@ void updateStudyPlanForm() {
                 break;
             }
             case 4:
+                saveEditForm(edit, false);
+                exit = true;
+                break;
+            case 5:
+                edit.abort();
+                showMessage("Changes discarded.");
                 exit = true;
                 break;
             default:
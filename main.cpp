@@ -3,19 +3,64 @@
  */
 
 #include "student.h"    // Include the student header file that contains declarations
+#include "student_client.h" // Include the changes made locally or through a server
+#include "student_protocol.h" // Include the default server socket
+#include "student_batch.h" // Include the command scripts of --batch
 #include <iostream>     // Include for input/output stream operations
 #include <fstream>      // Include for file operations
 #include <algorithm>    // Include for sorting algorithms
+#include <cstring>      // Include for strcmp
 
-// Global array to store student data
-Student students[MAX_STUDENTS];  // Array to hold the student records
-int numStudents = 0;             // Counter for the current number of students
+// Global store for student data
+StudentStore students;           // Store holding the student records
 
 /**
  * Main function - entry point of the program
+ *   student_system [--connect [socket]] [--batch [file]]
  */
-int main() {
-    loadStudents();     // Load existing student data from file
+int main(int argc, char* argv[]) {
+    const char* socketPath = nullptr;   // Server to connect to, if any
+    const char* batchPath = nullptr;    // Script to run instead of the menu, "-" for standard input
+    for (int a = 1; a < argc; a++) {
+        bool hasValue = a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0;
+        if (strcmp(argv[a], "--connect") == 0 && !socketPath) {
+            socketPath = hasValue ? argv[++a] : SERVER_SOCKET_FILENAME;
+        } else if (strcmp(argv[a], "--batch") == 0 && !batchPath) {
+            batchPath = hasValue ? argv[++a] : "-";
+        } else {
+            cout << "Usage: " << argv[0] << " [--connect [socket]] [--batch [file]]\n";
+            return 2;
+        }
+    }
+    ifstream script;
+    if (batchPath) {
+        ios::sync_with_stdio(false);   // Nothing reads or writes through stdio in batch mode
+        if (strcmp(batchPath, "-") != 0) {
+            script.open(batchPath);
+            if (!script) {
+                cout << "Error: Could not open " << batchPath << ".\n";
+                return 1;
+            }
+        }
+    }
+
+    // With --connect the students are those of a running student_server
+    if (socketPath) {
+        string error;
+        if (!connectToServer(socketPath, error)) {
+            cout << "Error: " << error << ".\n";
+            return 1;
+        }
+    } else {
+        loadStudents();     // Load existing student data from file
+    }
+
+    // With --batch the script runs without the menu, then the program exits
+    if (batchPath) {
+        int failed = runBatch(script.is_open() ? script : cin, cout);
+        if (!connectedToServer()) saveStudents(); // Save student data (a server saves its own)
+        return failed == 0 ? 0 : 1;
+    }
     int choice;         // Variable to store user menu choice
     
     // Main program loop
@@ -23,6 +68,7 @@ int main() {
         displayMenu();          // Display the main menu options
         cin >> choice;          // Get user's choice
         cin.ignore();           // Clear input buffer
+        applyServerChanges();   // Take in what other clients of the server changed meanwhile
         
         // Process the user's choice
         switch(choice) {
@@ -62,14 +108,24 @@ int main() {
                 else cout << "Student not found!\n";    // Display error if student not found
                 break;
             }
-            case 10: 
-                saveStudents();                        // Save student data to file
+            case 10: queryStudents(); break;   // Find students matching filter conditions
+            case 11: showCohortStatistics(); break; // Show cohort statistics
+            case 12: rankStudents(); break;    // List the best or worst students
+            case 13: importGrades(); break;    // Import grade sheets
+            case 14: exportStudentData(); break; // Export all students for reporting
+            case 0: 
+                reportBackgroundExports(true);         // Let running exports finish
+                if(!connectedToServer()) saveStudents(); // Save student data (a server saves its own)
                 cout << "Data saved. Exiting program.\n"; // Inform user data is saved
                 break;
             default:
                 cout << "Invalid choice. Please try again.\n"; // Handle invalid menu choices
         }
-    } while(choice != 10); // Continue until user chooses to exit
+        // Fold a large journal into the snapshot in the background, but not
+        // after the final save: nothing would wait for that checkpoint
+        if(choice != 0) checkpointIfNeeded();
+        reportBackgroundExports(false); // Report exports that finished meanwhile
+    } while(choice != 0); // Continue until user chooses to exit
 
     return 0; // End program with success status
 }
@@ -88,6 +144,11 @@ void displayMenu() {
     cout << "7. Manage Courses\n";                        // Option to manage courses
     cout << "8. Compute GPA\n";                           // Option to compute GPA
     cout << "9. Update Study Plan\n";                     // Option to update study plan
-    cout << "10. Exit\n";                                 // Option to exit program
+    cout << "10. Query Students\n";                       // Option to filter students
+    cout << "11. Cohort Statistics\n";                    // Option to show statistics
+    cout << "12. Rank Students\n";                        // Option to rank by GPA
+    cout << "13. Import Grade Sheets\n";                  // Option to import grades in bulk
+    cout << "14. Export Students\n";                      // Option to export for reporting
+    cout << "0. Exit\n";                                  // Option to exit program
     cout << "Enter choice: ";                             // Prompt for user input
 }
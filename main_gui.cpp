@@ -3,17 +3,29 @@
  */
 
 #include "student.h"    // Include the student header file with structure definitions
+#include "student_protocol.h" // Include the default server socket
 #include <iostream>     // Include for standard input/output operations
+#include <cstring>      // Include for strcmp
 
 // External function declaration for GUI interface
-extern void runGUI();   // This function is defined in gui_interface.cpp
+extern void runGUI(const char* serverSocket);   // This function is defined in gui_interface.cpp
 
 /**
  * Main function for the GUI version of the application
+ *   student_system_gui [--connect [socket]]
  */
-int main() {
+int main(int argc, char* argv[]) {
+    // With --connect the students are those of a running student_server
+    const char* serverSocket = nullptr;
+    if (argc >= 2 && strcmp(argv[1], "--connect") == 0 && argc <= 3) {
+        serverSocket = argc == 3 ? argv[2] : SERVER_SOCKET_FILENAME;
+    } else if (argc > 1) {
+        std::cout << "Usage: " << argv[0] << " [--connect [socket]]\n";
+        return 2;
+    }
+
     // Run the GUI version of the application
-    runGUI();           // This launches the ncurses interface
+    runGUI(serverSocket);   // This launches the ncurses interface
     
     // This point is reached only if the GUI exits normally without using exit()
     return 0;           // Return success code
@@ -1,14 +1,155 @@
-#include "student.h"
-#include <algorithm>
+/**
+ * Sorting Module
+ *
+ * This file contains the functions that put the student records in ID or
+ * name order. Instead of swapping whole Student records, they sort compact
+ * (key, index) pairs and then move every record once with
+ * StudentStore::permute().
+ */
 
-void sortStudentsById() {
-    sort(students, students + numStudents, [](const Student& a, const Student& b) {
-        return a.id < b.id;
-    });
+#include "student.h"   // Include student structure definitions
+#include <algorithm>   // Include for sort and inplace_merge
+#include <array>       // Include for the radix histograms
+#include <cstdint>     // Include for fixed-width keys
+#include <thread>      // Include for the parallel mode
+
+static const int MIN_PARALLEL_SLICE = 65536;   // Smaller slices do not pay for a thread
+
+/**
+ * Number of threads to sort n records with
+ */
+static int sortThreads(int threads, int n) {
+    if (threads < 1) threads = max(1, (int)thread::hardware_concurrency());
+    return max(1, min(threads, n / MIN_PARALLEL_SLICE));
 }
 
-void sortStudentsByName() {
-    sort(students, students + numStudents, [](const Student& a, const Student& b) {
-        return a.name < b.name;
+/**
+ * Run work(slice, begin, end) over equal slices of [0, n), one thread per slice
+ */
+template <typename Work>
+static void runSlices(int threads, size_t n, Work work) {
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(work, t, n * t / threads, n * (t + 1) / threads);
+    }
+    work(0, (size_t)0, n / threads);
+    for (thread& worker : workers) worker.join();
+}
+
+/**
+ * Stable LSD radix sort of 64-bit items by their upper 32 bits, 8 bits per pass
+ *
+ * Each slice counts its digits, the counts are turned into per-slice output
+ * offsets (digit-major, slice-minor, which keeps the sort stable), and each
+ * slice scatters its own items. Passes where every item has the same digit,
+ * such as the high byte of IDs from a narrow range, are skipped.
+ */
+static void radixSortByUpperHalf(vector<uint64_t>& items, int threads) {
+    size_t n = items.size();
+    vector<uint64_t> buffer(n);
+    vector<array<size_t, 256>> counts(threads);
+
+    for (int shift = 32; shift < 64; shift += 8) {
+        runSlices(threads, n, [&](int slice, size_t begin, size_t end) {
+            array<size_t, 256>& count = counts[slice];
+            count.fill(0);
+            for (size_t i = begin; i < end; i++) count[(items[i] >> shift) & 0xff]++;
+        });
+
+        size_t next = 0;
+        bool sameDigit = false;
+        for (int digit = 0; digit < 256; digit++) {
+            size_t digitTotal = 0;
+            for (int slice = 0; slice < threads; slice++) {
+                size_t count = counts[slice][digit];
+                counts[slice][digit] = next;
+                next += count;
+                digitTotal += count;
+            }
+            if (digitTotal == n) sameDigit = true;
+        }
+        if (sameDigit) continue;
+
+        runSlices(threads, n, [&](int slice, size_t begin, size_t end) {
+            array<size_t, 256>& offset = counts[slice];
+            for (size_t i = begin; i < end; i++) buffer[offset[(items[i] >> shift) & 0xff]++] = items[i];
+        });
+        items.swap(buffer);
+    }
+}
+
+void sortStudentsById(int threads) {
+    int n = students.size();
+    threads = sortThreads(threads, n);
+
+    // Key in the upper half (sign bit flipped so negative IDs sort first), index below
+    vector<uint64_t> items(n);
+    for (int i = 0; i < n; i++) {
+        items[i] = (uint64_t)((uint32_t)students[i].id ^ 0x80000000u) << 32 | (uint32_t)i;
+    }
+    radixSortByUpperHalf(items, threads);
+
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = (int)(uint32_t)items[i];
+    students.permute(order);
+}
+
+/**
+ * Name sort key: the first sixteen bytes packed big-endian into two words, so
+ * comparing them as integers orders names like std::string's byte-wise
+ * comparison; only names that agree on all sixteen bytes are compared in full
+ */
+struct NameKey {
+    uint64_t high;
+    uint64_t low;
+    int index;
+};
+
+static uint64_t packBytes(const string& name, size_t first) {
+    uint64_t word = 0;
+    for (size_t i = first; i < first + 8; i++) {
+        word = word << 8 | (i < name.size() ? (unsigned char)name[i] : 0);
+    }
+    return word;
+}
+
+void sortStudentsByName(int threads) {
+    int n = students.size();
+    threads = sortThreads(threads, n);
+
+    vector<NameKey> keys(n);
+    for (int i = 0; i < n; i++) {
+        const string& name = students[i].name;
+        keys[i] = NameKey{ packBytes(name, 0), packBytes(name, 8), i };
+    }
+
+    // Most comparisons end in the key; equal keys fall back to the full names
+    auto less = [](const NameKey& a, const NameKey& b) {
+        if (a.high != b.high) return a.high < b.high;
+        if (a.low != b.low) return a.low < b.low;
+        int c = students[a.index].name.compare(students[b.index].name);
+        if (c != 0) return c < 0;
+        return a.index < b.index;
+    };
+
+    // Sort each slice, then merge neighbouring slices pairwise
+    vector<size_t> bounds(threads + 1);
+    for (int t = 0; t <= threads; t++) bounds[t] = (size_t)n * t / threads;
+    runSlices(threads, n, [&](int, size_t begin, size_t end) {
+        sort(keys.begin() + begin, keys.begin() + end, less);
     });
+    for (int width = 1; width < threads; width *= 2) {
+        vector<thread> mergers;
+        for (int t = 0; t + width < threads; t += 2 * width) {
+            size_t begin = bounds[t], middle = bounds[t + width], end = bounds[min(t + 2 * width, threads)];
+            mergers.emplace_back([&keys, &less, begin, middle, end]() {
+                inplace_merge(keys.begin() + begin, keys.begin() + middle, keys.begin() + end, less);
+            });
+        }
+        for (thread& merger : mergers) merger.join();
+    }
+
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = keys[i].index;
+    students.permute(order);
 }
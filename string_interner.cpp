@@ -0,0 +1,78 @@
+/**
+ * String Interner Module
+ *
+ * This file contains the arena-backed string interner and the global table
+ * of course names that course slots and study plan entries refer to.
+ */
+
+#include "student.h"   // Include student structure definitions
+#include <cctype>      // Include for tolower and isupper
+#include <cstring>     // Include for memcpy
+#include <cstdlib>     // Include for abort
+
+static const size_t ARENA_BLOCK_SIZE = 64 * 1024;   // Bytes per arena block
+
+StringInterner courseNames;
+
+string_view StringInterner::copyToArena(string_view text) {
+    size_t needed = text.size() + 1;
+    char* target;
+    if (needed > ARENA_BLOCK_SIZE / 4) {
+        // Long strings get a block of their own, so the current block keeps its space
+        blocks.emplace_back(new char[needed]);
+        arenaBytes += needed;
+        target = blocks.back().get();
+    } else {
+        if (current == nullptr || currentUsed + needed > ARENA_BLOCK_SIZE) {
+            blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+            arenaBytes += ARENA_BLOCK_SIZE;
+            current = blocks.back().get();
+            currentUsed = 0;
+        }
+        target = current + currentUsed;
+        currentUsed += needed;
+    }
+    if (!text.empty()) memcpy(target, text.data(), text.size());
+    target[text.size()] = '\0';
+    return string_view(target, text.size());
+}
+
+int StringInterner::intern(string_view text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) return found->second;
+
+    // The lowercase spelling is interned first; a lowercase string is its own
+    int lowercaseId = -1;
+    for (char c : text) {
+        if (isupper((unsigned char)c)) {
+            string lowered(text);
+            for (char& l : lowered) l = (char)tolower((unsigned char)l);
+            lowercaseId = intern(lowered);
+            break;
+        }
+    }
+
+    int id = count;
+    int chunk = id >> CHUNK_BITS;
+    if (chunk == MAX_CHUNKS) abort();   // 67 million distinct names; never write past the table
+    if (!chunks[chunk]) chunks[chunk].reset(new Entry[1 << CHUNK_BITS]);
+    string_view stored = copyToArena(text);
+    chunks[chunk][id & ((1 << CHUNK_BITS) - 1)] = Entry{ stored, lowercaseId == -1 ? id : lowercaseId };
+    count++;
+    ids.emplace(stored, id);
+    return id;
+}
+
+int StringInterner::find(string_view text) const {
+    auto found = ids.find(text);
+    return found == ids.end() ? -1 : found->second;
+}
+
+size_t StringInterner::memoryUsage() const {
+    return arenaBytes
+         + blocks.capacity() * sizeof(unique_ptr<char[]>)
+         + MAX_CHUNKS * sizeof(unique_ptr<Entry[]>)
+         + (size_t)((count >> CHUNK_BITS) + 1) * (sizeof(Entry) << CHUNK_BITS)
+         + ids.bucket_count() * sizeof(void*)
+         + ids.size() * (sizeof(pair<const string_view, int>) + 2 * sizeof(void*));
+}
@@ -9,51 +9,509 @@
 #define STUDENT_H    // Define the include guard
 
 #include <string>    // Include string library for string data type
+#include <vector>    // Include vector for the growable student store
+#include <algorithm> // Include for sorting the store's records
+#include <cstddef>   // Include for size_t
+#include <cstdint>   // Include for fixed-width integers
+#include <unordered_map> // Include for the name index posting lists
+#include <string_view> // Include for views of interned strings
+#include <memory>    // Include for the interner's arena blocks
 using namespace std; // Use the standard namespace
 
 // Constants for the application
-const int MAX_STUDENTS = 100;            // Maximum number of students in the system
 const int MAX_COURSES = 10;              // Maximum number of courses per student
 const int MAX_STUDY_PLAN = 20;           // Maximum number of study plan entries
-const char FILENAME[] = "students.txt";  // File name for persistent storage
+const char FILENAME[] = "students.txt";  // Text format, read when there is no snapshot yet
+const char SNAPSHOT_FILENAME[] = "students.dat";             // Data file; its extension picks the engine (student_repository.h)
+const char JOURNAL_FILENAME[] = "students.journal";          // Changes since the last snapshot
+const char OLD_JOURNAL_FILENAME[] = "students.journal.old";  // Journal of a checkpoint in progress
+const char GRADE_SCALE_FILENAME[] = "grade_scale.txt";       // Optional institution grade scale
+
+class StudentJournal;  // Write-ahead journal, see student_journal.h
+
+/**
+ * StringInterner - Arena of distinct strings identified by 32-bit IDs
+ *
+ * Each distinct string is copied once, NUL-terminated, into large arena
+ * blocks that never move, and is referred to by its ID from then on, so
+ * equal strings compare as equal IDs. Every string also records the ID of
+ * its lowercase spelling, which turns case-insensitive comparisons into
+ * integer comparisons as well. ID 0 is the empty string. Strings are never
+ * removed, so IDs and views stay valid for the life of the interner.
+ *
+ * Interning and find() are not thread-safe. Other threads may call view(),
+ * c_str() and folded() meanwhile, for IDs they were handed: entries live in
+ * fixed-size chunks that never move, so an intern never disturbs them. This
+ * lets readers of a StudentReplicas copy resolve names while its writer
+ * interns new ones.
+ */
+class StringInterner {
+public:
+    StringInterner() : chunks(new unique_ptr<Entry[]>[MAX_CHUNKS]) { intern(string_view()); }
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    int intern(string_view text);          // ID of a string, adding it if new
+    int find(string_view text) const;      // ID of a string, or -1 if it was never interned
+    string_view view(int id) const { return entry(id).view; }
+    const char* c_str(int id) const { return entry(id).view.data(); }
+    int folded(int id) const { return entry(id).lowercaseId; } // ID of the lowercase spelling
+    int size() const { return count; }
+    size_t memoryUsage() const;
+
+private:
+    static const int CHUNK_BITS = 12;          // 4096 IDs per chunk
+    static const int MAX_CHUNKS = 1 << 14;     // Room for 67 million IDs
+
+    struct Entry {
+        string_view view;                      // Characters
+        int lowercaseId;                       // ID of the lowercase spelling
+    };
+    const Entry& entry(int id) const { return chunks[id >> CHUNK_BITS][id & ((1 << CHUNK_BITS) - 1)]; }
+    string_view copyToArena(string_view text);   // Store the characters, NUL-terminated
+
+    vector<unique_ptr<char[]>> blocks;     // Arena blocks, oldest first
+    char* current = nullptr;               // Block short strings are copied into
+    size_t currentUsed = 0;                // Bytes used in the current block
+    size_t arenaBytes = 0;                 // Capacity of all blocks
+    unique_ptr<unique_ptr<Entry[]>[]> chunks; // Entries per ID, MAX_CHUNKS chunk slots
+    int count = 0;                         // Number of IDs
+    unordered_map<string_view, int> ids;   // Characters (views into the arena) to ID
+};
+
+extern StringInterner courseNames;   // Course names and study plan entries
 
 /**
  * Course structure - Represents a single course with name and grade
+ *
+ * The name is interned in courseNames, which keeps a course slot at eight
+ * bytes and makes comparing course names comparing IDs.
  */
 struct Course {
-    string name;     // Name of the course
-    float grade;     // Grade achieved in the course (numeric value)
+    int nameId = 0;     // Name of the course (ID in courseNames)
+    float grade = 0.0f; // Grade achieved in the course (numeric value)
+
+    Course() {}
+    Course(string_view name, float grade) : nameId(courseNames.intern(name)), grade(grade) {}
+    string_view name() const { return courseNames.view(nameId); }
 };
 
 /**
  * Student structure - Main data structure for a student record
+ *
+ * Courses and study plan entries are not stored inline. They live in the
+ * shared pools of the StudentStore and are reached through the offsets below.
  */
 struct Student {
     int id;          // Unique identifier for the student
     string name;     // Full name of the student
     string nationalId; // National ID number (14 digits)
-    Course courses[MAX_COURSES]; // Array of courses taken by student
     int numCourses = 0;        // Number of courses currently registered
     float gpa = 0.0;           // Grade Point Average (0.0-4.0 scale)
-    string studyPlan[MAX_STUDY_PLAN]; // Array of study plan entries
+    double gradePoints = 0.0;  // Sum of the 4.0-scale points of the courses (kept by the store)
     int numStudyPlan = 0;      // Number of study plan entries
+    int courseOffset = 0;      // First slot of this student's courses in the course pool
+    int courseCapacity = 0;    // Number of course pool slots reserved for this student
+    int planOffset = 0;        // First slot of this student's study plan in the plan pool
+    int planCapacity = 0;      // Number of plan pool slots reserved for this student
+    int handleEntry = -1;      // Entry of this student in the store's handle table
+};
+
+// Stable reference to a student that survives deletions of other students
+typedef unsigned long long StudentHandle;
+const StudentHandle INVALID_HANDLE = ~0ULL;
+
+/**
+ * StudentIdIndex - Open-addressing hash map from student ID to store slot
+ *
+ * Uses linear probing with backward-shift deletion, so lookups never have to
+ * skip over deleted entries. The table is kept at most half full.
+ */
+class StudentIdIndex {
+public:
+    StudentIdIndex() { clear(); }
+
+    int find(int id) const;                 // Slot of the student, or -1 if absent
+    void findBatch(const int* ids, int count, int* slots) const; // Look up many IDs at once
+    void insert(int id, int slot);          // Add or update an entry
+    void erase(int id);                     // Remove an entry if present
+    void clear();                           // Remove all entries
+    void reserve(int count);                // Grow the table to hold count entries
+    int size() const { return used; }
+    size_t memoryUsage() const { return (keys.capacity() + slots.capacity()) * sizeof(int); }
+
+private:
+    int bucketOf(int id) const;             // Home bucket of an ID
+    void rehash(int buckets);               // Rebuild the table with a new bucket count
+
+    vector<int> keys;                       // Student IDs per bucket
+    vector<int> slots;                      // Store slot per bucket, -1 when empty
+    int mask = 0;                           // Bucket count minus one
+    int shift = 0;                          // Right shift applied to the hash
+    int used = 0;                           // Number of occupied buckets
+};
+
+/**
+ * StudentNameIndex - Case-insensitive gram index over student names
+ *
+ * Every lowercased name is split into overlapping three-character grams.
+ * Each gram maps to the handle entries of the students whose names contain
+ * it.
+ * Removing a name leaves its postings in place as stale entries; candidates
+ * are always verified against the current name, and the store rebuilds the
+ * index once stale postings outnumber live ones.
+ */
+class StudentNameIndex {
+public:
+    void insert(int entry, const string& name);   // Index the name of a handle entry
+    void erase(const string& name);                // Mark the postings of a name as stale
+    void clear();                                  // Remove all postings
+
+    // Shortest trigram posting list for a lowercased query of at least three
+    // characters, or nullptr if no name can match. The list may hold stale
+    // entries and duplicates. Shorter queries are checked against every name.
+    const vector<int>* candidates(const string& loweredQuery) const;
+
+    bool wantsRebuild() const { return stalePostings > 4096 && stalePostings > livePostings; }
+    size_t memoryUsage() const;
+
+    // How well a name matches a lowercased query: 0 exact, 1 prefix of the
+    // name, 2 prefix of a later word, 3 elsewhere, -1 no match.
+    static int matchRank(const string& name, const string& loweredQuery);
+
+private:
+    static void gramsOf(const string& name, vector<uint32_t>& grams); // Distinct grams of a name
+
+    unordered_map<uint32_t, vector<int>> postings; // Gram to handle entries
+    size_t livePostings = 0;                       // Postings of current names
+    size_t stalePostings = 0;                      // Postings of removed or renamed names
+};
+
+/**
+ * CourseCatalog - Courses and the students enrolled in each
+ *
+ * Course names are matched case-insensitively (through their lowercase
+ * spelling in courseNames); a course keeps the spelling it was first seen
+ * with. Each course lists the handle entries of its students, once per
+ * student however many of the student's course slots carry the name, and
+ * the sum of the grades of those slots, so rosters and averages cost
+ * O(result size) instead of a walk over every course slot.
+ */
+class CourseCatalog {
+public:
+    int find(int nameId) const;            // Course ID of an interned name, or -1
+    int find(string_view name) const;      // Course ID of a name, or -1
+    int intern(int nameId);                // Course ID of an interned name, adding the course if new
+    int size() const { return (int)courses.size(); }
+    string_view name(int course) const { return courseNames.view(courses[course].nameId); }
+    const vector<int>& enrolled(int course) const { return courses[course].students; } // Handle entries
+    int gradeCount(int course) const { return courses[course].grades; }  // Course slots with the name
+    double averageGrade(int course) const;                               // 0 without grades
+
+    void enroll(int course, int entry, float grade, bool newStudent);    // A course slot was added
+    void withdraw(int course, int entry, float grade, bool lastSlot);    // A course slot is going away
+    void regrade(int course, float oldGrade, float newGrade);            // A slot's grade changed
+    void withdrawAll(const vector<char>& leaving, const vector<int>& slots); // Drop entries whose slot is marked
+    void clear();
+    size_t memoryUsage() const;
+
+private:
+    struct CourseEntry {
+        int nameId = 0;        // Spelling first seen (ID in courseNames)
+        vector<int> students;  // Handle entries of the enrolled students
+        double gradeSum = 0.0; // Sum of the grades of all slots
+        int grades = 0;        // Number of slots
+    };
+    vector<int> byLowercaseName;      // Course ID per lowercase name ID in courseNames, -1 if none
+    vector<CourseEntry> courses;      // Indexed by course ID
+};
+
+/**
+ * GpaRanking - Students with courses ranked by GPA, overall and per course
+ *
+ * Each ranking is a sorted run of entries, best GPA first and then by
+ * ascending ID, cut into blocks of at most 2 * BLOCK_SIZE entries. The
+ * entries carry their own keys, so a student is found by binary search over
+ * the blocks' last entries and then within one block, without looking at the
+ * records; an insert or erase shifts only that block. The best or worst k
+ * students are read off the ends, and a rank is the sizes of the blocks
+ * before the student plus its offset.
+ */
+class GpaRanking {
+public:
+    struct Entry {
+        float gpa;
+        int id;
+        int handleEntry;
+    };
+    static const int OVERALL = -1;   // Group of all students with courses; other groups are course IDs
+
+    int size(int group) const;
+    void best(int group, int k, vector<int>& handleEntries) const;  // First k handle entries
+    void worst(int group, int k, vector<int>& handleEntries) const; // Last k handle entries, worst first
+    int position(int group, float gpa, int id) const;               // 0-based position of a student, or -1
+    void insert(int group, const Entry& entry);
+    void erase(int group, float gpa, int id);
+    void move(int group, float oldGpa, const Entry& entry);         // The student's GPA changed
+    void append(int group, const Entry& entry);                     // Unsorted, until sortAll()
+    void sortAll();
+    void withdrawAll(const vector<char>& leaving, const vector<int>& slots); // Drop entries whose slot is marked
+    void clear();
+    size_t memoryUsage() const;
+
+private:
+    static const int BLOCK_SIZE = 512;
+
+    struct Group {
+        vector<vector<Entry>> blocks;   // Consecutive parts of the run, none empty
+        int count = 0;
+
+        size_t blockOf(float gpa, int id) const; // Block that holds or would take a key
+        void insert(const Entry& entry);
+        bool erase(float gpa, int id);           // False if the student is not in the group
+        void rechunk(vector<Entry>& sorted);     // Replace the blocks with a sorted run
+    };
+    Group& group(int id);                  // Creates course groups on demand
+    const Group* findGroup(int id) const;  // nullptr for courses without a group
+
+    Group overall;
+    vector<Group> byCourse;                // Indexed by course ID
+};
+
+/**
+ * Orderings the store can maintain over its students
+ */
+enum StudentOrder {
+    ORDER_BY_ID,       // Ascending ID
+    ORDER_BY_NAME,     // Ascending name, then ID
+    ORDER_BY_GPA,      // Descending GPA, then ascending ID
+    NUM_STUDENT_ORDERS
+};
+
+/**
+ * StudentOrderView - Read-only view of the students in a maintained order
+ *
+ * view[position] is the store index of the student at that position. A view
+ * stays valid until the next call that modifies the store.
+ */
+class StudentOrderView {
+public:
+    StudentOrderView(const vector<int>& entries, const vector<int>& slots)
+        : entries(&entries), slots(&slots) {}
+    int size() const { return (int)entries->size(); }
+    int operator[](int position) const { return (*slots)[(*entries)[position]]; }
+
+private:
+    const vector<int>* entries;   // Handle entries in order
+    const vector<int>* slots;     // Store index per handle entry
+};
+
+/**
+ * StudentStore - Growable container for all student records
+ *
+ * Records are kept in one contiguous array. Courses and study plan entries of
+ * every student share two contiguous pools; each student owns a block of each
+ * pool. A block that has to grow while it is not at the end of its pool is
+ * moved to the end, and the hole it leaves behind is reclaimed by compact().
+ *
+ * Deleting a student moves the last record into its slot (swap-and-pop), so
+ * indices are only valid until the next deletion. Code that must keep track
+ * of a student across deletions holds a StudentHandle instead.
+ *
+ * Course names and study plan entries are interned in courseNames; study
+ * plan slots hold the name IDs. Pointers returned by courses() and
+ * studyPlan() stay valid until the next call that modifies the store. Student IDs are unique within the store and
+ * must not be changed through operator[], since they key the ID index.
+ */
+class StudentStore {
+public:
+    int size() const { return (int)records.size(); }
+    bool empty() const { return records.empty(); }
+    Student& operator[](int index) { return records[index]; }
+    const Student& operator[](int index) const { return records[index]; }
+
+    int add(Student student);          // Append a student without courses or plan, returns its index or -1 if the ID is taken
+    // Append students whose courses and study plans are already built, as a
+    // loader does: their blocks lie back to back in courses and plan, in the
+    // order of batch, and numCourses, numStudyPlan, gradePoints and gpa are
+    // set. Students whose ID is taken are skipped and their positions in
+    // batch added to rejected. Returns the number appended.
+    int appendBuilt(vector<Student>& batch, const Course* courses, const int* plan, vector<int>& rejected);
+    void remove(int index);            // Remove a student in O(1); the last student takes its slot
+    int removeBatch(const vector<int>& ids); // Remove all listed IDs in one pass, returns the count removed
+    int find(int id) const { return idIndex.find(id); } // Index of a student ID, or -1
+    void findBatch(const vector<int>& ids, vector<int>& indices) const; // Indices of many IDs
+
+    // Case-insensitive name search, best matches first (see StudentNameIndex::matchRank,
+    // then by name and ID). Fills indices with at most limit matches starting at
+    // offset and returns the total number of matches.
+    int searchNames(const string& query, int offset, int limit, vector<int>& indices);
+
+    // Students in a maintained order. Each order is sorted once on first use and
+    // from then on kept current by every insert, delete and key change, so
+    // listing in order needs neither a copy nor a sort.
+    StudentOrderView ordered(StudentOrder by);
+
+    // Course catalog with per-course rosters, built on first use and then kept
+    // current by every course change
+    const CourseCatalog& courseCatalog();
+    int courseRoster(int course, vector<int>& indices); // Store indices of a course's students, returns the count
+
+    // Students with courses ranked by GPA, best first and lower ID on ties,
+    // over everyone (course GpaRanking::OVERALL) or within a catalog course.
+    // The rankings are built on first use and then kept current by every
+    // change to a GPA or an enrollment, so a call costs O(log n + k).
+    int topStudents(int course, int k, vector<int>& indices);    // Best k, returns how many are ranked
+    int bottomStudents(int course, int k, vector<int>& indices); // Worst k, worst first; returns how many are ranked
+    int gpaRank(int index, int course = GpaRanking::OVERALL);    // 1 for the best, 0 if not ranked there
+
+    // Build everything the calls above build on first use. Afterwards their
+    // const versions below give the same results without changing anything,
+    // so any number of threads may use them while nobody changes the store.
+    void prepareForReaders();
+    int searchNames(const string& query, int offset, int limit, vector<int>& indices) const;
+    StudentOrderView ordered(StudentOrder by) const { return StudentOrderView(orders[by], handleSlots); }
+    const CourseCatalog& courseCatalog() const { return catalog; }
+    int courseRoster(int course, vector<int>& indices) const;
+    int topStudents(int course, int k, vector<int>& indices) const;
+    int bottomStudents(int course, int k, vector<int>& indices) const;
+    int gpaRank(int index, int course = GpaRanking::OVERALL) const;
+    void clear();                      // Remove all students
+    void reserve(int numStudents, int numCourses, int numPlanEntries); // Pre-size the arrays
+
+    // Stable handles
+    StudentHandle handleOf(int index) const;       // Handle of the student at an index
+    int indexOf(StudentHandle handle) const;       // Current index of a handle, or -1 if deleted
+
+    // Course access and management
+    Course* courses(int index) { return coursePool.data() + records[index].courseOffset; }
+    const Course* courses(int index) const { return coursePool.data() + records[index].courseOffset; }
+    void addCourse(int index, Course course);
+    void removeCourse(int index, int courseIndex);
+    void setCourseGrade(int index, int courseIndex, float grade);
+    // Set the grades of several courses at once: a course the student takes
+    // (by case-insensitive name, first slot) is regraded, any other course is
+    // added. The GPA, orders, rankings and journal are updated once.
+    void setCourseGrades(int index, const Course* grades, int count);
+    // Replace a student's courses and study plan (name IDs in courseNames)
+    // at once, as a committed StudentEdit does: the GPA is computed once,
+    // the orders, rankings and catalog are updated once and the journal gets
+    // a single record.
+    void setCoursesAndPlan(int index, const Course* courses, int numCourses, const int* plan, int numPlan);
+
+    // Study plan access and management (entries are name IDs in courseNames)
+    const int* studyPlan(int index) const { return planPool.data() + records[index].planOffset; }
+    string_view studyPlanEntry(int index, int planIndex) const { return courseNames.view(studyPlan(index)[planIndex]); }
+    void addStudyPlanEntry(int index, string_view entry);
+    void removeStudyPlanEntry(int index, int planIndex);
+
+    // Field updates; changes made here are seen by the journal
+    void setName(int index, const string& name);
+    void setNationalId(int index, const string& nationalId);
+    void setGpa(int index, float gpa);
+    void setGradePoints(int index, double gradePoints); // Replace the running sum (repairs only)
+
+    // Record every later change in a journal (nullptr to stop)
+    void attachJournal(StudentJournal* target) { journal = target; }
+
+    // Also append the ID of every student that is later added, changed or
+    // deleted to a list (nullptr to stop). clear() is not recorded.
+    void attachChangeLog(vector<int>* target) { changeLog = target; }
+
+    // Reorder the student records; courses and plans follow through their offsets
+    template <typename Compare>
+    void sort(Compare comp) {
+        std::sort(records.begin(), records.end(), comp);
+        rebuildIndex();
+    }
+
+    // Reorder the records so that slot i holds the student previously at order[i];
+    // order must be a permutation of 0 .. size() - 1. Each record is moved once.
+    void permute(const vector<int>& order);
+
+    void compact();               // Rebuild both pools without holes
+    size_t memoryUsage() const;   // Approximate bytes used by records, pools and string heap (not courseNames)
+
+private:
+    void compactIfWasteful();     // Compact once holes take up most of a pool
+    void rebuildIndex();          // Re-point the ID index and handles at the current slots
+    void releaseStudent(Student& s); // Return a student's pool blocks and handle
+    void rebuildNameIndex();      // Index every current name from scratch
+    void rebuildCatalog();        // Enroll every course slot from scratch
+    void enrollInCatalog(int index); // Enroll every course slot of one student
+    int takeHandle(int index);    // Handle entry for a new student at an index
+    int otherSlotOf(int index, int courseIndex) const; // Another slot of the student with the same course, or -1
+    void withdrawFromCatalog(int index); // Take a student out of every roster before it is released
+    void noteChange(int index) { if (changeLog) changeLog->push_back(records[index].id); }
+
+    // GPA rankings (no-ops until built)
+    const GpaRanking& gpaRanking();      // Built on first use
+    void rebuildRanking();
+    void rerank(int index, float oldGpa); // Move a student whose GPA changed in all of its groups
+    void unrank(int index);               // Take a student out of all of its groups before it is released
+    void rank(int index);                 // Put a student into all of its groups, at its GPA
+
+    // Maintained orders (no-ops for orders not built yet)
+    struct OrderKey {             // Fields an order compares, captured before a change
+        int id;
+        float gpa;
+        const string* name;
+    };
+    OrderKey orderKey(int index) const { return OrderKey{ records[index].id, records[index].gpa, &records[index].name }; }
+    static bool orderLess(StudentOrder by, const OrderKey& a, const OrderKey& b);
+    // First position in an order not before key; the student at handle entry
+    // moving (if any) is compared by movingKey instead of its current fields
+    int orderPosition(StudentOrder by, const OrderKey& key, int moving = -1,
+                      const OrderKey* movingKey = nullptr) const;
+    void insertIntoOrders(int index);                // Place a new student in every order
+    void eraseFromOrders(int index);                 // Take a student out before it is released
+    void reorder(StudentOrder by, int index, const OrderKey& before); // Move a student whose key changed
+
+    vector<Student> records;      // Student records in insertion order
+    vector<Course> coursePool;    // Shared pool of course blocks
+    vector<int> planPool;         // Shared pool of study plan blocks (name IDs)
+    StudentIdIndex idIndex;       // Student ID to record slot
+    vector<int> handleSlots;      // Record slot per handle entry, -1 when free
+    vector<unsigned> handleGenerations; // Bumped each time a handle entry is freed
+    vector<int> freeHandles;      // Handle entries available for reuse
+    StudentNameIndex nameIndex;   // Name grams to handle entries, built on first search
+    bool nameIndexReady = false;  // Whether nameIndex is built and kept up to date
+    vector<int> orders[NUM_STUDENT_ORDERS];        // Handle entries per maintained order
+    bool orderReady[NUM_STUDENT_ORDERS] = {};      // Whether an order is built and kept up to date
+    CourseCatalog catalog;        // Course names and rosters, built on first use
+    bool catalogReady = false;    // Whether catalog is built and kept up to date
+    GpaRanking ranking;           // GPA rankings, built on first use
+    bool rankingReady = false;    // Whether ranking is built and kept up to date
+    StudentJournal* journal = nullptr; // Receives every change, if attached
+    vector<int>* changeLog = nullptr;  // Receives the ID of every changed student, if attached
+    int wastedCourses = 0;        // Course pool slots not owned by any student
+    int wastedPlanEntries = 0;    // Plan pool slots not owned by any student
 };
 
 // External variable declarations
-extern Student students[MAX_STUDENTS]; // Global array of students
-extern int numStudents;                // Current number of students
+extern StudentStore students;     // Global store of students
 
 // Function prototypes
 
 // File operations
 void loadStudents();     // Load students from file
-void saveStudents();     // Save students to file
+void saveStudents();     // Commit pending changes to disk
+void checkpointIfNeeded(); // Fold a large journal into a new snapshot in the background
+bool commitChanges();    // Block until every change so far is durable, false if they could not be saved
+bool writeStudentsFile(const char* path, const StudentStore& store); // Write the text format
+extern int loaderThreads; // Threads used by loadStudents(), 0 for all hardware threads
 
 // Student management operations
 void addStudent();       // Add a new student
 void deleteStudent();    // Delete an existing student
 void modifyStudent();    // Modify student information
 void searchStudent();    // Search for a student
+void queryStudents();    // Find students matching filter conditions
+void showCohortStatistics(); // Show GPA and course statistics of all students
+void rankStudents();     // List the best or worst students by GPA
+void importGrades();     // Import grade sheets (one CSV file per course)
+void exportStudentData(); // Export all students as CSV, JSON Lines or columnar
+void reportBackgroundExports(bool wait); // Report background exports that finished
 
 // User interface functions
 void displayMenu();      // Display the main menu
@@ -61,14 +519,21 @@ void displayStudents(bool sortedById); // Display all students
 
 // Academic management
 void manageCourses(int index);    // Manage courses for a student
+string studyPlanStatus(const Course* courses, int numCourses, int entry); // Whether a plan entry is taken, and who takes it
 void computeGPA(int index);       // Calculate GPA for a student
 void updateStudyPlan(int index);  // Update study plan for a student
 
 // Utility functions
 int findStudentById(int id);      // Find a student by ID
+void findStudentsById(const vector<int>& ids, vector<int>& indices); // Find many students by ID
+int deleteStudentsById(const vector<int>& ids); // Delete many students by ID
 bool validateNationalId(const string& nationalId); // Validate national ID format
-void sortStudentsById();          // Sort students by ID
-void sortStudentsByName();        // Sort students by name
+// Sorting (threads: 0 for all hardware threads, 1 to sort on the calling thread)
+void sortStudentsById(int threads = 0);   // Sort students by ID
+void sortStudentsByName(int threads = 0); // Sort students by name, then by their current order
 float convertGradeTo4Scale(float numericGrade); // Convert grade to 4.0 scale
+float calculateGPA(double gradePoints, int numCourses); // GPA from a grade point sum, no output
+float calculateGPA(const StudentStore& store, int index); // GPA from a student's courses, no output
+int recomputeAllGPAs(StudentStore& store, int threads = 0); // Rebuild every running sum, returns GPAs changed
 
 #endif // End of STUDENT_H include guard
@@ -0,0 +1,373 @@
+/**
+ * Student Analytics Module
+ *
+ * This file contains the columnar copies of the store, the scalar and SIMD
+ * column kernels, and the cohort report built from them.
+ */
+
+#include "student_analytics.h"   // Include analytics declarations
+#include "grade_scale.h"         // Include the scale that decides which grades fail
+#include <algorithm>             // Include for nth_element, min_element and sort
+#include <chrono>                // Include for timing the report
+#include <cmath>                 // Include for INFINITY
+#include <cstdint>               // Include for int32_t
+#include <queue>                 // Include for the top students heap
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>           // Include for SSE2 and AVX2 intrinsics
+#define ANALYTICS_X86 1
+#endif
+
+void StudentColumns::build(StudentStore& store) {
+    const CourseCatalog& catalog = store.courseCatalog();
+    int n = store.size();
+    indices.clear();
+    ids.clear();
+    gpa.clear();
+    indices.reserve(n);
+    ids.reserve(n);
+    gpa.reserve(n);
+
+    // The catalog already counts the grades of each course
+    courseStart.assign(catalog.size() + 1, 0);
+    for (int c = 0; c < catalog.size(); c++) courseStart[c + 1] = courseStart[c] + catalog.gradeCount(c);
+    grades.resize(courseStart.back());
+    vector<int> next(courseStart.begin(), courseStart.end() - 1);
+
+    for (int i = 0; i < n; i++) {
+        const Student& s = store[i];
+        if (s.numCourses == 0) continue;
+        indices.push_back(i);
+        ids.push_back(s.id);
+        gpa.push_back(s.gpa);
+        const Course* studentCourses = store.courses(i);
+        for (int c = 0; c < s.numCourses; c++) {
+            grades[next[catalog.find(studentCourses[c].nameId)]++] = studentCourses[c].grade;
+        }
+    }
+}
+
+/**
+ * Portable kernels; the SIMD versions below handle whole vectors and leave
+ * the remainder to these
+ */
+static void totalsPortable(const float* values, size_t count, ColumnTotals& totals) {
+    for (size_t i = 0; i < count; i++) {
+        float value = values[i];
+        if (totals.count == 0) totals.min = totals.max = value;
+        totals.sum += value;
+        totals.min = min(totals.min, value);
+        totals.max = max(totals.max, value);
+        totals.count++;
+    }
+}
+
+static size_t countBelowPortable(const float* values, size_t count, float limit) {
+    size_t below = 0;
+    for (size_t i = 0; i < count; i++) below += values[i] < limit;
+    return below;
+}
+
+static int binOf(float value, float low, float scale, float lastBin) {
+    float position = (value - low) * scale;
+    position = position > 0.0f ? position : 0.0f;
+    position = position < lastBin ? position : lastBin;
+    return (int)position;
+}
+
+#ifdef ANALYTICS_X86
+/**
+ * SSE2 totals: the sum is kept in double lanes. Returns how many values were
+ * added (a multiple of 4).
+ */
+static size_t totalsSse2(const float* values, size_t count, ColumnTotals& totals) {
+    if (count < 4) return 0;
+    __m128d sumLow = _mm_setzero_pd(), sumHigh = _mm_setzero_pd();
+    __m128 minimum = _mm_loadu_ps(values), maximum = minimum;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_loadu_ps(values + i);
+        sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(value));
+        sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+        minimum = _mm_min_ps(minimum, value);
+        maximum = _mm_max_ps(maximum, value);
+    }
+    alignas(16) double sums[2];
+    alignas(16) float lows[4], highs[4];
+    _mm_store_pd(sums, _mm_add_pd(sumLow, sumHigh));
+    _mm_store_ps(lows, minimum);
+    _mm_store_ps(highs, maximum);
+    totals.count = i;
+    totals.sum = sums[0] + sums[1];
+    totals.min = min(min(lows[0], lows[1]), min(lows[2], lows[3]));
+    totals.max = max(max(highs[0], highs[1]), max(highs[2], highs[3]));
+    return i;
+}
+
+/**
+ * AVX2 totals, 8 values per step. Returns how many values were added.
+ */
+__attribute__((target("avx2")))
+static size_t totalsAvx2(const float* values, size_t count, ColumnTotals& totals) {
+    if (count < 8) return 0;
+    __m256d sumLow = _mm256_setzero_pd(), sumHigh = _mm256_setzero_pd();
+    __m256 minimum = _mm256_loadu_ps(values), maximum = minimum;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 value = _mm256_loadu_ps(values + i);
+        sumLow = _mm256_add_pd(sumLow, _mm256_cvtps_pd(_mm256_castps256_ps128(value)));
+        sumHigh = _mm256_add_pd(sumHigh, _mm256_cvtps_pd(_mm256_extractf128_ps(value, 1)));
+        minimum = _mm256_min_ps(minimum, value);
+        maximum = _mm256_max_ps(maximum, value);
+    }
+    alignas(32) double sums[4];
+    alignas(32) float lows[8], highs[8];
+    _mm256_store_pd(sums, _mm256_add_pd(sumLow, sumHigh));
+    _mm256_store_ps(lows, minimum);
+    _mm256_store_ps(highs, maximum);
+    totals.count = i;
+    totals.sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    totals.min = *min_element(lows, lows + 8);
+    totals.max = *max_element(highs, highs + 8);
+    return i;
+}
+
+/**
+ * SSE2 count: comparison masks are -1, so subtracting them counts. Returns
+ * how many values were checked (a multiple of 4).
+ */
+static size_t countBelowSse2(const float* values, size_t count, float limit, size_t& below) {
+    __m128 bound = _mm_set1_ps(limit);
+    __m128i counter = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 mask = _mm_cmplt_ps(_mm_loadu_ps(values + i), bound);
+        counter = _mm_sub_epi32(counter, _mm_castps_si128(mask));
+    }
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128((__m128i*)lanes, counter);
+    below = (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t countBelowAvx2(const float* values, size_t count, float limit, size_t& below) {
+    __m256 bound = _mm256_set1_ps(limit);
+    __m256i counter = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(values + i), bound, _CMP_LT_OQ);
+        counter = _mm256_sub_epi32(counter, _mm256_castps_si256(mask));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256((__m256i*)lanes, counter);
+    below = 0;
+    for (int32_t lane : lanes) below += (size_t)lane;
+    return i;
+}
+
+/**
+ * SIMD histograms: the bins are computed a vector at a time with the same
+ * arithmetic as binOf(), then counted one by one. Return how many values
+ * were counted.
+ */
+static size_t histogramSse2(const float* values, size_t count, float low, float scale, float lastBin,
+                            int* counts) {
+    __m128 offset = _mm_set1_ps(low), factor = _mm_set1_ps(scale);
+    __m128 zero = _mm_setzero_ps(), top = _mm_set1_ps(lastBin);
+    alignas(16) int32_t bins[4];
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 position = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i), offset), factor);
+        position = _mm_min_ps(_mm_max_ps(position, zero), top);
+        _mm_store_si128((__m128i*)bins, _mm_cvttps_epi32(position));
+        counts[bins[0]]++;
+        counts[bins[1]]++;
+        counts[bins[2]]++;
+        counts[bins[3]]++;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t histogramAvx2(const float* values, size_t count, float low, float scale, float lastBin,
+                            int* counts) {
+    __m256 offset = _mm256_set1_ps(low), factor = _mm256_set1_ps(scale);
+    __m256 zero = _mm256_setzero_ps(), top = _mm256_set1_ps(lastBin);
+    alignas(32) int32_t bins[8];
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 position = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(values + i), offset), factor);
+        position = _mm256_min_ps(_mm256_max_ps(position, zero), top);
+        _mm256_store_si256((__m256i*)bins, _mm256_cvttps_epi32(position));
+        for (int32_t bin : bins) counts[bin]++;
+    }
+    return i;
+}
+#endif
+
+bool columnKernelSupported(ColumnKernel kernel) {
+    switch (kernel) {
+        case COLUMN_KERNEL_AUTO:
+        case COLUMN_KERNEL_SCALAR:
+            return true;
+#ifdef ANALYTICS_X86
+        case COLUMN_KERNEL_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case COLUMN_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+static ColumnKernel resolveKernel(ColumnKernel kernel) {
+    if (kernel == COLUMN_KERNEL_AUTO) {
+        static const ColumnKernel best = columnKernelSupported(COLUMN_KERNEL_AVX2) ? COLUMN_KERNEL_AVX2
+                                       : columnKernelSupported(COLUMN_KERNEL_SSE2) ? COLUMN_KERNEL_SSE2
+                                       : COLUMN_KERNEL_SCALAR;
+        return best;
+    }
+    return columnKernelSupported(kernel) ? kernel : COLUMN_KERNEL_SCALAR;
+}
+
+ColumnTotals columnTotals(const float* values, size_t count, ColumnKernel kernel) {
+    ColumnTotals totals;
+    size_t done = 0;
+    switch (resolveKernel(kernel)) {
+#ifdef ANALYTICS_X86
+        case COLUMN_KERNEL_AVX2: done = totalsAvx2(values, count, totals); break;
+        case COLUMN_KERNEL_SSE2: done = totalsSse2(values, count, totals); break;
+#endif
+        default: break;
+    }
+    totalsPortable(values + done, count - done, totals);   // Remainder, or everything
+    return totals;
+}
+
+size_t countBelow(const float* values, size_t count, float limit, ColumnKernel kernel) {
+    size_t below = 0, done = 0;
+    switch (resolveKernel(kernel)) {
+#ifdef ANALYTICS_X86
+        case COLUMN_KERNEL_AVX2: done = countBelowAvx2(values, count, limit, below); break;
+        case COLUMN_KERNEL_SSE2: done = countBelowSse2(values, count, limit, below); break;
+#endif
+        default: break;
+    }
+    return below + countBelowPortable(values + done, count - done, limit);
+}
+
+void columnHistogram(const float* values, size_t count, float low, float width, int bins, int* counts,
+                     ColumnKernel kernel) {
+    float scale = 1.0f / width;
+    float lastBin = (float)(bins - 1);
+    size_t done = 0;
+    switch (resolveKernel(kernel)) {
+#ifdef ANALYTICS_X86
+        case COLUMN_KERNEL_AVX2: done = histogramAvx2(values, count, low, scale, lastBin, counts); break;
+        case COLUMN_KERNEL_SSE2: done = histogramSse2(values, count, low, scale, lastBin, counts); break;
+#endif
+        default: break;
+    }
+    for (size_t i = done; i < count; i++) counts[binOf(values[i], low, scale, lastBin)]++;
+}
+
+/**
+ * Value at a fractional rank of values[0, count), interpolated between the
+ * two neighbouring ranks. Only values[from, count) are reordered, so from
+ * must be a position the previous selection already fixed (or 0).
+ */
+static float valueAtRank(float* values, size_t from, size_t count, double rank) {
+    size_t lower = (size_t)rank;
+    nth_element(values + from, values + lower, values + count);
+    if (lower + 1 >= count) return values[lower];
+    // Everything after the selected element is at least as large; the next rank is its minimum
+    float upper = *min_element(values + lower + 1, values + count);
+    return (float)(values[lower] + (rank - lower) * (upper - values[lower]));
+}
+
+float selectPercentile(float* values, size_t count, double fraction) {
+    if (count == 0) return 0.0f;
+    return valueAtRank(values, 0, count, fraction * (count - 1));
+}
+
+/**
+ * Lowest grade that earns points on the active scale; grades below it fail
+ */
+static float lowestPassingGrade() {
+    float passing = INFINITY;
+    for (const GradeBoundary& step : gradeScale().boundaries()) {
+        if (step.points > 0.0f) passing = min(passing, step.minGrade);
+    }
+    return passing;
+}
+
+CohortReport analyzeCohort(StudentStore& store, int topCount, ColumnKernel kernel) {
+    auto start = chrono::steady_clock::now();
+    CohortReport report;
+    report.students = store.size();
+
+    StudentColumns columns;
+    columns.build(store);
+    size_t rows = columns.gpa.size();
+
+    // GPA distribution
+    report.gpa = columnTotals(columns.gpa.data(), rows, kernel);
+    columnHistogram(columns.gpa.data(), rows, 0.0f, 0.5f, GPA_HISTOGRAM_BINS, report.gpaHistogram, kernel);
+
+    // Highest GPAs: a min-heap of the best rows seen so far, worst on top
+    auto better = [&columns](int a, int b) {
+        if (columns.gpa[a] != columns.gpa[b]) return columns.gpa[a] > columns.gpa[b];
+        return columns.ids[a] < columns.ids[b];
+    };
+    priority_queue<int, vector<int>, decltype(better)> best(better);
+    for (size_t row = 0; topCount > 0 && row < rows; row++) {
+        if ((int)best.size() < topCount) {
+            best.push((int)row);
+        } else if (better((int)row, best.top())) {
+            best.pop();
+            best.push((int)row);
+        }
+    }
+    report.topStudents.resize(best.size());
+    for (int i = (int)best.size() - 1; i >= 0; i--) {
+        report.topStudents[i] = columns.indices[best.top()];
+        best.pop();
+    }
+
+    // Percentiles reorder the column, so they come last; each selection
+    // only has to look at the part above the previous one
+    size_t from = 0;
+    for (int p = 0; p < NUM_GPA_PERCENTILES && rows > 0; p++) {
+        double rank = GPA_PERCENTILES[p] * (rows - 1);
+        report.gpaPercentiles[p] = valueAtRank(columns.gpa.data(), from, rows, rank);
+        from = (size_t)rank;
+    }
+
+    // Per-course statistics over each course's slice of the grade column
+    report.failingGrade = lowestPassingGrade();
+    const CourseCatalog& catalog = store.courseCatalog();
+    for (int c = 0; c < catalog.size(); c++) {
+        float* grades = columns.grades.data() + columns.courseStart[c];
+        size_t count = columns.courseStart[c + 1] - columns.courseStart[c];
+        if (count == 0) continue;
+        ColumnTotals totals = columnTotals(grades, count, kernel);
+        CourseStatistics course;
+        course.course = c;
+        course.grades = (int)count;
+        course.mean = totals.mean();
+        course.min = totals.min;
+        course.max = totals.max;
+        course.failRate = (double)countBelow(grades, count, report.failingGrade, kernel) / count;
+        course.median = selectPercentile(grades, count, 0.5);
+        report.courses.push_back(course);
+    }
+    std::sort(report.courses.begin(), report.courses.end(), [&catalog](const CourseStatistics& a, const CourseStatistics& b) {
+        if (a.grades != b.grades) return a.grades > b.grades;
+        return catalog.name(a.course) < catalog.name(b.course);
+    });
+
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,100 @@
+/**
+ * student_analytics.h - Cohort statistics over columnar copies of the store
+ *
+ * The statistics are computed from columns: plain arrays of student IDs,
+ * GPAs and course grades, copied out of the store in one pass. Grades are
+ * grouped by catalog course, so each course is one contiguous slice. The
+ * kernels that scan the columns (sum with minimum and maximum, counting
+ * values below a limit, histogram bins) come in SSE2 and AVX2 versions next
+ * to the portable one and are chosen like the grade scale's batch
+ * conversion. Medians and percentiles use selection instead of a full sort,
+ * and the top students are kept in a small heap during one pass.
+ */
+
+#ifndef STUDENT_ANALYTICS_H
+#define STUDENT_ANALYTICS_H
+
+#include "student.h"   // Include student structure definitions
+
+/**
+ * Implementations of the column kernels
+ */
+enum ColumnKernel {
+    COLUMN_KERNEL_AUTO,     // Best kernel the CPU supports
+    COLUMN_KERNEL_SCALAR,   // Portable loop
+    COLUMN_KERNEL_SSE2,     // 4 values per step
+    COLUMN_KERNEL_AVX2      // 8 values per step
+};
+
+/**
+ * Columns copied out of a store
+ *
+ * Only students with at least one course have a GPA, so only they get a
+ * row; rows follow the store order.
+ */
+struct StudentColumns {
+    vector<int> indices;      // Store index per row
+    vector<int> ids;          // Student ID per row
+    vector<float> gpa;        // GPA per row
+    vector<float> grades;     // Every course grade, grouped by catalog course
+    vector<int> courseStart;  // First grade of each catalog course; one extra entry ends the last
+
+    void build(StudentStore& store);   // Replace the columns with the store's current data
+};
+
+/**
+ * Count, sum and range of a column (minimum and maximum are 0 when it is empty)
+ */
+struct ColumnTotals {
+    size_t count = 0;
+    double sum = 0.0;
+    float min = 0.0f;
+    float max = 0.0f;
+
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+};
+
+bool columnKernelSupported(ColumnKernel kernel);
+ColumnTotals columnTotals(const float* values, size_t count, ColumnKernel kernel = COLUMN_KERNEL_AUTO);
+size_t countBelow(const float* values, size_t count, float limit, ColumnKernel kernel = COLUMN_KERNEL_AUTO);
+// Add each value to counts[bin], with bin = (value - low) / width clamped to [0, bins - 1]
+void columnHistogram(const float* values, size_t count, float low, float width, int bins, int* counts,
+                     ColumnKernel kernel = COLUMN_KERNEL_AUTO);
+// Percentile (fraction in [0, 1]) interpolated between ranks; reorders values
+float selectPercentile(float* values, size_t count, double fraction);
+
+const int GPA_HISTOGRAM_BINS = 8;           // Bins of width 0.5; the last one includes 4.0
+const int NUM_GPA_PERCENTILES = 5;
+const double GPA_PERCENTILES[NUM_GPA_PERCENTILES] = { 0.10, 0.25, 0.50, 0.75, 0.90 };
+
+/**
+ * Statistics of one course
+ */
+struct CourseStatistics {
+    int course;          // Catalog course ID
+    int grades;          // Number of grades
+    double mean;         // Mean grade
+    float median;        // Median grade
+    float min, max;      // Lowest and highest grade
+    double failRate;     // Share of grades that earn no points on the grade scale
+};
+
+/**
+ * Everything analyzeCohort() computes
+ */
+struct CohortReport {
+    int students = 0;                               // Students in the store
+    ColumnTotals gpa;                               // GPAs of the students with courses
+    float gpaPercentiles[NUM_GPA_PERCENTILES] = {}; // At the fractions of GPA_PERCENTILES
+    int gpaHistogram[GPA_HISTOGRAM_BINS] = {};      // Students per GPA bin
+    float failingGrade = 0.0f;                      // Grades below this earn no points
+    vector<CourseStatistics> courses;               // Courses with grades, most grades first
+    vector<int> topStudents;                        // Store indices, highest GPA first (lower ID on ties)
+    double seconds = 0.0;                           // Time to build the columns and compute the report
+};
+
+// Build the columns of a store and compute the report, with the topCount
+// highest GPAs
+CohortReport analyzeCohort(StudentStore& store, int topCount = 10, ColumnKernel kernel = COLUMN_KERNEL_AUTO);
+
+#endif // STUDENT_ANALYTICS_H
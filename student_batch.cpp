@@ -0,0 +1,232 @@
+/**
+ * Student Batch Module
+ *
+ * This file contains the command loop of the batch mode described in
+ * student_batch.h.
+ */
+
+#include "student_batch.h"    // Include batch declarations
+#include "student_client.h"   // Include the changes made locally or through a server
+#include "student_query.h"    // Include the query conditions
+#include "student_export.h"   // Include the export writers
+#include <algorithm>          // Include for sort
+#include <chrono>             // Include for the run time
+#include <climits>            // Include for INT_MIN and INT_MAX
+#include <cerrno>             // Include for errno
+#include <cstdlib>            // Include for strtol and strtof
+#include <cstdio>             // Include for snprintf
+
+static const size_t STATUS_FLUSH_BYTES = 65536;   // Status lines written at once
+static const int CHECKPOINT_EVERY = 4096;         // Commands between checkpoint checks
+
+// Export format names, by ExportFormat
+static const char* const EXPORT_FORMAT_NAMES[NUM_EXPORT_FORMATS] = { "csv", "jsonl", "columnar" };
+
+/**
+ * Fields of the command line being run; the strings are reused from line to
+ * line so that a long script does not allocate for each of them
+ */
+struct BatchFields {
+    vector<string> values;
+    int count = 0;
+
+    const string& operator[](int i) const { return values[i]; }
+};
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Split a line into fields from a position; false with the reason if a
+ * quote is not closed
+ */
+static bool splitFields(const string& line, size_t pos, BatchFields& fields, string& error) {
+    fields.count = 0;
+    while (true) {
+        while (pos < line.size() && isBlank(line[pos])) pos++;
+        if (pos == line.size()) return true;
+        if ((int)fields.values.size() == fields.count) fields.values.emplace_back();
+        string& field = fields.values[fields.count++];
+        if (line[pos] != '"') {
+            size_t end = pos;
+            while (end < line.size() && !isBlank(line[end])) end++;
+            field.assign(line, pos, end - pos);
+            pos = end;
+            continue;
+        }
+        field.clear();
+        for (pos++; pos < line.size() && line[pos] != '"'; pos++) {
+            if (line[pos] == '\\' && pos + 1 < line.size()) pos++;
+            field += line[pos];
+        }
+        if (pos == line.size()) {
+            error = "Missing closing quote";
+            return false;
+        }
+        pos++;
+    }
+}
+
+static bool parseId(const string& field, int& id) {
+    char* end;
+    errno = 0;
+    long value = strtol(field.c_str(), &end, 10);
+    if (end == field.c_str() || *end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) return false;
+    id = (int)value;
+    return true;
+}
+
+static bool parseGrade(const string& field, float& grade) {
+    char* end;
+    grade = strtof(field.c_str(), &end);
+    return end != field.c_str() && *end == '\0' && grade >= 0.0f && grade <= 100.0f;
+}
+
+// Store index of a student ID field, or -1 with the reason
+static int findStudentField(const string& field, string& error) {
+    int id;
+    if (!parseId(field, id)) {
+        error = "Invalid student ID";
+        return -1;
+    }
+    int index = students.find(id);
+    if (index == -1) error = "Student not found";
+    return index;
+}
+
+static bool runAdd(const BatchFields& fields, string& error) {
+    if (fields.count != 3) {
+        error = "Usage: add <id> <name> <national id>";
+        return false;
+    }
+    Student student;
+    if (!parseId(fields[0], student.id)) {
+        error = "Invalid student ID";
+        return false;
+    }
+    if (!validateNationalId(fields[2])) {
+        error = "Invalid national ID format";
+        return false;
+    }
+    student.name = fields[1];
+    student.nationalId = fields[2];
+    return addStudentRecord(student, error);
+}
+
+static bool runDelete(const BatchFields& fields, string& error) {
+    if (fields.count != 1) {
+        error = "Usage: delete <id>";
+        return false;
+    }
+    int index = findStudentField(fields[0], error);
+    return index != -1 && removeStudentRecord(index, error);
+}
+
+static bool runSetGrade(const BatchFields& fields, string& error) {
+    if (fields.count != 3) {
+        error = "Usage: setgrade <id> <course> <grade>";
+        return false;
+    }
+    int index = findStudentField(fields[0], error);
+    if (index == -1) return false;
+    float grade;
+    if (!parseGrade(fields[2], grade)) {
+        error = "Grade must be between 0 and 100";
+        return false;
+    }
+    return setStudentGrade(index, Course(fields[1], grade), error);
+}
+
+static bool runQuery(const string& text, vector<int>& ids, string& result, string& error) {
+    StudentQuery query;
+    if (!query.parse(text, error)) return false;
+    ids.clear();
+    query.run(students, [&ids](int index) {
+        ids.push_back(students[index].id);
+        return true;
+    });
+    sort(ids.begin(), ids.end());   // A parallel scan finds them in any order
+    result += " " + to_string(ids.size());
+    for (int id : ids) {
+        result += ' ';
+        result += to_string(id);
+    }
+    return true;
+}
+
+static bool runExport(const BatchFields& fields, string& result, string& error) {
+    if (fields.count != 2) {
+        error = "Usage: export csv|jsonl|columnar <file>";
+        return false;
+    }
+    int format = 0;
+    while (format < NUM_EXPORT_FORMATS && fields[0] != EXPORT_FORMAT_NAMES[format]) format++;
+    if (format == NUM_EXPORT_FORMATS) {
+        error = "Unknown export format " + fields[0];
+        return false;
+    }
+    ExportReport report = exportStudents(fields[1].c_str(), students, (ExportFormat)format);
+    if (!report.ok) {
+        error = report.error;
+        return false;
+    }
+    result += " " + to_string(report.students) + " " + to_string(report.bytes);
+    return true;
+}
+
+int runBatch(istream& in, ostream& out) {
+    auto start = chrono::steady_clock::now();
+    string line, status, result, error;
+    BatchFields fields;
+    vector<int> ids;
+    int lineNumber = 0, commands = 0, failed = 0;
+    while (getline(in, line)) {
+        lineNumber++;
+        size_t begin = 0;
+        while (begin < line.size() && isBlank(line[begin])) begin++;
+        if (begin == line.size() || line[begin] == '#') continue;
+        size_t end = begin;
+        while (end < line.size() && !isBlank(line[end])) end++;
+        string_view command(line.data() + begin, end - begin);
+
+        applyServerChanges();   // Take in what other clients of the server changed meanwhile
+        result.clear();
+        bool ok;
+        if (command == "query") ok = runQuery(line.substr(end), ids, result, error);
+        else if (!splitFields(line, end, fields, error)) ok = false;
+        else if (command == "add") ok = runAdd(fields, error);
+        else if (command == "delete") ok = runDelete(fields, error);
+        else if (command == "setgrade") ok = runSetGrade(fields, error);
+        else if (command == "export") ok = runExport(fields, result, error);
+        else {
+            error = "Unknown command " + string(command);
+            ok = false;
+        }
+
+        commands++;
+        status += to_string(lineNumber);
+        if (ok) {
+            status += " ok";
+            status += result;
+        } else {
+            failed++;
+            status += " error ";
+            status += error;
+        }
+        status += '\n';
+        if (status.size() >= STATUS_FLUSH_BYTES) {
+            out.write(status.data(), status.size());
+            status.clear();
+        }
+        if (commands % CHECKPOINT_EVERY == 0) checkpointIfNeeded();
+    }
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "# %d commands, %d failed, %.2f s\n", commands, failed,
+             chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    status += summary;
+    out.write(status.data(), status.size());
+    out.flush();
+    return failed;
+}
@@ -0,0 +1,45 @@
+/**
+ * student_batch.h - Commands read from a script instead of the menus
+ *
+ *   student_system --batch [file]
+ *
+ * Runs one command per line from the file, or from standard input without a
+ * file or with "-", then saves and exits. Nothing is prompted or displayed
+ * besides one status line per command. The commands are:
+ *
+ *   add <id> <name> <national id>     Student without courses or plan
+ *   delete <id>
+ *   setgrade <id> <course> <grade>    Regrade the course, or add it
+ *   query <conditions>                As in Query Students, for example
+ *                                     query gpa < 2.0 and course = Physics
+ *   export csv|jsonl|columnar <file>  Every student, as in Export Students
+ *
+ * Fields are separated by spaces or tabs. A name or course with spaces is
+ * written in double quotes, in which \" stands for a quote and \\ for a
+ * backslash: add 1001 "Ada Lovelace" 29901010100000. Empty lines and lines
+ * starting with # are skipped.
+ *
+ * Each command gets a status line starting with its line number:
+ *
+ *   <line> ok
+ *   <line> ok <count> <id>...         query: the matching IDs, in ID order
+ *   <line> ok <students> <bytes>      export
+ *   <line> error <reason>
+ *
+ * A failed command changes nothing and the script goes on. The changes go
+ * through student_client.h, so a script can also run against a server
+ * (--connect). A last line starting with # counts the commands and failures.
+ */
+
+#ifndef STUDENT_BATCH_H
+#define STUDENT_BATCH_H
+
+#include "student.h"   // Include student structure definitions
+#include <istream>     // Include for the command stream
+#include <ostream>     // Include for the status lines
+
+// Run every command of a script on the global store; returns the number of
+// commands that failed
+int runBatch(istream& in, ostream& out);
+
+#endif // STUDENT_BATCH_H
@@ -0,0 +1,367 @@
+/**
+ * Student Client Module
+ *
+ * This file contains the changes the console and ncurses programs make to
+ * students, applied to the global store directly or sent to student_server
+ * and mirrored from its replies.
+ */
+
+#include "student_client.h"     // Include client declarations
+#include "student_protocol.h"   // Include the server protocol
+#include <cerrno>               // Include for errno
+#include <climits>              // Include for PATH_MAX
+#include <cstdlib>              // Include for realpath
+#include <sys/socket.h>         // Include for sockets
+#include <sys/un.h>             // Include for Unix-domain addresses
+#include <unistd.h>             // Include for close
+
+static const char LOST_CONNECTION[] = "Lost connection to the server";
+
+static bool useServer = false;    // Whether changes go to a server
+static int serverFd = -1;         // Connection to it, -1 once lost
+static string received;           // Bytes from the server not handled yet
+static uint32_t lastTag = 0;      // Tag of the last request
+static bool reloadRequested = false; // The server changed too many students to push them
+
+/**
+ * A change another client made, waiting for applyServerChanges()
+ */
+struct ServerChange {
+    bool deleted;
+    StudentImage image;   // Only image.student.id for a deletion
+};
+static vector<ServerChange> deferred;
+
+/**
+ * A reply, copied out of the receive buffer
+ */
+struct Reply {
+    string bytes;
+    Frame frame;
+};
+
+static void disconnect() {
+    if (serverFd >= 0) close(serverFd);
+    serverFd = -1;
+    received.clear();
+}
+
+static uint32_t nextTag() {
+    if (++lastTag == 0) lastTag = 1;   // Tag 0 marks pushes
+    return lastTag;
+}
+
+static void applyChange(const ServerChange& change) {
+    if (!change.deleted) {
+        applyStudentImage(students, change.image);
+        return;
+    }
+    int index = students.find(change.image.student.id);
+    if (index != -1) students.remove(index);
+}
+
+// Deferred changes to a student are older than a reply that carries it
+static void dropDeferred(int id) {
+    deferred.erase(remove_if(deferred.begin(), deferred.end(),
+                             [id](const ServerChange& change) { return change.image.student.id == id; }),
+                   deferred.end());
+}
+
+/**
+ * Read what the server sent; blocking waits for the first bytes. Returns
+ * false once the connection is lost.
+ */
+static bool receive(bool blocking) {
+    char chunk[65536];
+    while (true) {
+        ssize_t n = recv(serverFd, chunk, sizeof(chunk), blocking ? 0 : MSG_DONTWAIT);
+        if (n > 0) {
+            received.append(chunk, n);
+            blocking = false;   // Then take whatever else is there already
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && !blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        disconnect();
+        return false;
+    }
+}
+
+/**
+ * Handle the frames received so far, up to the reply with a tag if given.
+ * Pushes are applied at once or deferred. Returns 1 once the reply is in
+ * reply, 0 if more bytes are needed and -1 if the server broke the protocol.
+ */
+static int takeFrames(uint32_t tag, bool applyNow, Reply* reply) {
+    size_t used = 0;
+    Frame frame;
+    int result;
+    while ((result = parseFrame(received.data() + used, received.size() - used, frame)) == 1) {
+        used += frame.frameBytes;
+        if (frame.tag == 0 && frame.kind == MSG_RELOAD) {
+            reloadRequested = true;
+            continue;
+        }
+        if (frame.tag == 0 && frame.kind == MSG_SNAPSHOT) {
+            // Everything held so far is older than the students that follow
+            if (!applyNow) return -1;
+            students.clear();
+            deferred.clear();
+            continue;
+        }
+        if (frame.tag == 0 && (frame.kind == MSG_CHANGED || frame.kind == MSG_DELETED)) {
+            ServerChange change;
+            change.deleted = frame.kind == MSG_DELETED;
+            FrameReader in(frame);
+            if (change.deleted) change.image.student.id = in.getInt();
+            else in.getStudent(change.image);
+            if (!in.atEnd()) return -1;
+            if (applyNow) applyChange(change);
+            else deferred.push_back(std::move(change));
+            continue;
+        }
+        if (!reply || frame.tag != tag || (frame.kind != MSG_OK && frame.kind != MSG_ERROR)) return -1;
+        reply->bytes.assign(received.data() + used - frame.frameBytes, frame.frameBytes);
+        parseFrame(reply->bytes.data(), reply->bytes.size(), reply->frame);
+        received.erase(0, used);
+        return 1;
+    }
+    received.erase(0, used);
+    return result == 0 ? 0 : -1;
+}
+
+/**
+ * Send a request and wait for its reply. Returns false with the reason if
+ * the server refused it or could not be reached.
+ */
+static bool call(const string& request, uint32_t tag, Reply& reply, string& error, bool applyNow = false) {
+    if (serverFd < 0) {
+        error = LOST_CONNECTION;
+        return false;
+    }
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(serverFd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            disconnect();
+            error = LOST_CONNECTION;
+            return false;
+        }
+        sent += n;
+    }
+    int result;
+    while ((result = takeFrames(tag, applyNow, &reply)) == 0) {
+        if (!receive(true)) break;
+    }
+    if (result != 1) {
+        disconnect();
+        error = LOST_CONNECTION;
+        return false;
+    }
+    if (reply.frame.kind == MSG_ERROR) {
+        FrameReader in(reply.frame);
+        error = string(in.getString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Send a request whose reply is the changed student, and mirror it
+ */
+static bool callForStudent(const string& request, uint32_t tag, string& error) {
+    Reply reply;
+    if (!call(request, tag, reply, error)) return false;
+    StudentImage image;
+    FrameReader in(reply.frame);
+    if (!in.getStudent(image) || !in.atEnd()) {
+        disconnect();
+        error = LOST_CONNECTION;
+        return false;
+    }
+    dropDeferred(image.student.id);
+    applyStudentImage(students, image);
+    return true;
+}
+
+/**
+ * Mirror every student of the server. They come as pushes ahead of the
+ * reply and are applied at once.
+ */
+static bool subscribe(string& error) {
+    reloadRequested = false;
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_SUBSCRIBE, tag);
+    out.finish();
+    Reply reply;
+    return call(request, tag, reply, error, true);
+}
+
+bool connectToServer(const char* path, string& error) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        error = string("Socket path ") + path + " is too long";
+        return false;
+    }
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+        error = string("Could not connect to ") + path + ": " + strerror(errno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    serverFd = fd;
+    useServer = true;
+    students.clear();
+    return subscribe(error);
+}
+
+bool connectedToServer() {
+    return useServer;
+}
+
+int applyServerChanges() {
+    if (serverFd < 0) return 0;
+    if (receive(false) && takeFrames(0, false, nullptr) < 0) disconnect();
+    if (reloadRequested && serverFd >= 0) {
+        string error;
+        subscribe(error);   // A lost connection shows with the next request
+        return students.size();
+    }
+    int changed = (int)deferred.size();
+    for (const ServerChange& change : deferred) applyChange(change);
+    deferred.clear();
+    return changed;
+}
+
+bool addStudentRecord(const Student& student, string& error) {
+    if (!useServer) {
+        if (students.add(student) != -1) return true;
+        error = "ID already exists";
+        return false;
+    }
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_ADD, tag);
+    out.putInt(student.id);
+    out.putString(student.name);
+    out.putString(student.nationalId);
+    out.finish();
+    return callForStudent(request, tag, error);
+}
+
+bool removeStudentRecord(int index, string& error) {
+    if (!useServer) {
+        students.remove(index);
+        return true;
+    }
+    int id = students[index].id;
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_DELETE, tag);
+    out.putInt(id);
+    out.finish();
+    Reply reply;
+    if (!call(request, tag, reply, error)) return false;
+    dropDeferred(id);
+    index = students.find(id);   // Still there: pushes are only applied between operations
+    if (index != -1) students.remove(index);
+    return true;
+}
+
+bool setStudentName(int index, const string& name, string& error) {
+    if (!useServer) {
+        students.setName(index, name);
+        return true;
+    }
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_SET_NAME, tag);
+    out.putInt(students[index].id);
+    out.putString(name);
+    out.finish();
+    return callForStudent(request, tag, error);
+}
+
+bool setStudentNationalId(int index, const string& nationalId, string& error) {
+    if (!useServer) {
+        students.setNationalId(index, nationalId);
+        return true;
+    }
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_SET_NATIONAL_ID, tag);
+    out.putInt(students[index].id);
+    out.putString(nationalId);
+    out.finish();
+    return callForStudent(request, tag, error);
+}
+
+bool setStudentGrade(int index, const Course& grade, string& error) {
+    if (!useServer) {
+        int lowercaseId = courseNames.folded(grade.nameId);
+        const Course* courses = students.courses(index);
+        bool adds = true;
+        for (int c = 0; c < students[index].numCourses && adds; c++) {
+            adds = courseNames.folded(courses[c].nameId) != lowercaseId;
+        }
+        if (adds && students[index].numCourses >= MAX_COURSES) {
+            error = "Maximum courses reached";
+            return false;
+        }
+        students.setCourseGrades(index, &grade, 1);
+        return true;
+    }
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_SET_GRADE, tag);
+    out.putInt(students[index].id);
+    out.putString(grade.name());
+    out.putFloat(grade.grade);
+    out.finish();
+    return callForStudent(request, tag, error);
+}
+
+bool commitStudentEdit(const StudentEdit& edit, string& error) {
+    if (!useServer) return commitEdit(students, edit, error);
+    if (edit.empty()) return true;
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_EDIT, tag);
+    out.putInt(edit.id());
+    putEditChanges(out, edit.changes());
+    out.finish();
+    return callForStudent(request, tag, error);
+}
+
+bool importStudentGrades(const vector<GradeSheet>& sheets, GradeImportReport& report, string& error) {
+    if (!useServer) {
+        report = importGradeSheets(sheets, students);
+        return true;
+    }
+    // The server opens the sheets, from its own working directory
+    string request;
+    uint32_t tag = nextTag();
+    FrameWriter out(request, REQUEST_IMPORT_GRADES, tag);
+    out.putInt((int32_t)sheets.size());
+    for (const GradeSheet& sheet : sheets) {
+        char resolved[PATH_MAX];
+        out.putString(realpath(sheet.path.c_str(), resolved) ? resolved : sheet.path.c_str());
+        out.putString(sheet.course.empty() ? courseNameFromPath(sheet.path) : sheet.course);
+    }
+    out.finish();
+    Reply reply;
+    if (!call(request, tag, reply, error)) return false;
+    FrameReader in(reply.frame);
+    if (!getImportReport(in, report)) {
+        disconnect();
+        error = LOST_CONNECTION;
+        return false;
+    }
+    // The updated students came ahead of the reply; an import holds no indices
+    applyServerChanges();
+    return true;
+}
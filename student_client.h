@@ -0,0 +1,43 @@
+/**
+ * student_client.h - Changing students, on their own or through student_server
+ *
+ * The console and ncurses programs change students only through the
+ * functions below. A program running on its own changes the global store
+ * directly, as it always has. Once connected to a server (connectToServer)
+ * every change becomes a request, and the global store is a mirror of the
+ * server's: filled when connecting, updated from each reply, and brought up
+ * to date with the changes of other clients by applyServerChanges(). The
+ * menus call that once an operation is chosen and before it runs, never
+ * during one, so the indices and references a form holds stay valid.
+ *
+ * Each function returns false with a message in error if the change was
+ * refused (by the server, or because the connection was lost); the store is
+ * then unchanged.
+ */
+
+#ifndef STUDENT_CLIENT_H
+#define STUDENT_CLIENT_H
+
+#include "student.h"        // Include student structure definitions
+#include "grade_import.h"   // Include grade sheets and import reports
+#include "student_edit.h"   // Include staged course and study plan changes
+
+// Connect to a server and mirror its students in the global store
+bool connectToServer(const char* path, string& error);
+
+// Whether the program works through a server, even if the connection was lost
+bool connectedToServer();
+
+// Apply the changes other clients made since the last call; returns how many
+// students changed
+int applyServerChanges();
+
+bool addStudentRecord(const Student& student, string& error);          // Student without courses or plan
+bool removeStudentRecord(int index, string& error);
+bool setStudentName(int index, const string& name, string& error);
+bool setStudentNationalId(int index, const string& nationalId, string& error);
+bool setStudentGrade(int index, const Course& grade, string& error);   // Regrade the course (any case) or add it
+bool commitStudentEdit(const StudentEdit& edit, string& error);        // All of its changes or none
+bool importStudentGrades(const vector<GradeSheet>& sheets, GradeImportReport& report, string& error);
+
+#endif // STUDENT_CLIENT_H
@@ -0,0 +1,94 @@
+/**
+ * Student Information System - Data File Converter
+ *
+ * Converts between the storage engines of student_repository.h:
+ *   student_convert to-binary students.txt students.dat
+ *   student_convert to-text students.dat students.txt
+ *   student_convert copy <input> <output>    engines picked by extension
+ *                                            (.txt text, .pages page file,
+ *                                            anything else snapshot)
+ * and fetches one student from a file without loading the whole of a page
+ * file:
+ *   student_convert get <file> <id>
+ */
+
+#include "student.h"              // Include student structure definitions
+#include "student_repository.h"   // Include the storage engines
+#include <iostream>               // Include for console output
+#include <cstring>                // Include for strcmp
+#include <cstdlib>                // Include for atoi
+
+// Global store required by the linked modules
+StudentStore students;
+
+/**
+ * Print one student found in a file
+ */
+static void printStudent(const StudentImage& image) {
+    const Student& s = image.student;
+    cout << "ID: " << s.id << "\nName: " << s.name << "\nNational ID: " << s.nationalId
+         << "\nGPA: " << s.gpa << "\nCourses:";
+    if (image.courses.empty()) cout << " none";
+    for (const pair<string, float>& course : image.courses) cout << "\n  " << course.first << ": " << course.second;
+    cout << "\nStudy plan:";
+    if (image.studyPlan.empty()) cout << " none";
+    for (const string& entry : image.studyPlan) cout << "\n  " << entry;
+    cout << "\n";
+}
+
+/**
+ * Main function - converts one file or prints one student
+ */
+int main(int argc, char* argv[]) {
+    const char* command = argc > 1 ? argv[1] : "";
+    if (argc != 4 || (strcmp(command, "to-binary") != 0 && strcmp(command, "to-text") != 0 &&
+                      strcmp(command, "copy") != 0 && strcmp(command, "get") != 0)) {
+        cout << "Usage: " << argv[0] << " to-binary <students.txt> <students.dat>\n"
+             << "       " << argv[0] << " to-text <students.dat> <students.txt>\n"
+             << "       " << argv[0] << " copy <input> <output>\n"
+             << "       " << argv[0] << " get <file> <id>\n";
+        return 2;
+    }
+    const char* input = argv[2];
+    const char* output = argv[3];
+    string error;
+
+    if (strcmp(command, "get") == 0) {
+        unique_ptr<StudentRepository> repository = makeStudentRepository(repositoryKindOf(input), input);
+        StudentImage image;
+        if (repository->find(atoi(output), image, error)) {
+            printStudent(image);
+            return 0;
+        }
+        if (error.empty()) cout << "Student not found.\n";
+        else cout << "Error: " << error << ".\n";
+        return 1;
+    }
+
+    RepositoryKind from = repositoryKindOf(input), to = repositoryKindOf(output);
+    if (strcmp(command, "to-binary") == 0) {
+        from = REPOSITORY_TEXT;
+        to = REPOSITORY_SNAPSHOT;
+    } else if (strcmp(command, "to-text") == 0) {
+        from = REPOSITORY_SNAPSHOT;
+        to = REPOSITORY_TEXT;
+    }
+    StudentStore store;
+    vector<ParseError> errors;
+    if (!makeStudentRepository(from, input)->loadAll(store, error, errors)) {
+        cout << "Error: Could not read " << input;
+        if (!error.empty()) cout << " (" << error << ")";
+        cout << ".\n";
+        return 1;
+    }
+    if (!error.empty()) cout << "Warning: " << error << ".\n";
+    for (const ParseError& e : errors) {
+        cout << "Error parsing student data (line " << e.line << "): " << e.message << endl;
+    }
+    if (!makeStudentRepository(to, output)->saveAll(store, error)) {
+        cout << "Error: Could not write " << output << " (" << error << ").\n";
+        return 1;
+    }
+    cout << store.size() << " students converted.\n";
+    return 0;
+}
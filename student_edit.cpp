@@ -0,0 +1,142 @@
+/**
+ * Student Edit Module
+ *
+ * This file contains the staging of course and study plan changes and their
+ * replay on a student at commit.
+ */
+
+#include "student_edit.h"   // Include edit declarations
+
+bool applyEditChange(vector<Course>& courses, vector<int>& plan, const EditChange& change, string& error) {
+    // Edits from clients come this way too, so the grade is checked here
+    bool setsGrade = change.step == EDIT_ADD_COURSE || change.step == EDIT_SET_GRADE;
+    if (setsGrade && !(change.grade >= 0.0f && change.grade <= 100.0f)) {
+        error = "Grade must be between 0 and 100";
+        return false;
+    }
+    switch (change.step) {
+        case EDIT_ADD_COURSE:
+            if ((int)courses.size() >= MAX_COURSES) break;
+            courses.emplace_back(change.name, change.grade);
+            return true;
+        case EDIT_REMOVE_COURSE: {
+            int nameId = courseNames.find(change.name);
+            for (size_t c = 0; c < courses.size(); c++) {
+                if (courses[c].nameId == nameId) {
+                    courses.erase(courses.begin() + c);
+                    return true;
+                }
+            }
+            error = "Course not found";
+            return false;
+        }
+        case EDIT_SET_GRADE: {
+            // Any spelling of the course is regraded
+            int lowercaseId = courseNames.folded(courseNames.intern(change.name));
+            for (Course& course : courses) {
+                if (courseNames.folded(course.nameId) == lowercaseId) {
+                    course.grade = change.grade;
+                    return true;
+                }
+            }
+            if ((int)courses.size() >= MAX_COURSES) break;
+            courses.emplace_back(change.name, change.grade);
+            return true;
+        }
+        case EDIT_ADD_PLAN_ENTRY:
+            if ((int)plan.size() >= MAX_STUDY_PLAN) {
+                error = "Study plan is full";
+                return false;
+            }
+            plan.push_back(courseNames.intern(change.name));
+            return true;
+        case EDIT_REMOVE_PLAN_ENTRY: {
+            int nameId = courseNames.find(change.name);
+            for (size_t p = 0; p < plan.size(); p++) {
+                if (plan[p] == nameId) {
+                    plan.erase(plan.begin() + p);
+                    return true;
+                }
+            }
+            error = "Study plan entry not found";
+            return false;
+        }
+        default:
+            error = "Unknown change";
+            return false;
+    }
+    error = "Maximum courses reached";
+    return false;
+}
+
+bool replayEdit(const StudentStore& store, int index, const vector<EditChange>& changes,
+                vector<Course>& courses, vector<int>& plan, string& error) {
+    const Student& s = store[index];
+    courses.assign(store.courses(index), store.courses(index) + s.numCourses);
+    plan.assign(store.studyPlan(index), store.studyPlan(index) + s.numStudyPlan);
+    for (const EditChange& change : changes) {
+        if (!applyEditChange(courses, plan, change, error)) return false;
+    }
+    return true;
+}
+
+StudentEdit::StudentEdit(const StudentStore& store, int index) : store(store), studentId(store[index].id) {
+    string unused;
+    replayEdit(store, index, staged, stagedCourses, stagedPlan, unused);
+}
+
+float StudentEdit::gpa() const {
+    double gradePoints = 0.0;
+    for (const Course& course : stagedCourses) gradePoints += convertGradeTo4Scale(course.grade);
+    return calculateGPA(gradePoints, (int)stagedCourses.size());
+}
+
+bool StudentEdit::stage(EditChange change, string& error) {
+    if (!applyEditChange(stagedCourses, stagedPlan, change, error)) return false;
+    staged.push_back(std::move(change));
+    return true;
+}
+
+bool StudentEdit::addCourse(const Course& course, string& error) {
+    return stage(EditChange{ EDIT_ADD_COURSE, string(course.name()), course.grade }, error);
+}
+
+bool StudentEdit::removeCourse(int courseIndex, string& error) {
+    // Changes name their course, so the first slot of this exact name goes
+    return stage(EditChange{ EDIT_REMOVE_COURSE, string(stagedCourses[courseIndex].name()) }, error);
+}
+
+bool StudentEdit::setCourseGrade(string_view name, float grade, string& error) {
+    return stage(EditChange{ EDIT_SET_GRADE, string(name), grade }, error);
+}
+
+bool StudentEdit::addPlanEntry(string_view entry, string& error) {
+    return stage(EditChange{ EDIT_ADD_PLAN_ENTRY, string(entry) }, error);
+}
+
+bool StudentEdit::removePlanEntry(int planIndex, string& error) {
+    return stage(EditChange{ EDIT_REMOVE_PLAN_ENTRY, string(planEntry(planIndex)) }, error);
+}
+
+void StudentEdit::abort() {
+    staged.clear();
+    stagedCourses.clear();
+    stagedPlan.clear();
+    int index = store.find(studentId);
+    string unused;
+    if (index != -1) replayEdit(store, index, staged, stagedCourses, stagedPlan, unused);
+}
+
+bool commitEdit(StudentStore& store, const StudentEdit& edit, string& error) {
+    int index = store.find(edit.id());
+    if (index == -1) {
+        error = "Student not found";
+        return false;
+    }
+    if (edit.empty()) return true;
+    vector<Course> courses;
+    vector<int> plan;
+    if (!replayEdit(store, index, edit.changes(), courses, plan, error)) return false;
+    store.setCoursesAndPlan(index, courses.data(), (int)courses.size(), plan.data(), (int)plan.size());
+    return true;
+}
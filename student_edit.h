@@ -0,0 +1,97 @@
+/**
+ * student_edit.h - Several course and study plan changes to a student as one
+ *
+ * A StudentEdit stages changes to the courses and study plan of one student
+ * without touching the store: begin by constructing it, stage changes, then
+ * commit them all (commitStudentEdit in student_client.h, or commitEdit
+ * below) or abort. Until then the edit shows the student as the changes will
+ * leave it. A commit applies the whole batch with one
+ * StudentStore::setCoursesAndPlan call, so the GPA is computed once, the
+ * orders, rankings and catalog are updated once, the journal gets a single
+ * record, and nobody ever sees the student half changed.
+ *
+ * Changes name their course or entry, as the server requests do, and a
+ * commit replays them on the student as it is then. The server does the same
+ * with an edit a client sends, on a student that other clients may have
+ * changed meanwhile. If a change no longer applies, the edit fails as a whole
+ * and nothing is changed.
+ */
+
+#ifndef STUDENT_EDIT_H
+#define STUDENT_EDIT_H
+
+#include "student.h"   // Include student structure definitions
+#include <cstdint>     // Include for fixed-width integers
+
+/**
+ * Kinds of staged changes
+ */
+enum EditStep : uint8_t {
+    EDIT_ADD_COURSE = 1,          // Add a course slot
+    EDIT_REMOVE_COURSE = 2,       // Remove the first slot with exactly this name
+    EDIT_SET_GRADE = 3,           // Regrade the first slot with this name in any case, or add it
+    EDIT_ADD_PLAN_ENTRY = 4,      // Append a study plan entry
+    EDIT_REMOVE_PLAN_ENTRY = 5    // Remove the first plan entry with exactly this name
+};
+
+/**
+ * One staged change
+ */
+struct EditChange {
+    EditStep step;
+    string name;         // Course or plan entry
+    float grade = 0.0f;  // For EDIT_ADD_COURSE and EDIT_SET_GRADE
+};
+
+// Apply one change to a course list and a plan (name IDs); returns false
+// with the reason if it does not apply (or its grade is not within 0-100),
+// leaving both unchanged
+bool applyEditChange(vector<Course>& courses, vector<int>& plan, const EditChange& change, string& error);
+
+// The courses and plan of a student after a list of changes; returns false
+// with the reason of the first change that does not apply
+bool replayEdit(const StudentStore& store, int index, const vector<EditChange>& changes,
+                vector<Course>& courses, vector<int>& plan, string& error);
+
+/**
+ * Changes staged for one student
+ */
+class StudentEdit {
+public:
+    StudentEdit(const StudentStore& store, int index);   // Begin, from the student as it is now
+
+    int id() const { return studentId; }
+    const vector<EditChange>& changes() const { return staged; }
+    bool empty() const { return staged.empty(); }
+
+    // The student as the staged changes leave it
+    const vector<Course>& courses() const { return stagedCourses; }
+    const vector<int>& plan() const { return stagedPlan; }
+    string_view planEntry(int planIndex) const { return courseNames.view(stagedPlan[planIndex]); }
+    float gpa() const;
+
+    // Stage a change; false with the reason if it cannot apply (nothing is staged)
+    bool addCourse(const Course& course, string& error);
+    bool removeCourse(int courseIndex, string& error);
+    bool setCourseGrade(string_view name, float grade, string& error);
+    bool addPlanEntry(string_view entry, string& error);
+    bool removePlanEntry(int planIndex, string& error);
+
+    void abort();   // Drop every staged change
+
+private:
+    bool stage(EditChange change, string& error);
+
+    const StudentStore& store;
+    int studentId;
+    vector<EditChange> staged;
+    vector<Course> stagedCourses;
+    vector<int> stagedPlan;
+};
+
+// Commit an edit to a store: replay it on the student and apply the result
+// at once. False with the reason if the student is gone or a change no
+// longer applies; the store is then unchanged.
+bool commitEdit(StudentStore& store, const StudentEdit& edit, string& error);
+
+#endif // STUDENT_EDIT_H
@@ -0,0 +1,458 @@
+/**
+ * Student Export Module
+ *
+ * This file contains the buffered export output, the CSV, JSON Lines and
+ * columnar writers described in student_export.h, and background exports.
+ */
+
+#include "student_export.h"   // Include export declarations
+#include <iostream>           // Include for flushing console output before fork
+#include <charconv>           // Include for to_chars
+#include <chrono>             // Include for timing the export
+#include <cerrno>             // Include for errno
+#include <cstdio>             // Include for rename and remove
+#include <fcntl.h>            // Include for open
+#include <unistd.h>           // Include for write, close and fork
+#include <sys/wait.h>         // Include for waitpid
+
+static const char COLUMNAR_MAGIC[8] = { 'S', 'I', 'S', 'C', 'O', 'L', 'S', '1' };
+
+void ExportBuffer::appendInt(long long value) {
+    char digits[24];
+    char* end = to_chars(digits, digits + sizeof(digits), value).ptr;
+    append(digits, end - digits);
+}
+
+void ExportBuffer::appendFloat(float value) {
+    char digits[32];
+    char* end = to_chars(digits, digits + sizeof(digits), value).ptr;
+    append(digits, end - digits);
+}
+
+void ExportBuffer::pad(size_t alignment) {
+    static const char zeros[8] = {};
+    size_t over = offset() % alignment;
+    if (over != 0) append(zeros, alignment - over);
+}
+
+bool ExportBuffer::flush() {
+    const char* pos = buffer.data();
+    size_t left = used;
+    while (left > 0 && !writeFailed) {
+        ssize_t n = ::write(fd, pos, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            writeFailed = true;
+            break;
+        }
+        pos += n;
+        left -= n;
+    }
+    flushed += used;
+    used = 0;
+    return !writeFailed;
+}
+
+void ExportBuffer::appendLarge(const void* data, size_t size) {
+    // Fill the buffer, then copy the rest through it one buffer at a time
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        if (used == buffer.size()) flush();
+        size_t n = min(size, buffer.size() - used);
+        memcpy(buffer.data() + used, bytes, n);
+        used += n;
+        bytes += n;
+        size -= n;
+    }
+}
+
+/**
+ * CSV writer (RFC 4180)
+ */
+class CsvWriter : public ExportWriter {
+public:
+    const char* name() const override { return "CSV"; }
+    const char* extension() const override { return ".csv"; }
+
+    void write(const StudentStore& store, const StudentOrderView& order, ExportBuffer& out) override {
+        out.append("id,name,national_id,gpa,courses,study_plan\r\n");
+        for (int position = 0; position < order.size(); position++) {
+            int index = order[position];
+            const Student& s = store[index];
+            const Course* courses = store.courses(index);
+            const int* studyPlan = store.studyPlan(index);
+
+            out.appendInt(s.id);
+            out.append(',');
+            field(out, s.name);
+            out.append(',');
+            field(out, s.nationalId);
+            out.append(',');
+            out.appendFloat(s.gpa);
+            out.append(',');
+
+            // A list field is quoted as a whole if any of its names needs it
+            bool quoted = false;
+            for (int c = 0; c < s.numCourses && !quoted; c++) quoted = needsQuotes(courses[c].name());
+            if (quoted) out.append('"');
+            for (int c = 0; c < s.numCourses; c++) {
+                if (c > 0) out.append(';');
+                listName(out, courses[c].name(), quoted);
+                out.append(':');
+                out.appendFloat(courses[c].grade);
+            }
+            if (quoted) out.append('"');
+            out.append(',');
+
+            quoted = false;
+            for (int p = 0; p < s.numStudyPlan && !quoted; p++) quoted = needsQuotes(courseNames.view(studyPlan[p]));
+            if (quoted) out.append('"');
+            for (int p = 0; p < s.numStudyPlan; p++) {
+                if (p > 0) out.append(';');
+                listName(out, courseNames.view(studyPlan[p]), quoted);
+            }
+            if (quoted) out.append('"');
+            out.append("\r\n");
+        }
+    }
+
+private:
+    static bool needsQuotes(string_view value) {
+        for (char c : value) {
+            if (c == ',' || c == '"' || c == '\r' || c == '\n') return true;
+        }
+        return false;
+    }
+
+    // Characters of a field; inside quotes, quotes are doubled
+    static void text(ExportBuffer& out, string_view value, bool quoted) {
+        if (!quoted) {
+            out.append(value);
+            return;
+        }
+        size_t quote;
+        while ((quote = value.find('"')) != string_view::npos) {
+            out.append(value.substr(0, quote + 1));
+            out.append('"');
+            value.remove_prefix(quote + 1);
+        }
+        out.append(value);
+    }
+
+    // Characters of a name in a list field; the separators ';' and ':' and
+    // the escape '\' itself are preceded by a '\'
+    static void listName(ExportBuffer& out, string_view value, bool quoted) {
+        size_t special;
+        while ((special = value.find_first_of("\\;:")) != string_view::npos) {
+            text(out, value.substr(0, special), quoted);
+            out.append('\\');
+            out.append(value[special]);
+            value.remove_prefix(special + 1);
+        }
+        text(out, value, quoted);
+    }
+
+    static void field(ExportBuffer& out, string_view value) {
+        bool quoted = needsQuotes(value);
+        if (quoted) out.append('"');
+        text(out, value, quoted);
+        if (quoted) out.append('"');
+    }
+};
+
+/**
+ * JSON Lines writer
+ */
+class JsonLinesWriter : public ExportWriter {
+public:
+    const char* name() const override { return "JSON Lines"; }
+    const char* extension() const override { return ".jsonl"; }
+
+    void write(const StudentStore& store, const StudentOrderView& order, ExportBuffer& out) override {
+        for (int position = 0; position < order.size(); position++) {
+            int index = order[position];
+            const Student& s = store[index];
+            const Course* courses = store.courses(index);
+            const int* studyPlan = store.studyPlan(index);
+
+            out.append("{\"id\":");
+            out.appendInt(s.id);
+            out.append(",\"name\":");
+            str(out, s.name);
+            out.append(",\"national_id\":");
+            str(out, s.nationalId);
+            out.append(",\"gpa\":");
+            out.appendFloat(s.gpa);
+            out.append(",\"courses\":[");
+            for (int c = 0; c < s.numCourses; c++) {
+                out.append(c > 0 ? ",{\"name\":" : "{\"name\":");
+                str(out, courses[c].name());
+                out.append(",\"grade\":");
+                out.appendFloat(courses[c].grade);
+                out.append('}');
+            }
+            out.append("],\"study_plan\":[");
+            for (int p = 0; p < s.numStudyPlan; p++) {
+                if (p > 0) out.append(',');
+                str(out, courseNames.view(studyPlan[p]));
+            }
+            out.append("]}\n");
+        }
+    }
+
+private:
+    // JSON string; quotes, backslashes and control characters are escaped,
+    // other bytes (UTF-8 text) are copied as they are
+    static void str(ExportBuffer& out, string_view value) {
+        static const char hex[] = "0123456789abcdef";
+        out.append('"');
+        size_t run = 0;   // Start of the characters not written yet
+        for (size_t i = 0; i < value.size(); i++) {
+            unsigned char c = value[i];
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(value.substr(run, i - run));
+            run = i + 1;
+            switch (c) {
+                case '"': out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default: {
+                    char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+                    out.append(escaped, sizeof(escaped));
+                }
+            }
+        }
+        out.append(value.substr(run));
+        out.append('"');
+    }
+};
+
+/**
+ * Columnar writer
+ *
+ * Each column is one pass over the students, so nothing but the name
+ * dictionary is held in memory.
+ */
+class ColumnarWriter : public ExportWriter {
+public:
+    const char* name() const override { return "columnar"; }
+    const char* extension() const override { return ".cols"; }
+
+    void write(const StudentStore& store, const StudentOrderView& order, ExportBuffer& out) override {
+        int rows = order.size();
+        table.clear();
+        ColumnarHeader header = {};
+        memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+        header.version = COLUMNAR_VERSION;
+        header.rows = rows;
+        out.appendValue(header);
+
+        begin(out, "id", COLUMNAR_INT32);
+        for (int p = 0; p < rows; p++) out.appendValue((int32_t)store[order[p]].id);
+        end(out, rows);
+
+        strings(out, "name", store, order, [](const Student& s) -> const string& { return s.name; });
+        strings(out, "national_id", store, order, [](const Student& s) -> const string& { return s.nationalId; });
+
+        begin(out, "gpa", COLUMNAR_FLOAT32);
+        for (int p = 0; p < rows; p++) out.appendValue(store[order[p]].gpa);
+        end(out, rows);
+
+        // Course names and plan entries become dictionary codes in order of appearance
+        code.assign(courseNames.size(), -1);
+        dictionary.clear();
+        uint64_t courseRows = offsets(out, "course.offsets", store, order, false);
+        begin(out, "course.name", COLUMNAR_UINT32);
+        for (int p = 0; p < rows; p++) {
+            int index = order[p];
+            for (int c = 0; c < store[index].numCourses; c++) out.appendValue(codeOf(store.courses(index)[c].nameId));
+        }
+        end(out, courseRows);
+        begin(out, "course.grade", COLUMNAR_FLOAT32);
+        for (int p = 0; p < rows; p++) {
+            int index = order[p];
+            for (int c = 0; c < store[index].numCourses; c++) out.appendValue(store.courses(index)[c].grade);
+        }
+        end(out, courseRows);
+
+        uint64_t planRows = offsets(out, "plan.offsets", store, order, true);
+        begin(out, "plan.name", COLUMNAR_UINT32);
+        for (int p = 0; p < rows; p++) {
+            int index = order[p];
+            for (int e = 0; e < store[index].numStudyPlan; e++) out.appendValue(codeOf(store.studyPlan(index)[e]));
+        }
+        end(out, planRows);
+
+        begin(out, "dict.offsets", COLUMNAR_UINT64);
+        uint64_t bytes = 0;
+        out.appendValue(bytes);
+        for (int nameId : dictionary) {
+            bytes += courseNames.view(nameId).size();
+            out.appendValue(bytes);
+        }
+        end(out, dictionary.size() + 1);
+        begin(out, "dict.bytes", COLUMNAR_BYTES);
+        for (int nameId : dictionary) out.append(courseNames.view(nameId));
+        end(out, bytes);
+
+        out.pad(8);
+        ColumnarTrailer trailer = {};
+        trailer.tableOffset = out.offset();
+        trailer.columnCount = (uint32_t)table.size();
+        memcpy(trailer.magic, COLUMNAR_MAGIC, sizeof(trailer.magic));
+        for (const ColumnarColumn& column : table) out.appendValue(column);
+        out.appendValue(trailer);
+    }
+
+private:
+    void begin(ExportBuffer& out, const char* columnName, ColumnarType type) {
+        out.pad(8);
+        ColumnarColumn column = {};
+        strncpy(column.name, columnName, sizeof(column.name) - 1);
+        column.type = type;
+        column.offset = out.offset();
+        table.push_back(column);
+    }
+
+    void end(ExportBuffer&, uint64_t count) { table.back().count = count; }
+
+    uint32_t codeOf(int nameId) {
+        if (code[nameId] == -1) {
+            code[nameId] = (int)dictionary.size();
+            dictionary.push_back(nameId);
+        }
+        return (uint32_t)code[nameId];
+    }
+
+    // "<prefix>.offsets" and "<prefix>.bytes" columns of a string field
+    template <typename Field>
+    void strings(ExportBuffer& out, const string& prefix, const StudentStore& store, const StudentOrderView& order,
+                 Field field) {
+        begin(out, (prefix + ".offsets").c_str(), COLUMNAR_UINT64);
+        uint64_t bytes = 0;
+        out.appendValue(bytes);
+        for (int p = 0; p < order.size(); p++) {
+            bytes += field(store[order[p]]).size();
+            out.appendValue(bytes);
+        }
+        end(out, order.size() + 1);
+        begin(out, (prefix + ".bytes").c_str(), COLUMNAR_BYTES);
+        for (int p = 0; p < order.size(); p++) out.append(field(store[order[p]]));
+        end(out, bytes);
+    }
+
+    // Offsets column of the courses or study plans, returns their total
+    uint64_t offsets(ExportBuffer& out, const char* columnName, const StudentStore& store,
+                     const StudentOrderView& order, bool plan) {
+        begin(out, columnName, COLUMNAR_UINT64);
+        uint64_t total = 0;
+        out.appendValue(total);
+        for (int p = 0; p < order.size(); p++) {
+            const Student& s = store[order[p]];
+            total += plan ? s.numStudyPlan : s.numCourses;
+            out.appendValue(total);
+        }
+        end(out, order.size() + 1);
+        return total;
+    }
+
+    vector<ColumnarColumn> table;   // Columns written so far
+    vector<int> code;               // Dictionary code per courseNames ID, -1 if none yet
+    vector<int> dictionary;         // courseNames ID per dictionary code
+};
+
+unique_ptr<ExportWriter> makeExportWriter(ExportFormat format) {
+    switch (format) {
+        case EXPORT_CSV: return unique_ptr<ExportWriter>(new CsvWriter());
+        case EXPORT_JSON_LINES: return unique_ptr<ExportWriter>(new JsonLinesWriter());
+        case EXPORT_COLUMNAR: return unique_ptr<ExportWriter>(new ColumnarWriter());
+        default: return nullptr;
+    }
+}
+
+ExportReport exportStudents(const char* path, StudentStore& store, ExportWriter& writer) {
+    auto start = chrono::steady_clock::now();
+    ExportReport report;
+
+    // Written under a temporary name, so a failed export leaves no partial file
+    string temporary = string(path) + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        report.error = "cannot create " + temporary + ": " + strerror(errno);
+        return report;
+    }
+    StudentOrderView order = store.ordered(ORDER_BY_ID);
+    ExportBuffer out(fd);
+    writer.write(store, order, out);
+    bool written = out.flush();
+    int writeError = errno;
+    if (close(fd) != 0 && written) {
+        written = false;
+        writeError = errno;
+    }
+    if (!written) {
+        remove(temporary.c_str());
+        report.error = "cannot write " + temporary + ": " + strerror(writeError);
+        return report;
+    }
+    if (rename(temporary.c_str(), path) != 0) {
+        report.error = string("cannot rename ") + temporary + " to " + path + ": " + strerror(errno);
+        remove(temporary.c_str());
+        return report;
+    }
+
+    report.ok = true;
+    report.students = order.size();
+    report.bytes = out.offset();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+ExportReport exportStudents(const char* path, StudentStore& store, ExportFormat format) {
+    unique_ptr<ExportWriter> writer = makeExportWriter(format);
+    if (!writer) {
+        ExportReport report;
+        report.error = "unknown export format";
+        return report;
+    }
+    return exportStudents(path, store, *writer);
+}
+
+/**
+ * Export running in a child process
+ */
+struct BackgroundExport {
+    pid_t child;
+    string path;
+};
+
+static vector<BackgroundExport> backgroundExports;
+
+bool startBackgroundExport(const char* path, StudentStore& store, ExportFormat format) {
+    cout.flush();   // The child must not write out the parent's pending output
+    pid_t child = fork();
+    if (child == 0) {
+        bool ok = exportStudents(path, store, format).ok;
+        _exit(ok ? 0 : 1);   // Skip destructors, they belong to the parent
+    }
+    if (child < 0) return false;
+    backgroundExports.push_back(BackgroundExport{ child, path });
+    return true;
+}
+
+void finishedBackgroundExports(bool wait, vector<FinishedExport>& finished) {
+    finished.clear();
+    for (size_t i = 0; i < backgroundExports.size();) {
+        int status;
+        pid_t result = waitpid(backgroundExports[i].child, &status, wait ? 0 : WNOHANG);
+        if (result == 0) {   // Still writing
+            i++;
+            continue;
+        }
+        bool ok = result > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        finished.push_back(FinishedExport{ backgroundExports[i].path, ok });
+        backgroundExports.erase(backgroundExports.begin() + i);
+    }
+}
@@ -0,0 +1,192 @@
+/**
+ * student_export.h - Full extracts of the student store for reporting
+ *
+ * An export writes every student, in ID order, through an ExportWriter:
+ *
+ *   CSV          RFC 4180: a header row, then one row per student with the
+ *                columns id,name,national_id,gpa,courses,study_plan; courses
+ *                are "name:grade" pairs and study plan entries names, both
+ *                separated by ';'. Within a name, ';', ':' and '\' are
+ *                escaped with a '\' ("Lab\; Part 2"). Fields holding a
+ *                comma, quote or line break are quoted, with quotes doubled;
+ *                lines end in CRLF.
+ *   JSON Lines   One JSON object per student and line:
+ *                {"id":101,"name":"...","national_id":"...","gpa":3.5,
+ *                 "courses":[{"name":"...","grade":85}],"study_plan":["..."]}
+ *   Columnar     The binary layout below, one contiguous array per column.
+ *
+ * Writers format straight from the store into a large output buffer, with
+ * to_chars for numbers; no per-student strings are built. The file is
+ * written under a temporary name and renamed into place when complete, so
+ * readers never see a partial extract.
+ *
+ * Columnar layout (native byte order, every column aligned to 8 bytes):
+ *   header:   ColumnarHeader
+ *   columns:  back to back, in the order of the column table
+ *   table:    ColumnarColumn per column
+ *   trailer:  ColumnarTrailer, the last bytes of the file
+ * A reader starts from the trailer, as the table can only be written once
+ * every column is. Variable-length values are stored as an offsets column
+ * (count + 1 entries) indexing a values column: "name.offsets" into
+ * "name.bytes", "course.offsets" into "course.name" and "course.grade", and
+ * so on. Course names and study plan entries are codes into the "dict"
+ * strings, which hold each distinct name once.
+ */
+
+#ifndef STUDENT_EXPORT_H
+#define STUDENT_EXPORT_H
+
+#include "student.h"   // Include student structure definitions
+#include <cstdint>     // Include for fixed-width integers
+#include <cstring>     // Include for memcpy
+
+/**
+ * Export formats
+ */
+enum ExportFormat {
+    EXPORT_CSV,
+    EXPORT_JSON_LINES,
+    EXPORT_COLUMNAR,
+    NUM_EXPORT_FORMATS
+};
+
+const uint32_t COLUMNAR_VERSION = 1;   // Version written by this build
+
+/**
+ * Columnar file header
+ */
+struct ColumnarHeader {
+    char magic[8];           // "SISCOLS1"
+    uint32_t version;        // COLUMNAR_VERSION of the writer
+    uint32_t reserved;       // Zero
+    uint64_t rows;           // Number of students
+};
+
+/**
+ * Columnar value types
+ */
+enum ColumnarType : uint32_t {
+    COLUMNAR_INT32 = 1,
+    COLUMNAR_UINT32 = 2,
+    COLUMNAR_UINT64 = 3,
+    COLUMNAR_FLOAT32 = 4,
+    COLUMNAR_BYTES = 5
+};
+
+/**
+ * Entry of the column table
+ */
+struct ColumnarColumn {
+    char name[24];           // NUL-padded, e.g. "course.grade"
+    uint32_t type;           // ColumnarType
+    uint32_t reserved;       // Zero
+    uint64_t offset;         // Start of the column in the file
+    uint64_t count;          // Number of values (bytes for COLUMNAR_BYTES)
+};
+
+/**
+ * Last bytes of a columnar file
+ */
+struct ColumnarTrailer {
+    uint64_t tableOffset;    // Start of the column table
+    uint32_t columnCount;    // Entries in the column table
+    uint32_t reserved;       // Zero
+    char magic[8];           // "SISCOLS1"
+};
+
+/**
+ * ExportBuffer - Buffered writes to a file
+ *
+ * Values are appended to a large buffer that is written out whenever it
+ * fills up. A failed write is remembered and later appends are dropped.
+ */
+class ExportBuffer {
+public:
+    explicit ExportBuffer(int fd, size_t capacity = 1 << 20) : fd(fd), buffer(capacity) {}
+    ExportBuffer(const ExportBuffer&) = delete;
+    ExportBuffer& operator=(const ExportBuffer&) = delete;
+
+    void append(const void* data, size_t size) {
+        if (used + size > buffer.size()) {
+            appendLarge(data, size);
+            return;
+        }
+        memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+    void append(string_view text) { append(text.data(), text.size()); }
+    void append(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    template <typename T>
+    void appendValue(const T& value) { append(&value, sizeof(T)); } // Raw bytes of a number
+    void appendInt(long long value);   // Decimal digits
+    void appendFloat(float value);     // Shortest digits that read back as value
+    void pad(size_t alignment);        // Zero bytes up to the next multiple of alignment
+
+    bool flush();                      // Write out the buffer, returns false once a write failed
+    uint64_t offset() const { return flushed + used; } // Bytes appended so far
+    bool failed() const { return writeFailed; }
+
+private:
+    void appendLarge(const void* data, size_t size);
+
+    int fd;                      // Destination
+    vector<char> buffer;         // Pending bytes
+    size_t used = 0;             // Pending bytes in buffer
+    uint64_t flushed = 0;        // Bytes already written
+    bool writeFailed = false;    // Whether a write failed
+};
+
+/**
+ * ExportWriter - Formats students into an export file
+ *
+ * New formats are added by deriving a writer; exportStudents() takes care of
+ * the file, the order and the report.
+ */
+class ExportWriter {
+public:
+    virtual ~ExportWriter() {}
+    virtual const char* name() const = 0;        // Format name for messages
+    virtual const char* extension() const = 0;   // Usual file extension, with the dot
+    // Write the students at the store indices of order
+    virtual void write(const StudentStore& store, const StudentOrderView& order, ExportBuffer& out) = 0;
+};
+
+// Writer of a built-in format
+unique_ptr<ExportWriter> makeExportWriter(ExportFormat format);
+
+/**
+ * What happened to an export
+ */
+struct ExportReport {
+    bool ok = false;       // Whether the file was written completely
+    string error;          // Why not, if it was not
+    int students = 0;      // Students written
+    uint64_t bytes = 0;    // Size of the file
+    double seconds = 0.0;  // Time for the whole export
+};
+
+// Export every student, in ID order, to a file
+ExportReport exportStudents(const char* path, StudentStore& store, ExportWriter& writer);
+ExportReport exportStudents(const char* path, StudentStore& store, ExportFormat format);
+
+/**
+ * Background export that has finished
+ */
+struct FinishedExport {
+    string path;
+    bool ok;
+};
+
+// Export in a child process. fork() gives it a copy-on-write image of the
+// store as it is now, so the caller can keep changing the store meanwhile.
+// Returns false if no process could be started.
+bool startBackgroundExport(const char* path, StudentStore& store, ExportFormat format);
+
+// Collect the background exports that have finished since the last call;
+// with wait, first wait until every export has finished
+void finishedBackgroundExports(bool wait, vector<FinishedExport>& finished);
+
+#endif // STUDENT_EXPORT_H
@@ -0,0 +1,116 @@
+/**
+ * Student Index Module
+ *
+ * This file contains the hash index that maps student IDs to their
+ * slot in the student store.
+ */
+
+#include "student.h"   // Include student structure definitions
+
+// Hint the CPU to fetch a cache line ahead of use where supported
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)0)
+#endif
+
+/**
+ * Home bucket of an ID using Fibonacci hashing
+ */
+int StudentIdIndex::bucketOf(int id) const {
+    return (int)(((unsigned)id * 2654435769u) >> shift);
+}
+
+void StudentIdIndex::clear() {
+    keys.assign(16, 0);
+    slots.assign(16, -1);
+    mask = 15;
+    shift = 28;
+    used = 0;
+}
+
+void StudentIdIndex::reserve(int count) {
+    int buckets = mask + 1;
+    while (buckets < count * 2) buckets *= 2;
+    if (buckets != mask + 1) rehash(buckets);
+}
+
+void StudentIdIndex::rehash(int buckets) {
+    vector<int> oldKeys;
+    vector<int> oldSlots;
+    oldKeys.swap(keys);
+    oldSlots.swap(slots);
+
+    keys.assign(buckets, 0);
+    slots.assign(buckets, -1);
+    mask = buckets - 1;
+    shift = 32;
+    for (int b = buckets; b > 1; b /= 2) shift--;
+    used = 0;
+
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+        if (oldSlots[i] != -1) insert(oldKeys[i], oldSlots[i]);
+    }
+}
+
+int StudentIdIndex::find(int id) const {
+    for (int b = bucketOf(id); slots[b] != -1; b = (b + 1) & mask) {
+        if (keys[b] == id) return slots[b];
+    }
+    return -1;
+}
+
+void StudentIdIndex::findBatch(const int* ids, int count, int* found) const {
+    // Work in small groups: hash and prefetch a whole group first so the
+    // cache misses of its probes overlap instead of running back to back
+    const int groupSize = 16;
+    int homes[groupSize];
+    for (int base = 0; base < count; base += groupSize) {
+        int n = min(groupSize, count - base);
+        for (int i = 0; i < n; i++) {
+            homes[i] = bucketOf(ids[base + i]);
+            PREFETCH(&keys[homes[i]]);
+            PREFETCH(&slots[homes[i]]);
+        }
+        for (int i = 0; i < n; i++) {
+            int slot = -1;
+            for (int b = homes[i]; slots[b] != -1; b = (b + 1) & mask) {
+                if (keys[b] == ids[base + i]) {
+                    slot = slots[b];
+                    break;
+                }
+            }
+            found[base + i] = slot;
+        }
+    }
+}
+
+void StudentIdIndex::insert(int id, int slot) {
+    if ((used + 1) * 2 > mask + 1) rehash((mask + 1) * 2);
+
+    int b = bucketOf(id);
+    while (slots[b] != -1 && keys[b] != id) b = (b + 1) & mask;
+    if (slots[b] == -1) used++;
+    keys[b] = id;
+    slots[b] = slot;
+}
+
+void StudentIdIndex::erase(int id) {
+    int hole = bucketOf(id);
+    while (slots[hole] != -1 && keys[hole] != id) hole = (hole + 1) & mask;
+    if (slots[hole] == -1) return;   // Not present
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless their home bucket lies between the hole and their position
+    for (int next = (hole + 1) & mask; slots[next] != -1; next = (next + 1) & mask) {
+        int home = bucketOf(keys[next]);
+        bool staysPut = (hole <= next) ? (hole < home && home <= next)
+                                       : (hole < home || home <= next);
+        if (staysPut) continue;
+        keys[hole] = keys[next];
+        slots[hole] = slots[next];
+        hole = next;
+    }
+    slots[hole] = -1;
+    used--;
+}
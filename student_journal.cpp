@@ -0,0 +1,401 @@
+/**
+ * Student Journal Module
+ *
+ * This file contains the write-ahead journal: record encoding, the
+ * group-commit thread and replay at startup.
+ */
+
+#include "student_journal.h"   // Include journal declarations
+#include "student_parser.h"    // Include MappedFile for replay
+#include <cstring>             // Include for memcpy and memcmp
+#include <fcntl.h>             // Include for open
+#include <sys/stat.h>          // Include for fstat
+#include <unistd.h>            // Include for write, fdatasync and truncate
+#include <cerrno>              // Include for errno
+#include <cstdio>              // Include for rename
+
+static const char JOURNAL_MAGIC[8] = { 'S', 'I', 'S', 'J', 'R', 'N', 'L', '1' };
+
+/**
+ * Lookup table for crc32, built once (thread-safe static initialisation)
+ */
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+uint32_t crc32(const char* data, size_t size) {
+    static const Crc32Table table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.entries[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Helpers that append fixed-width values and length-prefixed strings
+static void putRaw(string& out, const void* value, size_t size) {
+    out.append((const char*)value, size);
+}
+static void putInt(string& out, int32_t value) { putRaw(out, &value, sizeof(value)); }
+static void putFloat(string& out, float value) { putRaw(out, &value, sizeof(value)); }
+static void putString(string& out, string_view value) {
+    putInt(out, (int32_t)value.size());
+    out.append(value);
+}
+
+/**
+ * Bounds-checked reader over a record payload
+ */
+struct PayloadReader {
+    const char* pos;
+    const char* end;
+    bool ok = true;
+
+    void raw(void* value, size_t size) {
+        if ((size_t)(end - pos) < size) {
+            ok = false;
+            memset(value, 0, size);
+            return;
+        }
+        memcpy(value, pos, size);
+        pos += size;
+    }
+    int32_t getInt() { int32_t v; raw(&v, sizeof(v)); return v; }
+    float getFloat() { float v; raw(&v, sizeof(v)); return v; }
+    string getString() {
+        int32_t size = getInt();
+        if (!ok || size < 0 || end - pos < size) {
+            ok = false;
+            return string();
+        }
+        string value(pos, size);
+        pos += size;
+        return value;
+    }
+};
+
+bool StudentJournal::open(const char* journalPath) {
+    close();
+    int file = ::open(journalPath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (file < 0) return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0) {
+        ::close(file);
+        return false;
+    }
+    size_t existing = (size_t)info.st_size;
+    if (existing == 0) {
+        if (write(file, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != (ssize_t)sizeof(JOURNAL_MAGIC)) {
+            ::close(file);
+            return false;
+        }
+        fdatasync(file);
+        existing = sizeof(JOURNAL_MAGIC);
+    }
+
+    path = journalPath;
+    fd = file;
+    fileBytes = existing;
+    pending.clear();
+    appendedRecords = durableRecords = 0;
+    stopping = false;
+    writeFailed = false;
+    tornTail = false;
+    flusher = thread(&StudentJournal::flusherLoop, this);
+    return true;
+}
+
+void StudentJournal::close() {
+    if (fd < 0) return;
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wakeFlusher.notify_one();
+    flusher.join();        // The flusher commits what is pending before it exits
+    ::close(fd);
+    fd = -1;
+}
+
+void StudentJournal::flusherLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        wakeFlusher.wait(guard, [this] { return !pending.empty() || stopping; });
+        if (pending.empty()) break;   // Stopping with nothing left to write
+
+        // Take everything appended so far as one group and commit it unlocked,
+        // so new records can pile up for the next group meanwhile
+        string group;
+        group.swap(pending);
+        uint64_t groupEnd = appendedRecords;
+        size_t groupStart = fileBytes;
+        guard.unlock();
+
+        bool ok = !tornTail;
+        size_t written = 0;
+        while (ok && written < group.size()) {
+            ssize_t n = write(fd, group.data() + written, group.size() - written);
+            if (n < 0 && errno == EINTR) continue;   // Interrupted before writing anything
+            if (n < 0) ok = false;
+            else written += (size_t)n;
+        }
+        if (ok && fdatasync(fd) != 0) ok = false;
+
+        // Replay stops at the first torn record, so a failed group is cut off
+        // again. If that fails too, nothing more is written: later records
+        // would follow the torn one and never be replayed.
+        if (!ok && !tornTail && (ftruncate(fd, (off_t)groupStart) != 0 || fdatasync(fd) != 0)) {
+            tornTail = true;
+        }
+
+        guard.lock();
+        if (ok) fileBytes += written;
+        durableRecords = groupEnd;
+        if (!ok) writeFailed = true;
+        committed.notify_all();
+    }
+}
+
+bool StudentJournal::sync() {
+    if (fd < 0) return false;
+    unique_lock<mutex> guard(lock);
+    uint64_t target = appendedRecords;
+    wakeFlusher.notify_one();
+    committed.wait(guard, [this, target] { return durableRecords >= target; });
+    return !writeFailed;
+}
+
+size_t StudentJournal::size() {
+    lock_guard<mutex> guard(lock);
+    return fileBytes + pending.size();
+}
+
+bool StudentJournal::hasRecords() {
+    lock_guard<mutex> guard(lock);
+    return fileBytes + pending.size() > sizeof(JOURNAL_MAGIC);
+}
+
+bool StudentJournal::rotate(const char* oldPath) {
+    if (fd < 0) return false;
+    string current = path;
+    sync();
+    close();
+    if (rename(current.c_str(), oldPath) != 0) {
+        open(current.c_str());   // Keep journaling into the old file
+        return false;
+    }
+    return open(current.c_str());
+}
+
+void StudentJournal::append(JournalRecordType type, const string& payload) {
+    if (fd < 0) return;
+
+    string record;
+    record.reserve(payload.size() + 9);
+    putInt(record, (int32_t)payload.size());
+    record.push_back((char)type);
+    record.append(payload);
+    uint32_t crc = crc32(record.data() + 4, payload.size() + 1);
+    putRaw(record, &crc, sizeof(crc));
+
+    {
+        lock_guard<mutex> guard(lock);
+        pending.append(record);
+        appendedRecords++;
+    }
+    wakeFlusher.notify_one();
+}
+
+void encodeStudentImage(string& out, const StudentStore& store, int index) {
+    const Student& s = store[index];
+    const Course* courses = store.courses(index);
+    const int* studyPlan = store.studyPlan(index);
+
+    putInt(out, s.id);
+    putFloat(out, s.gpa);
+    putString(out, s.name);
+    putString(out, s.nationalId);
+    putInt(out, s.numCourses);
+    for (int i = 0; i < s.numCourses; i++) {
+        putString(out, courses[i].name());
+        putFloat(out, courses[i].grade);
+    }
+    putInt(out, s.numStudyPlan);
+    for (int i = 0; i < s.numStudyPlan; i++) putString(out, courseNames.view(studyPlan[i]));
+}
+
+void StudentJournal::logStudent(JournalRecordType type, const StudentStore& store, int index) {
+    string payload;
+    encodeStudentImage(payload, store, index);
+    append(type, payload);
+}
+
+void StudentJournal::logDelete(int id) {
+    string payload;
+    putInt(payload, id);
+    append(JOURNAL_DELETE, payload);
+}
+
+bool decodeStudentImage(const char* data, size_t size, StudentImage& image) {
+    PayloadReader in{ data, data + size };
+    Student& s = image.student;
+    s.id = in.getInt();
+    s.gpa = in.getFloat();
+    s.name = in.getString();
+    s.nationalId = in.getString();
+    int numCourses = in.getInt();
+    if (!in.ok || numCourses < 0 || numCourses > (in.end - in.pos) / 8) return false;
+    image.courses.resize(numCourses);   // Names are interned once the image is applied
+    for (pair<string, float>& c : image.courses) {
+        c.first = in.getString();
+        c.second = in.getFloat();
+        if (!in.ok) return false;
+    }
+    int numStudyPlan = in.getInt();
+    if (!in.ok || numStudyPlan < 0 || numStudyPlan > (in.end - in.pos) / 4) return false;
+    image.studyPlan.resize(numStudyPlan);
+    for (string& entry : image.studyPlan) {
+        entry = in.getString();
+        if (!in.ok) return false;
+    }
+    return in.ok && in.pos == in.end;
+}
+
+int applyStudentImage(StudentStore& store, const StudentImage& image) {
+    // Upsert: replace whatever the store holds for this ID
+    const Student& s = image.student;
+    int index = store.find(s.id);
+    int keptCourses = 0, keptPlan = 0;
+    if (index == -1) {
+        index = store.add(s);
+    } else {
+        if (store[index].name != s.name) store.setName(index, s.name);
+        if (store[index].nationalId != s.nationalId) store.setNationalId(index, s.nationalId);
+
+        // Courses that stay in place are only regraded: removing one takes
+        // the student off the course's roster, which costs a scan of it
+        int numCourses = min(store[index].numCourses, (int)image.courses.size());
+        while (keptCourses < numCourses &&
+               store.courses(index)[keptCourses].name() == image.courses[keptCourses].first) {
+            keptCourses++;
+        }
+        while (store[index].numCourses > keptCourses) store.removeCourse(index, store[index].numCourses - 1);
+        for (int c = 0; c < keptCourses; c++) {
+            if (store.courses(index)[c].grade != image.courses[c].second) {
+                store.setCourseGrade(index, c, image.courses[c].second);
+            }
+        }
+        int numPlan = min(store[index].numStudyPlan, (int)image.studyPlan.size());
+        while (keptPlan < numPlan && store.studyPlanEntry(index, keptPlan) == image.studyPlan[keptPlan]) keptPlan++;
+        while (store[index].numStudyPlan > keptPlan) store.removeStudyPlanEntry(index, store[index].numStudyPlan - 1);
+    }
+    for (size_t c = keptCourses; c < image.courses.size(); c++) {
+        store.addCourse(index, Course(image.courses[c].first, image.courses[c].second));
+    }
+    for (size_t p = keptPlan; p < image.studyPlan.size(); p++) store.addStudyPlanEntry(index, image.studyPlan[p]);
+    store.setGpa(index, s.gpa);   // Exactly as recorded, after the courses updated it
+    return index;
+}
+
+/**
+ * Apply one record to the store, returns false if the payload is malformed
+ */
+static bool applyRecord(JournalRecordType type, const char* payload, size_t size, StudentStore& store) {
+    if (type == JOURNAL_DELETE) {
+        PayloadReader in{ payload, payload + size };
+        int id = in.getInt();
+        if (!in.ok) return false;
+        int index = store.find(id);
+        if (index != -1) store.remove(index);
+        return true;
+    }
+    if (type < JOURNAL_ADD || type > JOURNAL_EDIT) return false;
+
+    // After image: decode completely before touching the store
+    StudentImage image;
+    if (!decodeStudentImage(payload, size, image)) return false;
+    applyStudentImage(store, image);
+    return true;
+}
+
+/**
+ * Whether a byte range holds nothing but zeros (a tail the file system
+ * extended but never filled)
+ */
+static bool allZero(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != 0) return false;
+    }
+    return true;
+}
+
+int replayJournal(const char* journalPath, StudentStore& store, JournalDamage& damage) {
+    damage = JournalDamage();
+    MappedFile file;
+    if (!file.open(journalPath)) return -1;
+
+    const char* data = file.data();
+    size_t size = file.size();
+    size_t valid = 0;
+    int applied = 0;
+    bool torn = true;   // Whether whatever follows the valid records is an unfinished write
+
+    if (size >= sizeof(JOURNAL_MAGIC) && memcmp(data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0) {
+        valid = sizeof(JOURNAL_MAGIC);
+        while (size - valid >= 9) {
+            int32_t length;
+            memcpy(&length, data + valid, sizeof(length));
+            if (length >= 0 && size - valid - 9 < (size_t)length) break;   // Record runs past the end
+
+            // A bad record is a torn tail only if nothing but zeros follows it
+            size_t end = length < 0 ? size : valid + 9 + length;
+            torn = allZero(data + end, size - end);
+            if (length < 0) break;
+
+            const char* body = data + valid + 4;   // Type byte followed by payload
+            uint32_t crc;
+            memcpy(&crc, body + 1 + length, sizeof(crc));
+            if (crc != crc32(body, length + 1)) break;               // Corrupt record
+
+            // A record of an unknown kind is never torn, it may be from a newer version
+            torn = true;
+            if (!applyRecord((JournalRecordType)(unsigned char)body[0], body + 1, length, store)) {
+                torn = false;
+                break;
+            }
+            applied++;
+            valid += 9 + length;
+        }
+    } else {
+        // Only a header cut short while the file was created is torn
+        torn = size < sizeof(JOURNAL_MAGIC) && memcmp(data, JOURNAL_MAGIC, size) == 0;
+    }
+
+    file.close();
+    damage.discarded = size - valid;
+    if (valid == size) return applied;
+    if (torn) {
+        // Cut off the torn tail so appends stay readable
+        int result = truncate(journalPath, valid);
+        (void)result;   // On failure the tail is skipped again at the next replay
+        return applied;
+    }
+
+    // Anything else may still be worth recovering by hand: keep the file
+    // under a name that is not taken yet instead of cutting it
+    damage.corrupt = true;
+    string aside = string(journalPath) + ".corrupt";
+    for (int n = 1; access(aside.c_str(), F_OK) == 0; n++) {
+        aside = string(journalPath) + ".corrupt." + to_string(n);
+    }
+    if (rename(journalPath, aside.c_str()) == 0) damage.movedTo = aside;
+    return applied;
+}
@@ -0,0 +1,122 @@
+/**
+ * student_journal.h - Append-only write-ahead journal for the student store
+ *
+ * Every change to the store is appended to the journal as one binary record.
+ * Records that change a student carry the complete new state of that student
+ * (its "after image"), and deletions carry the ID, so replaying a record a
+ * second time leaves the store unchanged. That makes it safe to replay a
+ * journal on top of a snapshot that may already contain some of its records.
+ *
+ * File layout (native byte order):
+ *   header:  8-byte magic "SISJRNL1"
+ *   record:  u32 payload length, u8 type, payload, u32 CRC-32 of type+payload
+ *
+ * A background thread writes appended records in groups and makes each group
+ * durable with a single fdatasync (group commit).
+ */
+
+#ifndef STUDENT_JOURNAL_H
+#define STUDENT_JOURNAL_H
+
+#include "student.h"             // Include student structure definitions
+#include <mutex>                 // Include for the journal lock
+#include <condition_variable>    // Include for waking the flusher
+#include <thread>                // Include for the flusher thread
+#include <cstdint>               // Include for fixed-width integers
+
+/**
+ * Kinds of journal records
+ */
+enum JournalRecordType : uint8_t {
+    JOURNAL_ADD = 1,             // Student added (after image)
+    JOURNAL_DELETE = 2,          // Student deleted (ID only)
+    JOURNAL_MODIFY = 3,          // Name, national ID or GPA changed (after image)
+    JOURNAL_COURSE_ADD = 4,      // Course added (after image)
+    JOURNAL_COURSE_REMOVE = 5,   // Course removed (after image)
+    JOURNAL_PLAN_CHANGE = 6,     // Study plan entry added or removed (after image)
+    JOURNAL_EDIT = 7             // Courses and study plan replaced at once (after image)
+};
+
+/**
+ * StudentJournal - Appends records and commits them in groups
+ */
+class StudentJournal {
+public:
+    StudentJournal() {}
+    ~StudentJournal() { close(); }
+    StudentJournal(const StudentJournal&) = delete;
+    StudentJournal& operator=(const StudentJournal&) = delete;
+
+    bool open(const char* path);    // Open for appending (created if missing)
+    void close();                   // Commit pending records and stop the flusher
+    bool isOpen() const { return fd >= 0; }
+
+    void logStudent(JournalRecordType type, const StudentStore& store, int index);
+    void logDelete(int id);
+
+    bool sync();                    // Block until every appended record is durable; false once a group was lost
+    size_t size();                  // Bytes in the file plus bytes not yet written
+    bool hasRecords();              // Whether anything follows the file header
+
+    // Commit everything, move the file to oldPath and continue in a fresh file
+    bool rotate(const char* oldPath);
+
+private:
+    void append(JournalRecordType type, const string& payload);
+    void flusherLoop();             // Body of the group-commit thread
+
+    string path;                    // Path of the journal file
+    int fd = -1;                    // Descriptor of the journal file
+
+    mutex lock;                     // Guards everything below
+    size_t fileBytes = 0;           // Bytes already written to the file
+    condition_variable wakeFlusher; // Signalled when records are pending or on close
+    condition_variable committed;   // Signalled after each durable group
+    string pending;                 // Encoded records not yet written
+    uint64_t appendedRecords = 0;   // Number of records appended so far
+    uint64_t durableRecords = 0;    // Number of records known to be on disk
+    bool stopping = false;          // Asks the flusher to exit
+    bool writeFailed = false;       // Set when a write or fdatasync fails; the group is lost
+    bool tornTail = false;          // A failed group could not be cut off; nothing more is written
+    thread flusher;                 // Group-commit thread
+};
+
+/**
+ * Decoded after image of a student
+ */
+struct StudentImage {
+    Student student;                        // ID, GPA, name and national ID
+    vector<pair<string, float>> courses;    // Course names and grades, in slot order
+    vector<string> studyPlan;               // Study plan entries, in order
+};
+
+// Append the after image of a student to a buffer (the payload of a record)
+void encodeStudentImage(string& out, const StudentStore& store, int index);
+
+// Decode an after image that fills a byte range exactly; false if malformed
+bool decodeStudentImage(const char* data, size_t size, StudentImage& image);
+
+// Replace whatever a store holds for the image's ID with the image (or add
+// the student), returns the student's index
+int applyStudentImage(StudentStore& store, const StudentImage& image);
+
+// CRC-32 (IEEE) of a byte range; also protects the sections of binary snapshots
+uint32_t crc32(const char* data, size_t size);
+
+/**
+ * Bytes of a journal that replay could not use
+ */
+struct JournalDamage {
+    size_t discarded = 0;   // Bytes after the last record applied
+    bool corrupt = false;   // Whether they were more than a torn tail
+    string movedTo;         // Where a corrupt journal was set aside, empty if it could not be moved
+};
+
+// Apply a journal to a store. Returns the number of records applied, or -1 if
+// the file does not exist. A torn tail (an unfinished last write) is cut off,
+// so the next append starts right after the last valid record. A file with an
+// unknown header or a bad record before its end is left whole and renamed to
+// path.corrupt instead; the records before the bad one are still applied.
+int replayJournal(const char* path, StudentStore& store, JournalDamage& damage);
+
+#endif // STUDENT_JOURNAL_H
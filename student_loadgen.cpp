@@ -0,0 +1,280 @@
+/**
+ * Student Information System - Load Generator for student_server
+ *
+ *   student_loadgen [socket] [clients] [seconds] [subscribers]
+ *
+ * Opens clients (300 by default) that each add students of their own, then
+ * for the given time (10 s) keep one request at a time in flight: fetching
+ * (50%), searching (20%) and regrading (30%) their students. At the end
+ * they delete what they added. Subscribers (none by default) only subscribe
+ * and take in the changes, like idle console and ncurses clients. Reports
+ * the request rate and latencies. The students added have IDs from
+ * 900000000 up, which the server must not hold already.
+ */
+
+#include "student.h"            // Include student structure definitions
+#include "student_protocol.h"   // Include the server protocol
+#include <iostream>             // Include for console output
+#include <iomanip>              // Include for output formatting
+#include <chrono>               // Include for latencies
+#include <random>               // Include for the request mix
+#include <cerrno>               // Include for errno
+#include <cstdlib>              // Include for atoi
+#include <fcntl.h>              // Include for non-blocking sockets
+#include <sys/epoll.h>          // Include for waiting on all clients
+#include <sys/socket.h>         // Include for sockets
+#include <sys/un.h>             // Include for Unix-domain addresses
+#include <unistd.h>             // Include for close
+
+// Not used here; the protocol module links against the store modules
+StudentStore students;
+
+static const int STUDENTS_PER_CLIENT = 20;
+static const int FIRST_ID = 900000000;
+
+typedef chrono::steady_clock Clock;
+
+enum LoadPhase { PHASE_ADD, PHASE_MIX, PHASE_DELETE, PHASE_DONE };
+
+/**
+ * One connection of the load generator
+ */
+struct LoadClient {
+    int fd = -1;
+    bool subscriber = false;
+    LoadPhase phase = PHASE_ADD;
+    int step = 0;                   // Student the add or delete phase is at
+    uint8_t kind = 0;               // Request in flight
+    Clock::time_point sentAt;
+    string in;                      // Received bytes not handled yet
+    string out;                     // Request bytes not sent yet
+    size_t sent = 0;
+};
+
+/**
+ * Counts per request kind
+ */
+struct LoadStats {
+    long long requests = 0;
+    long long errors = 0;
+    vector<float> latencies;        // Microseconds
+};
+
+static int connectTo(const char* path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) return -1;
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Queue the next request of a client, or mark it done
+ */
+static void nextRequest(LoadClient& c, int number, bool timeUp, mt19937& random) {
+    int firstId = FIRST_ID + number * STUDENTS_PER_CLIENT;
+    if (c.phase == PHASE_ADD && c.step == STUDENTS_PER_CLIENT) c.phase = PHASE_MIX;
+    if (c.phase == PHASE_MIX && timeUp) {
+        c.phase = PHASE_DELETE;
+        c.step = 0;
+    }
+    if (c.phase == PHASE_DELETE && c.step == STUDENTS_PER_CLIENT) c.phase = PHASE_DONE;
+    if (c.phase == PHASE_DONE) return;
+
+    uint32_t tag = (uint32_t)c.step + 1;
+    if (c.phase == PHASE_ADD) {
+        FrameWriter out(c.out, REQUEST_ADD, tag);
+        out.putInt(firstId + c.step);
+        out.putString("Loadgen " + to_string(number) + " Student " + to_string(c.step));
+        out.putString("29901010100000");
+        out.finish();
+        c.kind = REQUEST_ADD;
+        c.step++;
+    } else if (c.phase == PHASE_DELETE) {
+        FrameWriter out(c.out, REQUEST_DELETE, tag);
+        out.putInt(firstId + c.step);
+        out.finish();
+        c.kind = REQUEST_DELETE;
+        c.step++;
+    } else {
+        int id = firstId + (int)(random() % STUDENTS_PER_CLIENT);
+        int pick = (int)(random() % 10);
+        if (pick < 5) {
+            FrameWriter out(c.out, REQUEST_GET, tag);
+            out.putInt(id);
+            out.finish();
+            c.kind = REQUEST_GET;
+        } else if (pick < 7) {
+            FrameWriter out(c.out, REQUEST_SEARCH, tag);
+            out.putString("Loadgen " + to_string(number) + " ");
+            out.putInt(0);
+            out.putInt(10);
+            out.finish();
+            c.kind = REQUEST_SEARCH;
+        } else {
+            FrameWriter out(c.out, REQUEST_SET_GRADE, tag);
+            out.putInt(id);
+            out.putString(random() % 2 ? "Load Testing" : "Capacity Planning");
+            out.putFloat((float)(random() % 101));
+            out.finish();
+            c.kind = REQUEST_SET_GRADE;
+        }
+    }
+    c.sentAt = Clock::now();
+}
+
+static bool flushOutput(LoadClient& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    c.out.clear();
+    c.sent = 0;
+    return true;
+}
+
+static const char* requestName(int kind) {
+    switch (kind) {
+        case REQUEST_SUBSCRIBE: return "subscribe";
+        case REQUEST_ADD: return "add";
+        case REQUEST_GET: return "get";
+        case REQUEST_SEARCH: return "search";
+        case REQUEST_SET_GRADE: return "set grade";
+        case REQUEST_DELETE: return "delete";
+        default: return "other";
+    }
+}
+
+static float percentile(vector<float>& sorted, double p) {
+    if (sorted.empty()) return 0.0f;
+    return sorted[min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+/**
+ * Main function - runs the load and prints the report
+ */
+int main(int argc, char* argv[]) {
+    const char* path = argc > 1 ? argv[1] : SERVER_SOCKET_FILENAME;
+    int numClients = argc > 2 ? atoi(argv[2]) : 300;
+    int seconds = argc > 3 ? atoi(argv[3]) : 10;
+    int numSubscribers = argc > 4 ? atoi(argv[4]) : 0;
+    if (argc > 5 || numClients < 1 || seconds < 1 || numSubscribers < 0) {
+        cout << "Usage: " << argv[0] << " [socket] [clients] [seconds] [subscribers]\n";
+        return 2;
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    vector<LoadClient> clients(numClients + numSubscribers);
+    mt19937 random(12345);
+    for (int i = 0; i < (int)clients.size(); i++) {
+        LoadClient& c = clients[i];
+        c.fd = connectTo(path);
+        if (c.fd < 0) {
+            cout << "Error: Could not connect to " << path << ": " << strerror(errno) << ".\n";
+            return 1;
+        }
+        fcntl(c.fd, F_SETFL, O_NONBLOCK);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, c.fd, &event);
+        c.subscriber = i >= numClients;
+        if (c.subscriber) {
+            FrameWriter out(c.out, REQUEST_SUBSCRIBE, 1);
+            out.finish();
+            c.kind = REQUEST_SUBSCRIBE;
+            c.phase = PHASE_MIX;
+            c.sentAt = Clock::now();
+        } else {
+            nextRequest(c, i, false, random);
+        }
+        flushOutput(c);
+    }
+
+    LoadStats stats[REQUEST_EDIT + 1];
+    long long pushes = 0;
+    int active = numClients;
+    Clock::time_point start = Clock::now();
+    Clock::time_point mixStart = start, mixEnd = start;
+    bool mixStarted = false, timeUp = false;
+    long long mixRequests = 0;
+    epoll_event events[256];
+    char chunk[65536];
+
+    while (active > 0) {
+        int ready = epoll_wait(epollFd, events, 256, 100);
+        Clock::time_point now = Clock::now();
+        if (!timeUp && now - start >= chrono::seconds(seconds)) {
+            timeUp = true;
+            mixEnd = now;
+        }
+        for (int e = 0; e < ready; e++) {
+            LoadClient& c = clients[events[e].data.u32];
+            int number = (int)events[e].data.u32;
+            if (c.fd < 0) continue;
+            ssize_t n;
+            while ((n = recv(c.fd, chunk, sizeof(chunk), 0)) > 0) c.in.append(chunk, n);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                cout << "Error: The server closed a connection.\n";
+                return 1;
+            }
+
+            size_t used = 0;
+            Frame frame;
+            while (parseFrame(c.in.data() + used, c.in.size() - used, frame) == 1) {
+                used += frame.frameBytes;
+                if (frame.tag == 0) {
+                    pushes++;
+                    continue;
+                }
+                // The reply to the request in flight
+                LoadStats& s = stats[c.kind];
+                s.requests++;
+                if (frame.kind != MSG_OK) s.errors++;
+                s.latencies.push_back(chrono::duration<float, micro>(now - c.sentAt).count());
+                if (c.subscriber) continue;
+                if (c.phase == PHASE_MIX) {
+                    if (!mixStarted) {
+                        mixStarted = true;
+                        mixStart = now;
+                    }
+                    if (!timeUp) mixRequests++;
+                }
+                nextRequest(c, number, timeUp, random);
+                if (c.phase == PHASE_DONE) active--;
+                else if (!flushOutput(c)) return 1;
+            }
+            c.in.erase(0, used);
+        }
+    }
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+    double mixSeconds = chrono::duration<double>(mixEnd - mixStart).count();
+    for (LoadClient& c : clients) close(c.fd);
+
+    cout << numClients << " clients, " << numSubscribers << " subscribers, " << fixed << setprecision(1)
+         << elapsed << " s\n";
+    cout << "Request      Count    Errors   p50 us   p99 us   max us\n";
+    for (int kind = 0; kind <= REQUEST_EDIT; kind++) {
+        LoadStats& s = stats[kind];
+        if (s.requests == 0) continue;
+        sort(s.latencies.begin(), s.latencies.end());
+        cout << left << setw(12) << requestName(kind) << right << setw(7) << s.requests << setw(10) << s.errors
+             << setw(9) << (int)percentile(s.latencies, 0.50) << setw(9) << (int)percentile(s.latencies, 0.99)
+             << setw(9) << (int)s.latencies.back() << "\n";
+    }
+    cout << "Mixed requests: " << setprecision(0) << (mixSeconds > 0 ? mixRequests / mixSeconds : 0.0) << "/s\n";
+    if (numSubscribers > 0) cout << "Students pushed to subscribers: " << pushes << "\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * Student Name Index Module
+ *
+ * This file contains the case-insensitive gram index used to search
+ * students by name, and the store's ranked name search built on it.
+ */
+
+#include "student.h"   // Include student structure definitions
+#include <algorithm>   // Include for sort, unique and partial_sort
+#include <cctype>      // Include for tolower and isalnum
+#include <utility>     // Include for as_const
+
+static unsigned char lowerChar(char c) {
+    return (unsigned char)tolower((unsigned char)c);
+}
+
+static bool isWordStart(const string& name, size_t position) {
+    return position == 0 || !isalnum((unsigned char)name[position - 1]);
+}
+
+static uint32_t trigramKey(unsigned char a, unsigned char b, unsigned char c) {
+    return (uint32_t)a << 16 | (uint32_t)b << 8 | c;
+}
+
+void StudentNameIndex::gramsOf(const string& name, vector<uint32_t>& grams) {
+    grams.clear();
+    for (size_t i = 0; i < name.size(); i++) {
+        if (i + 2 < name.size()) {
+            grams.push_back(trigramKey(lowerChar(name[i]), lowerChar(name[i + 1]), lowerChar(name[i + 2])));
+        }
+    }
+    sort(grams.begin(), grams.end());
+    grams.erase(unique(grams.begin(), grams.end()), grams.end());
+}
+
+void StudentNameIndex::insert(int entry, const string& name) {
+    static thread_local vector<uint32_t> grams;
+    gramsOf(name, grams);
+    for (uint32_t gram : grams) postings[gram].push_back(entry);
+    livePostings += grams.size();
+}
+
+void StudentNameIndex::erase(const string& name) {
+    static thread_local vector<uint32_t> grams;
+    gramsOf(name, grams);
+    livePostings -= grams.size();
+    stalePostings += grams.size();
+}
+
+void StudentNameIndex::clear() {
+    postings.clear();
+    livePostings = 0;
+    stalePostings = 0;
+}
+
+const vector<int>* StudentNameIndex::candidates(const string& loweredQuery) const {
+    const string& q = loweredQuery;
+    if (q.size() < 3) return nullptr;
+
+    // Every trigram of the query must occur in a match, so the rarest one bounds the candidates
+    const vector<int>* best = nullptr;
+    for (size_t i = 0; i + 2 < q.size(); i++) {
+        auto found = postings.find(trigramKey(q[i], q[i + 1], q[i + 2]));
+        if (found == postings.end()) return nullptr;
+        if (best == nullptr || found->second.size() < best->size()) best = &found->second;
+    }
+    return best;
+}
+
+size_t StudentNameIndex::memoryUsage() const {
+    size_t bytes = postings.bucket_count() * sizeof(void*);
+    for (const auto& gram : postings) {
+        bytes += sizeof(gram) + 2 * sizeof(void*) + gram.second.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+int StudentNameIndex::matchRank(const string& name, const string& loweredQuery) {
+    const string& q = loweredQuery;
+    if (q.size() > name.size()) return -1;
+    int best = -1;
+    for (size_t i = 0; i + q.size() <= name.size(); i++) {
+        size_t k = 0;
+        while (k < q.size() && lowerChar(name[i + k]) == (unsigned char)q[k]) k++;
+        if (k < q.size()) continue;
+
+        int rank;
+        if (i == 0) rank = q.size() == name.size() ? 0 : 1;
+        else rank = isWordStart(name, i) ? 2 : 3;
+        if (best == -1 || rank < best) best = rank;
+        if (best <= 2) break;   // Later occurrences cannot start the name
+    }
+    return best;
+}
+
+void StudentStore::rebuildNameIndex() {
+    nameIndex.clear();
+    for (const Student& s : records) nameIndex.insert(s.handleEntry, s.name);
+    nameIndexReady = true;
+}
+
+int StudentStore::searchNames(const string& query, int offset, int limit, vector<int>& indices) {
+    if (!nameIndexReady || nameIndex.wantsRebuild()) rebuildNameIndex();
+    return std::as_const(*this).searchNames(query, offset, limit, indices);
+}
+
+int StudentStore::searchNames(const string& query, int offset, int limit, vector<int>& indices) const {
+    indices.clear();
+
+    string lowered(query.size(), '\0');
+    for (size_t i = 0; i < query.size(); i++) lowered[i] = (char)lowerChar(query[i]);
+
+    // Verify the candidates against the current names; stale postings drop out here
+    struct Match {
+        int rank;
+        int index;
+    };
+    vector<Match> matches;
+    if (lowered.empty()) {
+        matches.reserve(records.size());
+        for (int i = 0; i < (int)records.size(); i++) matches.push_back(Match{ 1, i });
+    } else if (lowered.size() < 3) {
+        // Too short for a trigram; the grams of one or two characters would
+        // post nearly every name, so every name is checked instead
+        for (int i = 0; i < (int)records.size(); i++) {
+            int rank = StudentNameIndex::matchRank(records[i].name, lowered);
+            if (rank != -1) matches.push_back(Match{ rank, i });
+        }
+    } else if (const vector<int>* entries = nameIndex.candidates(lowered)) {
+        for (int entry : *entries) {
+            int index = handleSlots[entry];
+            if (index == -1) continue;
+            int rank = StudentNameIndex::matchRank(records[index].name, lowered);
+            if (rank != -1) matches.push_back(Match{ rank, index });
+        }
+        // A reused handle entry can be posted twice under the same gram
+        std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.index < b.index; });
+        matches.erase(unique(matches.begin(), matches.end(),
+                             [](const Match& a, const Match& b) { return a.index == b.index; }),
+                      matches.end());
+    }
+
+    int total = (int)matches.size();
+    if (offset < 0) offset = 0;
+    if (limit < 0 || offset >= total) return total;
+    int end = min(total, offset + limit);
+
+    auto better = [this](const Match& a, const Match& b) {
+        if (a.rank != b.rank) return a.rank < b.rank;
+        const Student& x = records[a.index];
+        const Student& y = records[b.index];
+        if (x.name != y.name) return x.name < y.name;
+        return x.id < y.id;
+    };
+    partial_sort(matches.begin(), matches.begin() + end, matches.end(), better);
+    for (int i = offset; i < end; i++) indices.push_back(matches[i].index);
+    return total;
+}
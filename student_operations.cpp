@@ -1,13 +1,24 @@
 #include "student.h"
+#include "student_query.h"
+#include "student_analytics.h"
+#include "grade_import.h"
+#include "student_export.h"
+#include "student_client.h"
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <cctype>
 
 int findStudentById(int id) {
-    for(int i = 0; i < numStudents; i++) {
-        if(students[i].id == id) return i;
-    }
-    return -1;
+    return students.find(id);
+}
+
+void findStudentsById(const vector<int>& ids, vector<int>& indices) {
+    students.findBatch(ids, indices);
+}
+
+int deleteStudentsById(const vector<int>& ids) {
+    return students.removeBatch(ids);
 }
 
 bool validateNationalId(const string& nationalId) {
@@ -18,11 +29,6 @@ bool validateNationalId(const string& nationalId) {
 }
 
 void addStudent() {
-    if(numStudents >= MAX_STUDENTS) {
-        cout << "Maximum students reached!\n";
-        return;
-    }
-
     Student newStudent;
     cout << "Enter Student ID: ";
     cin >> newStudent.id;
@@ -45,7 +51,11 @@ void addStudent() {
     newStudent.gpa = 0.0;
     newStudent.numStudyPlan = 0;
 
-    students[numStudents++] = newStudent;
+    string error;
+    if(!addStudentRecord(newStudent, error)) {
+        cout << error << "!\n";
+        return;
+    }
     cout << "Student added successfully!\n";
 }
 
@@ -70,11 +80,11 @@ void deleteStudent() {
         return;
     }
 
-    // Shift remaining elements
-    for(int i = index; i < numStudents-1; i++) {
-        students[i] = students[i+1];
+    string error;
+    if(!removeStudentRecord(index, error)) {
+        cout << error << "!\n";
+        return;
     }
-    numStudents--;
     cout << "Student deleted successfully!\n";
 }
 
@@ -94,7 +104,11 @@ void modifyStudent() {
     cout << "Current name: " << s.name << "\nEnter new name (or press enter to keep): ";
     string newName;
     getline(cin, newName);
-    if(!newName.empty()) s.name = newName;
+    string error;
+    if(!newName.empty() && !setStudentName(index, newName, error)) {
+        cout << error << "!\n";
+        return;
+    }
 
     string newNationalId;
     do {
@@ -103,7 +117,10 @@ void modifyStudent() {
         getline(cin, newNationalId);
         if(newNationalId.empty()) break;
         if(validateNationalId(newNationalId)) {
-            s.nationalId = newNationalId;
+            if(!setStudentNationalId(index, newNationalId, error)) {
+                cout << error << "!\n";
+                return;
+            }
             break;
         }
         cout << "Invalid national ID format!\n";
@@ -136,228 +153,529 @@ void searchStudent() {
         string name;
         cout << "Enter student name (or part of name): ";
         getline(cin, name);
-        bool found = false;
-        
-        for(int i = 0; i < numStudents; i++) {
-            // Case-insensitive search
-            string studentNameLower = students[i].name;
-            string searchNameLower = name;
-            transform(studentNameLower.begin(), studentNameLower.end(), studentNameLower.begin(), ::tolower);
-            transform(searchNameLower.begin(), searchNameLower.end(), searchNameLower.begin(), ::tolower);
-            
-            if(studentNameLower.find(searchNameLower) != string::npos) {
+
+        // Best matches first, one page at a time
+        const int pageSize = 10;
+        vector<int> page;
+        for(int offset = 0; ; offset += pageSize) {
+            int total = students.searchNames(name, offset, pageSize, page);
+            if(total == 0) {
+                cout << "No matching students found!\n";
+                break;
+            }
+            cout << "Showing " << offset + 1 << "-" << offset + (int)page.size()
+                 << " of " << total << " matching students:\n\n";
+            for(int i : page) {
                 cout << "ID: " << students[i].id << "\nName: " << students[i].name 
                      << "\nNational ID: " << students[i].nationalId 
                      << "\nNumber of Courses: " << students[i].numCourses
                      << "\nGPA: " << fixed << setprecision(2) << students[i].gpa << " / 4.00\n\n";
-                found = true;
             }
+            if(offset + pageSize >= total) break;
+
+            string more;
+            cout << "Enter n for the next page, anything else to stop: ";
+            getline(cin, more);
+            if(more != "n" && more != "N") break;
         }
-        if(!found) cout << "No matching students found!\n";
     } else {
         cout << "Invalid choice!\n";
     }
 }
 
-void displayStudents(bool sortedById) {
-    if(numStudents == 0) {
-        cout << "No students to display!\n";
+void queryStudents() {
+    cout << "Conditions joined by \"and\", for example:\n"
+         << "  gpa < 2.0 and course = Mathematics\n"
+         << "  courses = 0 and plan > 0\n"
+         << "Fields: id, name, nationalid, gpa, courses, plan, course, grade, grade(<course>)\n"
+         << "Operators: = != < <= > >= and ~ (name contains)\n"
+         << "Enter query: ";
+    string text;
+    getline(cin, text);
+
+    StudentQuery query;
+    string error;
+    if(!query.parse(text, error)) {
+        cout << "Invalid query: " << error << "\n";
         return;
     }
+    QueryPlan plan = query.plan(students);
+    cout << "Plan: " << plan.describe() << "\n";
+    cout << "----------------------------------------\n";
+    cout << "ID\tName\t\t\tCourses\tGPA\n";
+    cout << "----------------------------------------\n";
 
-    // Create a temporary array for sorting
-    Student tempStudents[MAX_STUDENTS];
-    copy(students, students + numStudents, tempStudents);
+    // Results are printed as they are found, pausing after every page
+    const int pageSize = 20;
+    int shown = 0;
+    query.run(students, plan, [&shown, pageSize](int index) {
+        const Student& s = students[index];
+        cout << s.id << "\t" << s.name << (s.name.length() < 8 ? "\t\t\t" : s.name.length() < 16 ? "\t\t" : "\t")
+             << s.numCourses << "\t" << fixed << setprecision(2) << s.gpa << "\n";
+        if(++shown % pageSize != 0) return true;
+        string more;
+        cout << "Enter n for more results, anything else to stop: ";
+        getline(cin, more);
+        return more == "n" || more == "N";
+    });
+    cout << "----------------------------------------\n";
+    cout << shown << (shown == 1 ? " student" : " students") << " shown.\n";
+}
 
-    if(sortedById) {
-        sort(tempStudents, tempStudents + numStudents, 
-            [](const Student& a, const Student& b) { return a.id < b.id; });
-        cout << "\nStudent List (Sorted by ID):\n";
-    } else {
-        sort(tempStudents, tempStudents + numStudents, 
-            [](const Student& a, const Student& b) { return a.name < b.name; });
-        cout << "\nStudent List (Sorted by Name):\n";
+void showCohortStatistics() {
+    if(students.empty()) {
+        cout << "No students to analyze!\n";
+        return;
+    }
+    CohortReport report = analyzeCohort(students);
+
+    cout << "\nCohort Statistics\n";
+    cout << "----------------------------------------\n";
+    cout << "Students: " << report.students << " (" << report.gpa.count << " with courses)\n";
+    if(report.gpa.count > 0) {
+        cout << fixed << setprecision(2)
+             << "GPA mean " << report.gpa.mean() << ", min " << report.gpa.min << ", max " << report.gpa.max << "\n";
+        cout << "Percentiles:";
+        for(int p = 0; p < NUM_GPA_PERCENTILES; p++) {
+            cout << "  " << (int)(GPA_PERCENTILES[p] * 100 + 0.5) << "%: " << report.gpaPercentiles[p];
+        }
+        cout << "\n";
+
+        // Bars are scaled so the largest bin is 40 characters wide
+        int largest = *max_element(report.gpaHistogram, report.gpaHistogram + GPA_HISTOGRAM_BINS);
+        for(int b = 0; b < GPA_HISTOGRAM_BINS; b++) {
+            int bar = (int)((long long)report.gpaHistogram[b] * 40 / max(largest, 1));
+            cout << setprecision(1) << b * 0.5 << "-" << (b == GPA_HISTOGRAM_BINS - 1 ? 4.0 : (b + 1) * 0.5)
+                 << "\t" << string(bar, '#') << " " << report.gpaHistogram[b] << "\n";
+        }
+    }
+
+    const CourseCatalog& catalog = students.courseCatalog();
+    const int courseRows = 20;
+    cout << "----------------------------------------\n";
+    cout << "Course\t\t\tGrades\tMean\tMedian\tFail %\n";
+    cout << "----------------------------------------\n";
+    for(int i = 0; i < (int)report.courses.size() && i < courseRows; i++) {
+        const CourseStatistics& c = report.courses[i];
+        string name(catalog.name(c.course));
+        cout << name << (name.length() < 8 ? "\t\t\t" : name.length() < 16 ? "\t\t" : "\t")
+             << c.grades << "\t" << fixed << setprecision(1) << c.mean << "\t" << c.median << "\t"
+             << c.failRate * 100 << "\n";
+    }
+    if((int)report.courses.size() > courseRows) {
+        cout << report.courses.size() - courseRows << " more courses\n";
+    }
+
+    cout << "----------------------------------------\n";
+    cout << "Top students\nID\tName\t\t\tGPA\n";
+    for(int index : report.topStudents) {
+        const Student& s = students[index];
+        cout << s.id << "\t" << s.name << (s.name.length() < 8 ? "\t\t\t" : s.name.length() < 16 ? "\t\t" : "\t")
+             << fixed << setprecision(2) << s.gpa << "\n";
+    }
+    cout << "----------------------------------------\n";
+    cout << "Computed in " << setprecision(1) << report.seconds * 1000 << " ms.\n";
+}
+
+void rankStudents() {
+    int choice, count;
+    cout << "Rank by GPA:\n1. Top students (dean's list)\n2. Bottom students (probation list)\nEnter choice: ";
+    cin >> choice;
+    if(choice != 1 && choice != 2) {
+        cout << "Invalid choice!\n";
+        cin.ignore();
+        return;
+    }
+    cout << "Number of students: ";
+    cin >> count;
+    cin.ignore();
+    string courseName;
+    cout << "Course (or press enter for all students): ";
+    getline(cin, courseName);
+
+    int course = GpaRanking::OVERALL;
+    if(!courseName.empty()) {
+        course = students.courseCatalog().find(courseName);
+        if(course == -1) {
+            cout << "Course not found!\n";
+            return;
+        }
+    }
+    vector<int> ranked;
+    int total = choice == 1 ? students.topStudents(course, count, ranked)
+                            : students.bottomStudents(course, count, ranked);
+    cout << "----------------------------------------\n";
+    cout << "Rank\tID\tName\t\t\tGPA\n";
+    cout << "----------------------------------------\n";
+    for(int i = 0; i < (int)ranked.size(); i++) {
+        const Student& s = students[ranked[i]];
+        cout << (choice == 1 ? i + 1 : total - i) << "\t" << s.id << "\t" << s.name
+             << (s.name.length() < 8 ? "\t\t\t" : s.name.length() < 16 ? "\t\t" : "\t")
+             << fixed << setprecision(2) << s.gpa << "\n";
+    }
+    cout << "----------------------------------------\n";
+    cout << ranked.size() << " of " << total << " ranked students shown.\n";
+}
+
+void importGrades() {
+    cout << "Each sheet is a CSV file of student_id,grade rows for the course it is named after\n"
+         << "(for example Mathematics.csv).\n"
+         << "Grade sheet files, separated by commas: ";
+    string line;
+    getline(cin, line);
+
+    vector<GradeSheet> sheets;
+    size_t start = 0;
+    while(start <= line.size()) {
+        size_t comma = line.find(',', start);
+        if(comma == string::npos) comma = line.size();
+        string path = line.substr(start, comma - start);
+        path.erase(0, path.find_first_not_of(" \t"));
+        path.erase(path.find_last_not_of(" \t") + 1);
+        if(!path.empty()) sheets.push_back(GradeSheet{ path, "" });
+        start = comma + 1;
+    }
+    if(sheets.empty()) {
+        cout << "No grade sheets given!\n";
+        return;
+    }
+
+    GradeImportReport report;
+    string error;
+    if(!importStudentGrades(sheets, report, error)) {
+        cout << error << "!\n";
+        return;
+    }
+    const int shownErrors = 10;
+    for(size_t i = 0; i < sheets.size(); i++) {
+        const GradeSheetResult& sheet = report.sheets[i];
+        if(!sheet.opened) {
+            cout << sheets[i].path << ": cannot open file\n";
+            continue;
+        }
+        cout << sheets[i].path << " (" << sheet.course << "): " << sheet.imported << " of "
+             << sheet.rows << " rows imported\n";
+        for(int e = 0; e < (int)sheet.rejected.size() && e < shownErrors; e++) {
+            cout << "  line " << sheet.rejected[e].line << ": " << sheet.rejected[e].message << "\n";
+        }
+        if(sheet.rejectedRows > shownErrors) {
+            cout << "  " << sheet.rejectedRows - shownErrors << " more rejected rows\n";
+        }
+    }
+    cout << report.studentsUpdated << (report.studentsUpdated == 1 ? " student" : " students")
+         << " updated in " << fixed << setprecision(2) << report.seconds << " s.\n";
+}
+
+void exportStudentData() {
+    int choice;
+    cout << "Export format:\n1. CSV\n2. JSON Lines\n3. Columnar (binary)\nEnter choice: ";
+    cin >> choice;
+    cin.ignore();
+    if(choice < 1 || choice > NUM_EXPORT_FORMATS) {
+        cout << "Invalid choice!\n";
+        return;
+    }
+    ExportFormat format = (ExportFormat)(choice - 1);
+    string defaultPath = string("students") + makeExportWriter(format)->extension();
+    string path;
+    cout << "File name (or press enter for " << defaultPath << "): ";
+    getline(cin, path);
+    if(path.empty()) path = defaultPath;
+    string answer;
+    cout << "Export in the background? (y/n): ";
+    getline(cin, answer);
+
+    // A background export works on a copy of the store as it is now
+    if(!answer.empty() && tolower(answer[0]) == 'y') {
+        if(startBackgroundExport(path.c_str(), students, format)) {
+            cout << "Exporting to " << path << " in the background.\n";
+            return;
+        }
+        cout << "Could not start a background export, exporting now.\n";
+    }
+    ExportReport report = exportStudents(path.c_str(), students, format);
+    if(!report.ok) {
+        cout << "Error: " << report.error << "\n";
+        return;
+    }
+    cout << report.students << (report.students == 1 ? " student" : " students") << " exported to " << path
+         << " (" << report.bytes << " bytes) in " << fixed << setprecision(2) << report.seconds << " s.\n";
+}
+
+void reportBackgroundExports(bool wait) {
+    vector<FinishedExport> finished;
+    finishedBackgroundExports(wait, finished);
+    for(const FinishedExport& e : finished) {
+        if(e.ok) cout << "Background export to " << e.path << " finished.\n";
+        else cout << "Error: Background export to " << e.path << " failed.\n";
+    }
+}
+
+void displayStudents(bool sortedById) {
+    if(students.empty()) {
+        cout << "No students to display!\n";
+        return;
     }
 
+    // The store keeps both orders current, so nothing is sorted here
+    StudentOrderView order = students.ordered(sortedById ? ORDER_BY_ID : ORDER_BY_NAME);
+    cout << (sortedById ? "\nStudent List (Sorted by ID):\n" : "\nStudent List (Sorted by Name):\n");
+
     // Print table header
     cout << "----------------------------------------\n";
     cout << "ID\tName\t\t\tNational ID\tGPA\n";
     cout << "----------------------------------------\n";
     
-    for(int i = 0; i < numStudents; i++) {
-        cout << tempStudents[i].id << "\t";
+    for(int i = 0; i < students.size(); i++) {
+        const Student& s = students[order[i]];
+        cout << s.id << "\t";
         
         // Ensure proper formatting for name (adjust tabs based on name length)
-        if(tempStudents[i].name.length() < 8)
-            cout << tempStudents[i].name << "\t\t\t";
-        else if(tempStudents[i].name.length() < 16)
-            cout << tempStudents[i].name << "\t\t";
+        if(s.name.length() < 8)
+            cout << s.name << "\t\t\t";
+        else if(s.name.length() < 16)
+            cout << s.name << "\t\t";
         else
-            cout << tempStudents[i].name << "\t";
+            cout << s.name << "\t";
             
-        cout << tempStudents[i].nationalId << "\t"
-             << fixed << setprecision(2) << tempStudents[i].gpa << "\n";
+        cout << s.nationalId << "\t"
+             << fixed << setprecision(2) << s.gpa << "\n";
     }
     cout << "----------------------------------------\n";
-    cout << "Total students: " << numStudents << "\n";
+    cout << "Total students: " << students.size() << "\n";
+}
+
+/**
+ * Save the changes of a course or study plan session, all at once; returns
+ * whether there were changes and they were saved
+ */
+static bool saveEdit(const StudentEdit& edit) {
+    if(edit.empty()) {
+        cout << "Returning to main menu.\n";
+        return false;
+    }
+    string error;
+    if(!commitStudentEdit(edit, error)) {
+        cout << error << "! No changes were saved.\n";
+        return false;
+    }
+    cout << "Changes saved.\n";
+    return true;
 }
 
 void manageCourses(int index) {
     Student& s = students[index];
+    StudentEdit edit(students, index);   // Nothing changes until the changes are saved
     int choice;
     
     do {
-        cout << "\nCourse Management for " << s.name << "\n";
-        cout << "1. Add Course\n2. Remove Course\n3. View Courses\n4. Back\nChoice: ";
+        cout << "\nCourse Management for " << s.name << (edit.empty() ? "" : " (unsaved changes)") << "\n";
+        cout << "1. Add Course\n2. Remove Course\n3. View Courses\n4. Save and Back\n5. Discard and Back\nChoice: ";
         cin >> choice;
         cin.ignore();
 
         switch(choice) {
             case 1:
-                if(s.numCourses >= MAX_COURSES) {
+                if((int)edit.courses().size() >= MAX_COURSES) {
                     cout << "Maximum courses reached!\n";
                     break;
                 }
-                cout << "Enter course name: ";
-                getline(cin, s.courses[s.numCourses].name);
-                
-                do {
-                    cout << "Enter grade (0-100): ";
-                    cin >> s.courses[s.numCourses].grade;
-                    cin.ignore();
+                {
+                    string courseName;
+                    float grade;
+                    cout << "Enter course name: ";
+                    getline(cin, courseName);
+                    
+                    do {
+                        cout << "Enter grade (0-100): ";
+                        cin >> grade;
+                        cin.ignore();
+                        
+                        if(grade < 0 || grade > 100) {
+                            cout << "Invalid grade! Must be between 0 and 100.\n";
+                        } else {
+                            break;
+                        }
+                    } while(true);
                     
-                    if(s.courses[s.numCourses].grade < 0 || s.courses[s.numCourses].grade > 100) {
-                        cout << "Invalid grade! Must be between 0 and 100.\n";
-                    } else {
+                    string error;
+                    if(!edit.addCourse(Course(courseName, grade), error)) {
+                        cout << error << "!\n";
                         break;
                     }
-                } while(true);
-                
-                s.numCourses++;
-                computeGPA(index);
+                }
                 cout << "Course added!\n";
                 break;
                 
             case 2:
-                if(s.numCourses == 0) {
+                if(edit.courses().empty()) {
                     cout << "No courses to remove!\n";
                     break;
                 }
                 cout << "Courses:\n";
-                for(int i = 0; i < s.numCourses; i++) {
-                    cout << i+1 << ". " << s.courses[i].name 
-                         << " (" << s.courses[i].grade << ")\n";
+                for(int i = 0; i < (int)edit.courses().size(); i++) {
+                    cout << i+1 << ". " << edit.courses()[i].name() 
+                         << " (" << edit.courses()[i].grade << ")\n";
                 }
                 int courseIndex;
                 cout << "Enter course number to remove: ";
                 cin >> courseIndex;
-                if(courseIndex < 1 || courseIndex > s.numCourses) {
+                if(courseIndex < 1 || courseIndex > (int)edit.courses().size()) {
                     cout << "Invalid selection!\n";
                     break;
                 }
-                for(int i = courseIndex-1; i < s.numCourses-1; i++) {
-                    s.courses[i] = s.courses[i+1];
+                {
+                    string error;
+                    if(!edit.removeCourse(courseIndex-1, error)) {
+                        cout << error << "!\n";
+                        break;
+                    }
                 }
-                s.numCourses--;
-                computeGPA(index);
                 cout << "Course removed!\n";
                 break;
                 
             case 3:
-                if(s.numCourses == 0) {
+                if(edit.courses().empty()) {
                     cout << "No courses registered for " << s.name << ".\n";
                     break;
                 }
                 
                 cout << "\nCourses for " << s.name << ":\n";
                 cout << "--------------------------------------\n";
-                cout << "No.\tCourse Name\tGrade\tGPA Scale\n";
+                cout << "No.\tCourse Name\tGrade\tGPA Scale\tClass Average\n";
                 cout << "--------------------------------------\n";
-                for(int i = 0; i < s.numCourses; i++) {
-                    cout << i+1 << ".\t" << s.courses[i].name << "\t\t" 
-                         << s.courses[i].grade << "\t"
-                         << fixed << setprecision(2) << convertGradeTo4Scale(s.courses[i].grade) << "\n";
+                {
+                    // Class averages are the saved ones; a course nobody takes yet has none
+                    const CourseCatalog& catalog = students.courseCatalog();
+                    for(int i = 0; i < (int)edit.courses().size(); i++) {
+                        const Course& c = edit.courses()[i];
+                        int course = catalog.find(c.nameId);
+                        cout << i+1 << ".\t" << c.name() << "\t\t" 
+                             << c.grade << "\t"
+                             << fixed << setprecision(2) << convertGradeTo4Scale(c.grade) << "\t\t";
+                        if(course == -1) cout << "-\n";
+                        else cout << catalog.averageGrade(course) << "\n";
+                    }
                 }
                 cout << "--------------------------------------\n";
-                cout << "Cumulative GPA: " << fixed << setprecision(2) << s.gpa << " / 4.00\n";
+                cout << "Cumulative GPA: " << fixed << setprecision(2) << edit.gpa() << " / 4.00\n";
                 break;
                 
             case 4:
-                cout << "Returning to main menu.\n";
+                if(saveEdit(edit)) computeGPA(index);   // Once for the whole session
+                break;
+                
+            case 5:
+                edit.abort();
+                cout << "Changes discarded.\n";
                 break;
                 
             default:
                 cout << "Invalid choice!\n";
         }
-    } while(choice != 4);
+    } while(choice != 4 && choice != 5);
+}
+
+/**
+ * Cross-check a study plan entry (a name ID) against the course catalog:
+ * whether the courses include it, and otherwise how many students take it
+ */
+string studyPlanStatus(const Course* courses, int numCourses, int entry) {
+    const CourseCatalog& catalog = students.courseCatalog();
+    int course = catalog.find(entry);
+    if(course == -1) return "no student takes this course";
+
+    // Interned names compare by the ID of their lowercase spelling
+    for(int c = 0; c < numCourses; c++) {
+        if(courseNames.folded(courses[c].nameId) == courseNames.folded(entry)) return "already taken";
+    }
+    int enrolled = (int)catalog.enrolled(course).size();
+    return to_string(enrolled) + (enrolled == 1 ? " student takes it" : " students take it");
 }
 
 void updateStudyPlan(int index) {
     Student& s = students[index];
+    StudentEdit edit(students, index);   // Nothing changes until the changes are saved
     int choice;
     
     do {
-        cout << "\nStudy Plan Management for " << s.name << "\n";
-        cout << "1. Add Course to Plan\n2. Remove Course from Plan\n3. View Plan\n4. Back\nChoice: ";
+        cout << "\nStudy Plan Management for " << s.name << (edit.empty() ? "" : " (unsaved changes)") << "\n";
+        cout << "1. Add Course to Plan\n2. Remove Course from Plan\n3. View Plan\n4. Save and Back\n5. Discard and Back\nChoice: ";
         cin >> choice;
         cin.ignore();
 
         switch(choice) {
             case 1:
-                if(s.numStudyPlan >= MAX_STUDY_PLAN) {
+                if((int)edit.plan().size() >= MAX_STUDY_PLAN) {
                     cout << "Study plan is full!\n";
                     break;
                 }
-                cout << "Enter course name for study plan: ";
-                getline(cin, s.studyPlan[s.numStudyPlan]);
-                s.numStudyPlan++;
+                {
+                    string entry;
+                    cout << "Enter course name for study plan: ";
+                    getline(cin, entry);
+                    string error;
+                    if(!edit.addPlanEntry(entry, error)) {
+                        cout << error << "!\n";
+                        break;
+                    }
+                }
                 cout << "Course added to study plan!\n";
                 break;
                 
             case 2:
-                if(s.numStudyPlan == 0) {
+                if(edit.plan().empty()) {
                     cout << "Study plan is empty!\n";
                     break;
                 }
                 cout << "Study Plan:\n";
-                for(int i = 0; i < s.numStudyPlan; i++) {
-                    cout << i+1 << ". " << s.studyPlan[i] << "\n";
+                for(int i = 0; i < (int)edit.plan().size(); i++) {
+                    cout << i+1 << ". " << edit.planEntry(i) << "\n";
                 }
                 int planIndex;
                 cout << "Enter item number to remove: ";
                 cin >> planIndex;
-                if(planIndex < 1 || planIndex > s.numStudyPlan) {
+                if(planIndex < 1 || planIndex > (int)edit.plan().size()) {
                     cout << "Invalid selection!\n";
                     break;
                 }
-                for(int i = planIndex-1; i < s.numStudyPlan-1; i++) {
-                    s.studyPlan[i] = s.studyPlan[i+1];
+                {
+                    string error;
+                    if(!edit.removePlanEntry(planIndex-1, error)) {
+                        cout << error << "!\n";
+                        break;
+                    }
                 }
-                s.numStudyPlan--;
                 cout << "Course removed from study plan!\n";
                 break;
                 
             case 3:
-                if(s.numStudyPlan == 0) {
+                if(edit.plan().empty()) {
                     cout << "Study plan is empty for " << s.name << ".\n";
                     break;
                 }
                 
                 cout << "\nStudy Plan for " << s.name << ":\n";
                 cout << "------------------------\n";
-                for(int i = 0; i < s.numStudyPlan; i++) {
-                    cout << i+1 << ". " << s.studyPlan[i] << "\n";
+                for(int i = 0; i < (int)edit.plan().size(); i++) {
+                    cout << i+1 << ". " << edit.planEntry(i) << " ("
+                         << studyPlanStatus(edit.courses().data(), (int)edit.courses().size(), edit.plan()[i]) << ")\n";
                 }
                 cout << "------------------------\n";
-                cout << "Total courses in plan: " << s.numStudyPlan << "\n";
+                cout << "Total courses in plan: " << edit.plan().size() << "\n";
                 break;
                 
             case 4:
-                cout << "Returning to main menu.\n";
+                saveEdit(edit);
+                break;
+                
+            case 5:
+                edit.abort();
+                cout << "Changes discarded.\n";
                 break;
                 
             default:
                 cout << "Invalid choice!\n";
         }
-    } while(choice != 4);
+    } while(choice != 4 && choice != 5);
 }
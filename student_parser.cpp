@@ -0,0 +1,333 @@
+/**
+ * Student Parser Module
+ *
+ * This file contains the memory-mapped, zero-copy parser for the
+ * students.txt format written by saveStudents().
+ */
+
+#include "student_parser.h"   // Include parser declarations
+#include <charconv>           // Include for from_chars
+#include <cstring>            // Include for memchr
+#include <fcntl.h>            // Include for open
+#include <sys/mman.h>         // Include for mmap
+#include <sys/stat.h>         // Include for fstat
+#include <unistd.h>           // Include for close
+#include <utility>            // Include for std::move
+#include <thread>             // Include for parallel chunk loading
+#include <functional>         // Include for std::ref
+#include <unordered_map>      // Include for numbering course names per chunk
+
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length > 0) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(address, length, MADV_SEQUENTIAL);   // The parser reads front to back
+        bytes = (const char*)address;
+        mapped = true;
+    } else {
+        bytes = "";   // Empty files cannot be mapped
+    }
+    ::close(fd);      // The mapping stays valid after closing the descriptor
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) munmap((void*)bytes, length);
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+/**
+ * Cursor over the fields of one line
+ */
+struct LineCursor {
+    const char* pos;   // Next unread character
+    const char* end;   // End of the line (excluding the newline)
+
+    bool atEnd() const { return pos >= end; }
+
+    // Read up to the next delimiter (or the end of the line) and skip the delimiter
+    string_view field(char delimiter) {
+        const char* stop = (const char*)memchr(pos, delimiter, end - pos);
+        if (stop == nullptr) stop = end;
+        string_view result(pos, stop - pos);
+        pos = stop < end ? stop + 1 : end;
+        return result;
+    }
+
+    // Read everything that is left on the line
+    string_view rest() {
+        string_view result(pos, end - pos);
+        pos = end;
+        return result;
+    }
+};
+
+/**
+ * Parse a whole field as an integer
+ */
+static bool parseInt(string_view text, int& value) {
+    const char* last = text.data() + text.size();
+    from_chars_result result = from_chars(text.data(), last, value);
+    return result.ec == errc() && result.ptr == last;
+}
+
+/**
+ * Parse a whole field as a float; an empty field counts as zero
+ */
+static bool parseFloat(string_view text, float& value) {
+    if (text.empty()) {
+        value = 0.0f;
+        return true;
+    }
+    const char* last = text.data() + text.size();
+    from_chars_result result = from_chars(text.data(), last, value);
+    return result.ec == errc() && result.ptr == last;
+}
+
+/**
+ * Parse one line into out, or describe why it is malformed
+ */
+static bool parseLine(LineCursor cursor, int lineNumber, ParsedFile& out, string& error) {
+    ParsedStudent s;
+    s.line = lineNumber;
+    s.firstCourse = (int)out.courses.size();
+    s.firstPlanEntry = (int)out.studyPlan.size();
+
+    if (!parseInt(cursor.field(','), s.id)) {
+        error = "invalid student ID";
+        return false;
+    }
+    s.name = cursor.field(',');
+    s.nationalId = cursor.field(',');
+
+    // Courses: count, then name:grade pairs
+    if (!parseInt(cursor.field(','), s.numCourses) || s.numCourses < 0) {
+        error = "invalid course count";
+        return false;
+    }
+    for (int i = 0; i < s.numCourses; i++) {
+        ParsedCourse course;
+        course.name = cursor.field(':');
+        if (course.name.empty() || cursor.atEnd()) {
+            error = "missing course " + to_string(i + 1);
+            return false;
+        }
+        if (!parseFloat(cursor.field(','), course.grade)) {
+            error = "invalid grade for course " + to_string(i + 1);
+            return false;
+        }
+        out.courses.push_back(course);
+    }
+    if (s.numCourses == 0 && cursor.pos < cursor.end && *cursor.pos == ',') {
+        cursor.pos++;   // saveStudents() writes an empty field when there are no courses
+    }
+
+    if (!parseFloat(cursor.field(','), s.gpa)) {
+        error = "invalid GPA";
+        return false;
+    }
+
+    // Study plan: count, then entries; the last entry runs to the end of the line
+    string_view countField = cursor.field(',');
+    s.numStudyPlan = 0;
+    if (!countField.empty() && (!parseInt(countField, s.numStudyPlan) || s.numStudyPlan < 0)) {
+        error = "invalid study plan count";
+        return false;
+    }
+    for (int i = 0; i < s.numStudyPlan; i++) {
+        if (cursor.atEnd()) {
+            error = "missing study plan entry " + to_string(i + 1);
+            return false;
+        }
+        out.studyPlan.push_back(i == s.numStudyPlan - 1 ? cursor.rest() : cursor.field(','));
+    }
+
+    out.students.push_back(s);
+    return true;
+}
+
+int parseStudentBuffer(const char* data, size_t size, int firstLine, ParsedFile& out) {
+    const char* pos = data;
+    const char* end = data + size;
+    int lineNumber = firstLine;
+    string error;
+
+    while (pos < end) {
+        const char* newline = (const char*)memchr(pos, '\n', end - pos);
+        const char* lineEnd = newline ? newline : end;
+        const char* contentEnd = lineEnd;
+        if (contentEnd > pos && contentEnd[-1] == '\r') contentEnd--;   // Tolerate CRLF files
+
+        if (contentEnd > pos) {   // Skip empty lines
+            size_t courseMark = out.courses.size();
+            size_t planMark = out.studyPlan.size();
+            if (!parseLine(LineCursor{pos, contentEnd}, lineNumber, out, error)) {
+                out.courses.resize(courseMark);     // Drop partial results of the line
+                out.studyPlan.resize(planMark);
+                out.errors.push_back(ParseError{lineNumber, error});
+            }
+        }
+
+        pos = lineEnd + 1;
+        lineNumber++;
+    }
+    return lineNumber - firstLine;
+}
+
+/**
+ * One slice of a file, parsed and turned into store-ready records
+ *
+ * The worker that parsed the chunk also builds everything a student needs
+ * in the store: the name strings, the GPA and the course and study plan
+ * blocks. courseNames is not thread-safe, so a chunk numbers its distinct
+ * course names and plan entries itself; the merge interns each of those
+ * once and renumbers the blocks, then appends them to the store in bulk.
+ */
+struct LoadedChunk {
+    const char* begin;           // First byte of the chunk (start of a line)
+    const char* end;             // One past the last byte (after a newline)
+    int numLines = 0;            // Lines in the chunk, for numbering later chunks
+    ParsedFile parsed;           // Parser output with chunk-relative line numbers
+    vector<Student> students;    // Records built from parsed.students
+    vector<Course> courses;      // Course blocks of the students, named by chunk name number
+    vector<int> studyPlan;       // Study plan blocks, by chunk name number
+    vector<string_view> names;   // Distinct course names and plan entries, by chunk name number
+};
+
+/**
+ * Parse a chunk and build its records
+ */
+static void loadChunk(LoadedChunk& chunk) {
+    chunk.numLines = parseStudentBuffer(chunk.begin, chunk.end - chunk.begin, 1, chunk.parsed);
+
+    const ParsedFile& parsed = chunk.parsed;
+    unordered_map<string_view, int> numbers;   // Chunk name number per name
+    auto number = [&](string_view name) {
+        auto inserted = numbers.emplace(name, (int)chunk.names.size());
+        if (inserted.second) chunk.names.push_back(name);
+        return inserted.first->second;
+    };
+
+    chunk.students.resize(parsed.students.size());
+    chunk.courses.resize(parsed.courses.size());
+    chunk.studyPlan.resize(parsed.studyPlan.size());
+    for (size_t i = 0; i < parsed.students.size(); i++) {
+        const ParsedStudent& p = parsed.students[i];
+        Student& s = chunk.students[i];
+        s.id = p.id;
+        s.name.assign(p.name.data(), p.name.size());
+        s.nationalId.assign(p.nationalId.data(), p.nationalId.size());
+        s.numCourses = p.numCourses;
+        s.numStudyPlan = p.numStudyPlan;
+
+        // The GPA is summed in file order, as adding the courses one by one
+        // would; a student without courses keeps the GPA of the file
+        for (int c = p.firstCourse; c < p.firstCourse + p.numCourses; c++) {
+            chunk.courses[c].nameId = number(parsed.courses[c].name);
+            chunk.courses[c].grade = parsed.courses[c].grade;
+            s.gradePoints += convertGradeTo4Scale(parsed.courses[c].grade);
+        }
+        s.gpa = p.numCourses > 0 ? calculateGPA(s.gradePoints, p.numCourses) : p.gpa;
+        for (int e = p.firstPlanEntry; e < p.firstPlanEntry + p.numStudyPlan; e++) {
+            chunk.studyPlan[e] = number(parsed.studyPlan[e]);
+        }
+    }
+}
+
+/**
+ * Split a buffer into about count chunks that each end on a line boundary
+ */
+static vector<LoadedChunk> splitIntoChunks(const char* data, size_t size, int count) {
+    vector<LoadedChunk> chunks;
+    const char* end = data + size;
+    const char* begin = data;
+    for (int i = 1; i <= count && begin < end; i++) {
+        const char* stop = (i == count) ? end : data + size / count * i;
+        if (stop < begin) stop = begin;
+        if (stop < end) {
+            const char* newline = (const char*)memchr(stop, '\n', end - stop);
+            stop = newline ? newline + 1 : end;
+        }
+        LoadedChunk chunk;
+        chunk.begin = begin;
+        chunk.end = stop;
+        chunks.push_back(std::move(chunk));
+        begin = stop;
+    }
+    return chunks;
+}
+
+bool loadStudentsFromFile(const char* path, StudentStore& store, vector<ParseError>& errors,
+                          int threads) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    size_t firstError = errors.size();
+
+    // Small files are not worth the thread start-up cost
+    const size_t minimumChunkBytes = 1 << 20;
+    if (threads < 1) threads = 1;
+    if ((size_t)threads > file.size() / minimumChunkBytes) {
+        threads = max(1, (int)(file.size() / minimumChunkBytes));
+    }
+
+    vector<LoadedChunk> chunks = splitIntoChunks(file.data(), file.size(), threads);
+    if (chunks.size() == 1) {
+        loadChunk(chunks[0]);
+    } else {
+        vector<thread> workers;
+        for (LoadedChunk& chunk : chunks) workers.emplace_back(loadChunk, std::ref(chunk));
+        for (thread& worker : workers) worker.join();
+    }
+
+    // Merge in file order; the ID index catches duplicates across chunks.
+    // Per student this is only copying and the ID index, so the merge is a
+    // small serial part of the load.
+    size_t totalStudents = 0, totalCourses = 0, totalPlan = 0;
+    for (const LoadedChunk& chunk : chunks) {
+        totalStudents += chunk.students.size();
+        totalCourses += chunk.courses.size();
+        totalPlan += chunk.studyPlan.size();
+    }
+    store.reserve(store.size() + (int)totalStudents, (int)totalCourses, (int)totalPlan);
+
+    int lineOffset = 0;
+    vector<int> nameIds, rejected;
+    for (LoadedChunk& chunk : chunks) {
+        for (const ParseError& e : chunk.parsed.errors) {
+            errors.push_back(ParseError{e.line + lineOffset, e.message});
+        }
+        nameIds.resize(chunk.names.size());
+        for (size_t n = 0; n < chunk.names.size(); n++) nameIds[n] = courseNames.intern(chunk.names[n]);
+        for (Course& course : chunk.courses) course.nameId = nameIds[course.nameId];
+        for (int& entry : chunk.studyPlan) entry = nameIds[entry];
+
+        rejected.clear();
+        store.appendBuilt(chunk.students, chunk.courses.data(), chunk.studyPlan.data(), rejected);
+        for (int i : rejected) {
+            const ParsedStudent& p = chunk.parsed.students[i];
+            errors.push_back(ParseError{p.line + lineOffset, "duplicate student ID " + to_string(p.id)});
+        }
+        lineOffset += chunk.numLines;
+    }
+
+    // Report parse errors and duplicates together in line order
+    stable_sort(errors.begin() + firstError, errors.end(),
+                [](const ParseError& a, const ParseError& b) { return a.line < b.line; });
+    return true;
+}
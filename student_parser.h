@@ -0,0 +1,90 @@
+/**
+ * student_parser.h - Zero-copy parser for the students.txt format
+ *
+ * The parser works on a buffer holding the whole file, normally a read-only
+ * memory mapping. Names, national IDs, course names and study plan entries
+ * are returned as views into that buffer, so parsing itself allocates only
+ * for the result arrays. Malformed lines are reported as ParseErrors and
+ * parsing continues with the next line; no exceptions are used.
+ */
+
+#ifndef STUDENT_PARSER_H
+#define STUDENT_PARSER_H
+
+#include "student.h"     // Include student structure definitions
+#include <string_view>   // Include string_view for views into the buffer
+
+/**
+ * A course as it appears in the file
+ */
+struct ParsedCourse {
+    string_view name;    // Course name (view into the buffer)
+    float grade;         // Numeric grade
+};
+
+/**
+ * A student line as it appears in the file
+ */
+struct ParsedStudent {
+    int id;                  // Student ID
+    string_view name;        // Full name (view into the buffer)
+    string_view nationalId;  // National ID (view into the buffer)
+    float gpa;               // GPA stored in the file
+    int line;                // Line number in the file, starting at 1
+    int firstCourse;         // Index of the first course in ParsedFile::courses
+    int numCourses;          // Number of courses
+    int firstPlanEntry;      // Index of the first entry in ParsedFile::studyPlan
+    int numStudyPlan;        // Number of study plan entries
+};
+
+/**
+ * A line that could not be parsed
+ */
+struct ParseError {
+    int line;                // Line number in the file, starting at 1
+    string message;          // What was wrong with the line
+};
+
+/**
+ * Result of parsing a buffer
+ */
+struct ParsedFile {
+    vector<ParsedStudent> students;   // Successfully parsed lines in file order
+    vector<ParsedCourse> courses;     // Courses of all students, back to back
+    vector<string_view> studyPlan;    // Study plan entries of all students, back to back
+    vector<ParseError> errors;        // Lines that were skipped
+};
+
+/**
+ * MappedFile - Read-only memory mapping of a whole file
+ */
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);   // Map a file, returns false if it cannot be opened
+    void close();                  // Unmap the file
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;   // Start of the mapping
+    size_t length = 0;             // Length of the file in bytes
+    bool mapped = false;           // Whether bytes must be unmapped
+};
+
+// Parse every line of a buffer; firstLine is the number of its first line.
+// Returns the number of lines in the buffer.
+int parseStudentBuffer(const char* data, size_t size, int firstLine, ParsedFile& out);
+
+// Load a students file into a store, returns false if the file cannot be opened.
+// With more than one thread the file is split at line boundaries and the chunks
+// are parsed in parallel; records are still added in file order, and duplicate
+// IDs (also across chunks) are reported as errors.
+bool loadStudentsFromFile(const char* path, StudentStore& store, vector<ParseError>& errors,
+                          int threads = 1);
+
+#endif // STUDENT_PARSER_H
@@ -0,0 +1,94 @@
+/**
+ * Student Protocol Module
+ *
+ * This file contains the frame parsing and the encoding of students and
+ * import reports shared by student_server and its clients.
+ */
+
+#include "student_protocol.h"   // Include protocol declarations
+
+void FrameWriter::putStudent(const StudentStore& store, int index) {
+    // Length prefix first, filled in once the image is appended
+    size_t lengthAt = out.size();
+    putInt(0);
+    encodeStudentImage(out, store, index);
+    int32_t length = (int32_t)(out.size() - lengthAt - 4);
+    memcpy(&out[lengthAt], &length, sizeof(length));
+}
+
+int parseFrame(const char* data, size_t size, Frame& frame) {
+    if (size < 4) return 0;
+    uint32_t length;
+    memcpy(&length, data, sizeof(length));
+    if (length < FRAME_HEADER_BYTES - 4 || length > MAX_FRAME_BYTES) return -1;
+    if (size - 4 < length) return 0;
+    frame.kind = (uint8_t)data[4];
+    memcpy(&frame.tag, data + 5, sizeof(frame.tag));
+    frame.payload = data + FRAME_HEADER_BYTES;
+    frame.size = length - (FRAME_HEADER_BYTES - 4);
+    frame.frameBytes = 4 + (size_t)length;
+    return 1;
+}
+
+void putImportReport(FrameWriter& out, const GradeImportReport& report) {
+    out.putInt(report.studentsUpdated);
+    out.putDouble(report.seconds);
+    out.putInt((int32_t)report.sheets.size());
+    for (const GradeSheetResult& sheet : report.sheets) {
+        out.putString(sheet.course);
+        out.putInt(sheet.opened ? 1 : 0);
+        out.putInt(sheet.rows);
+        out.putInt(sheet.imported);
+        out.putInt(sheet.rejectedRows);
+        int listed = min((int)sheet.rejected.size(), MAX_REPORTED_REJECTIONS);
+        out.putInt(listed);
+        for (int i = 0; i < listed; i++) {
+            out.putInt(sheet.rejected[i].line);
+            out.putString(sheet.rejected[i].message);
+        }
+    }
+}
+
+bool getImportReport(FrameReader& in, GradeImportReport& report) {
+    report.studentsUpdated = in.getInt();
+    report.seconds = in.getDouble();
+    int numSheets = in.getInt();
+    if (!in.ok || numSheets < 0 || numSheets > (in.end - in.pos) / 20) return false;
+    report.sheets.resize(numSheets);
+    for (GradeSheetResult& sheet : report.sheets) {
+        sheet.course = string(in.getString());
+        sheet.opened = in.getInt() != 0;
+        sheet.rows = in.getInt();
+        sheet.imported = in.getInt();
+        sheet.rejectedRows = in.getInt();
+        int rejected = in.getInt();
+        if (!in.ok || rejected < 0 || rejected > (in.end - in.pos) / 8) return false;
+        sheet.rejected.resize(rejected);
+        for (ParseError& e : sheet.rejected) {
+            e.line = in.getInt();
+            e.message = string(in.getString());
+        }
+    }
+    return in.atEnd();
+}
+
+void putEditChanges(FrameWriter& out, const vector<EditChange>& changes) {
+    out.putInt((int32_t)changes.size());
+    for (const EditChange& change : changes) {
+        out.putInt(change.step);
+        out.putString(change.name);
+        out.putFloat(change.grade);
+    }
+}
+
+bool getEditChanges(FrameReader& in, vector<EditChange>& changes) {
+    int count = in.getInt();
+    if (!in.ok || count < 0 || count > (in.end - in.pos) / 12) return false;
+    changes.resize(count);
+    for (EditChange& change : changes) {
+        change.step = (EditStep)in.getInt();
+        change.name = string(in.getString());
+        change.grade = in.getFloat();
+    }
+    return in.ok;
+}
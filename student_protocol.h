@@ -0,0 +1,199 @@
+/**
+ * student_protocol.h - Binary protocol between student_server and its clients
+ *
+ * Clients connect to the server's Unix-domain stream socket
+ * (SERVER_SOCKET_FILENAME unless told otherwise). Both directions carry
+ * frames, in native byte order since both ends share the machine:
+ *
+ *   u32 length of the rest, u8 kind, u32 tag, payload
+ *
+ * A request's kind is a ProtocolRequest and its tag any number but 0 chosen
+ * by the client. The reply has the same tag and is MSG_OK with the results
+ * or MSG_ERROR with a message. Clients may send many requests without
+ * waiting; replies come back in request order.
+ *
+ * Payload values: int and float are 4 bytes, double 8, a string is an int
+ * length and the bytes, and a student is a string holding its after image as
+ * in the journal (encodeStudentImage), so a student always travels whole.
+ *
+ *   Request               Payload                  Reply
+ *   SUBSCRIBE             -                        count (see below)
+ *   GET                   id                       student
+ *   SEARCH                query, offset, limit     total, count, count students
+ *                                                  (at most 10000 per reply)
+ *   ADD                   id, name, national ID    student
+ *   DELETE                id                       -
+ *   SET_NAME              id, name                 student
+ *   SET_NATIONAL_ID       id, national ID          student
+ *   ADD_COURSE            id, course, grade        student
+ *   REMOVE_COURSE         id, course               student
+ *   SET_GRADE             id, course, grade        student
+ *   ADD_PLAN_ENTRY        id, entry                student
+ *   REMOVE_PLAN_ENTRY     id, entry                student
+ *   IMPORT_GRADES         count, count             import report (at most
+ *                         (path, course) sheets    1000 rejected rows listed
+ *                                                  per sheet)
+ *   EDIT                  id, count, count         student
+ *                         (step, name, grade)
+ *                         changes
+ *
+ * Courses and plan entries are named: REMOVE_COURSE removes the first slot
+ * with exactly that name and SET_GRADE regrades the first slot with that name
+ * in any case, adding the course if there is none. Grade sheet paths are
+ * opened by the server, so clients send absolute paths. EDIT applies the
+ * changes of a StudentEdit (student_edit.h) all at once or, if one does not
+ * apply, none of them.
+ *
+ * SUBSCRIBE makes the client a mirror: the server first sends MSG_SNAPSHOT
+ * and every student as MSG_CHANGED with tag 0, then the reply with their
+ * count. From then on the client is sent, with tag 0, MSG_CHANGED (a
+ * student) and MSG_DELETED (an ID) for every change that was not its own
+ * request's; a change it asked for comes back in the reply instead (grade
+ * imports are pushed as well). A grade import that updates more than
+ * MAX_CHANGE_PUSHES students sends every subscriber a single MSG_RELOAD
+ * instead, and the client subscribes again when it is ready.
+ */
+
+#ifndef STUDENT_PROTOCOL_H
+#define STUDENT_PROTOCOL_H
+
+#include "student.h"           // Include student structure definitions
+#include "student_journal.h"   // Include the student after images
+#include "grade_import.h"      // Include the import report
+#include "student_edit.h"      // Include the changes of an edit
+#include <cstdint>             // Include for fixed-width integers
+#include <cstring>             // Include for memcpy
+
+const char SERVER_SOCKET_FILENAME[] = "students.sock";   // Default socket of student_server
+const uint32_t MAX_FRAME_BYTES = 64u << 20;             // Longest frame either side accepts
+const size_t FRAME_HEADER_BYTES = 9;                     // Length, kind and tag
+const int MAX_REPORTED_REJECTIONS = 1000;                // Rejected rows listed per sheet in an import report
+const int MAX_CHANGE_PUSHES = 10000;                     // Students a grade import pushes one by one
+
+/**
+ * Requests
+ */
+enum ProtocolRequest : uint8_t {
+    REQUEST_SUBSCRIBE = 1,
+    REQUEST_GET = 2,
+    REQUEST_SEARCH = 3,
+    REQUEST_ADD = 4,
+    REQUEST_DELETE = 5,
+    REQUEST_SET_NAME = 6,
+    REQUEST_SET_NATIONAL_ID = 7,
+    REQUEST_ADD_COURSE = 8,
+    REQUEST_REMOVE_COURSE = 9,
+    REQUEST_SET_GRADE = 10,
+    REQUEST_ADD_PLAN_ENTRY = 11,
+    REQUEST_REMOVE_PLAN_ENTRY = 12,
+    REQUEST_IMPORT_GRADES = 13,
+    REQUEST_EDIT = 14
+};
+
+/**
+ * Server messages
+ */
+enum ProtocolMessage : uint8_t {
+    MSG_OK = 1,          // Reply: the request succeeded
+    MSG_ERROR = 2,       // Reply: the request was refused, payload is the reason
+    MSG_CHANGED = 3,     // Push: a student was added or changed
+    MSG_DELETED = 4,     // Push: a student was deleted, payload is its ID
+    MSG_SNAPSHOT = 5,    // Push: every student follows; forget the ones held
+    MSG_RELOAD = 6       // Push: too many students changed to push them; subscribe again
+};
+
+/**
+ * Appends one frame to a buffer; finish() fills in its length
+ */
+class FrameWriter {
+public:
+    FrameWriter(string& out, uint8_t kind, uint32_t tag) : out(out), start(out.size()) {
+        out.append(4, '\0');
+        out.push_back((char)kind);
+        putRaw(&tag, sizeof(tag));
+    }
+    void putInt(int32_t value) { putRaw(&value, sizeof(value)); }
+    void putFloat(float value) { putRaw(&value, sizeof(value)); }
+    void putDouble(double value) { putRaw(&value, sizeof(value)); }
+    void putString(string_view value) {
+        putInt((int32_t)value.size());
+        out.append(value);
+    }
+    void putStudent(const StudentStore& store, int index);
+    void finish() {
+        uint32_t length = (uint32_t)(out.size() - start - 4);
+        memcpy(&out[start], &length, sizeof(length));
+    }
+
+private:
+    void putRaw(const void* value, size_t size) { out.append((const char*)value, size); }
+
+    string& out;        // Buffer the frame is appended to
+    size_t start;       // Offset of the frame in out
+};
+
+/**
+ * One frame found in a buffer; payload points into the buffer
+ */
+struct Frame {
+    uint8_t kind;
+    uint32_t tag;
+    const char* payload;
+    size_t size;         // Payload bytes
+    size_t frameBytes;   // Bytes of the whole frame, header included
+};
+
+// Find the frame at the start of a buffer. Returns 1 if one is complete, 0
+// if more bytes are needed and -1 if the bytes cannot be a frame.
+int parseFrame(const char* data, size_t size, Frame& frame);
+
+/**
+ * Bounds-checked reader over a frame payload
+ */
+struct FrameReader {
+    const char* pos;
+    const char* end;
+    bool ok = true;
+
+    explicit FrameReader(const Frame& frame) : pos(frame.payload), end(frame.payload + frame.size) {}
+
+    void raw(void* value, size_t size) {
+        if ((size_t)(end - pos) < size) {
+            ok = false;
+            memset(value, 0, size);
+            return;
+        }
+        memcpy(value, pos, size);
+        pos += size;
+    }
+    int32_t getInt() { int32_t v; raw(&v, sizeof(v)); return v; }
+    float getFloat() { float v; raw(&v, sizeof(v)); return v; }
+    double getDouble() { double v; raw(&v, sizeof(v)); return v; }
+    string_view getString() {
+        int32_t size = getInt();
+        if (!ok || size < 0 || end - pos < size) {
+            ok = false;
+            return string_view();
+        }
+        string_view value(pos, size);
+        pos += size;
+        return value;
+    }
+    bool getStudent(StudentImage& image) {
+        string_view bytes = getString();
+        if (ok && !decodeStudentImage(bytes.data(), bytes.size(), image)) ok = false;
+        return ok;
+    }
+    bool atEnd() const { return ok && pos == end; }   // Whether everything was read
+};
+
+// Import reports travel as: students updated, seconds, sheet count, and per
+// sheet its course, opened, rows, imported and rejected (line, message) rows
+void putImportReport(FrameWriter& out, const GradeImportReport& report);
+bool getImportReport(FrameReader& in, GradeImportReport& report);
+
+// Edits travel as their change count and per change its step, name and grade
+void putEditChanges(FrameWriter& out, const vector<EditChange>& changes);
+bool getEditChanges(FrameReader& in, vector<EditChange>& changes);
+
+#endif // STUDENT_PROTOCOL_H
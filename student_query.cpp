@@ -0,0 +1,457 @@
+/**
+ * Student Query Module
+ *
+ * This file contains the parser, planner and executor of the filter
+ * queries described in student_query.h.
+ */
+
+#include "student_query.h"   // Include query declarations
+#include <algorithm>         // Include for min and max
+#include <cctype>            // Include for tolower, isspace and isalpha
+#include <cstdlib>           // Include for strtod
+#include <cstring>           // Include for strlen
+#include <climits>           // Include for INT_MIN and INT_MAX
+#include <thread>            // Include for the parallel scan
+#include <mutex>             // Include for the result queue
+#include <condition_variable> // Include for waiting on results
+#include <atomic>            // Include for the stop flag
+#include <deque>             // Include for the result queue
+
+static const int MIN_PARALLEL_SLICE = 65536;   // Smaller slices do not pay for a thread
+static const size_t RESULT_BATCH = 256;         // Matches a scan thread hands over at once
+
+static string lowercase(const string& text) {
+    string lowered(text);
+    for (char& c : lowered) c = (char)tolower((unsigned char)c);
+    return lowered;
+}
+
+static string trim(const string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * Remove one pair of surrounding double quotes, if present
+ */
+static string unquote(const string& text) {
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') return text.substr(1, text.size() - 2);
+    return text;
+}
+
+/**
+ * Split query text at every "and" that stands alone outside quotes
+ */
+static vector<string> splitClauses(const string& text) {
+    vector<string> parts;
+    string current;
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '"') quoted = !quoted;
+        bool wordStart = i == 0 || isspace((unsigned char)text[i - 1]);
+        if (!quoted && wordStart && i + 3 <= text.size() && lowercase(text.substr(i, 3)) == "and" &&
+            (i + 3 == text.size() || isspace((unsigned char)text[i + 3]))) {
+            parts.push_back(current);
+            current.clear();
+            i += 2;
+            continue;
+        }
+        current += c;
+    }
+    parts.push_back(current);
+    return parts;
+}
+
+template <typename T>
+static bool compareValues(T value, QueryOp op, T operand) {
+    switch (op) {
+        case QUERY_EQ: return value == operand;
+        case QUERY_NE: return value != operand;
+        case QUERY_LT: return value < operand;
+        case QUERY_LE: return value <= operand;
+        case QUERY_GT: return value > operand;
+        case QUERY_GE: return value >= operand;
+        default: return false;
+    }
+}
+
+static bool equalsIgnoreCase(const string& value, const string& lowered) {
+    if (value.size() != lowered.size()) return false;
+    for (size_t i = 0; i < value.size(); i++) {
+        if ((char)tolower((unsigned char)value[i]) != lowered[i]) return false;
+    }
+    return true;
+}
+
+static bool containsIgnoreCase(const string& value, const string& lowered) {
+    if (lowered.size() > value.size()) return false;
+    for (size_t i = 0; i + lowered.size() <= value.size(); i++) {
+        size_t k = 0;
+        while (k < lowered.size() && (char)tolower((unsigned char)value[i + k]) == lowered[k]) k++;
+        if (k == lowered.size()) return true;
+    }
+    return false;
+}
+
+static bool compareText(const string& value, QueryOp op, const string& lowered) {
+    switch (op) {
+        case QUERY_EQ: return equalsIgnoreCase(value, lowered);
+        case QUERY_NE: return !equalsIgnoreCase(value, lowered);
+        case QUERY_CONTAINS: return containsIgnoreCase(value, lowered);
+        default: return false;
+    }
+}
+
+bool StudentQuery::parse(const string& text, string& error) {
+    static const struct { const char* symbol; QueryOp op; } OPERATORS[] = {
+        { "!=", QUERY_NE }, { "<=", QUERY_LE }, { ">=", QUERY_GE },
+        { "=", QUERY_EQ }, { "<", QUERY_LT }, { ">", QUERY_GT }, { "~", QUERY_CONTAINS }
+    };
+
+    clauses.clear();
+    if (trim(text).empty()) {
+        error = "empty query";
+        return false;
+    }
+    for (const string& part : splitClauses(text)) {
+        string clauseText = trim(part);
+        if (clauseText.empty()) {
+            error = "missing condition next to \"and\"";
+            return false;
+        }
+
+        // Field name, with an optional course name in parentheses for grade
+        size_t pos = 0;
+        while (pos < clauseText.size() && isalpha((unsigned char)clauseText[pos])) pos++;
+        string fieldName = lowercase(clauseText.substr(0, pos));
+        QueryClause clause;
+        if (fieldName == "id") clause.field = QUERY_ID;
+        else if (fieldName == "name") clause.field = QUERY_NAME;
+        else if (fieldName == "nationalid") clause.field = QUERY_NATIONAL_ID;
+        else if (fieldName == "gpa") clause.field = QUERY_GPA;
+        else if (fieldName == "courses") clause.field = QUERY_COURSES;
+        else if (fieldName == "plan") clause.field = QUERY_PLAN;
+        else if (fieldName == "course") clause.field = QUERY_COURSE;
+        else if (fieldName == "grade") clause.field = QUERY_GRADE;
+        else {
+            error = "unknown field \"" + clauseText.substr(0, max(pos, (size_t)1)) + "\"";
+            return false;
+        }
+        while (pos < clauseText.size() && isspace((unsigned char)clauseText[pos])) pos++;
+        if (clause.field == QUERY_GRADE && pos < clauseText.size() && clauseText[pos] == '(') {
+            size_t close = clauseText.find(')', pos);
+            if (close == string::npos) {
+                error = "missing \")\" after grade(";
+                return false;
+            }
+            clause.text = lowercase(unquote(trim(clauseText.substr(pos + 1, close - pos - 1))));
+            pos = close + 1;
+            while (pos < clauseText.size() && isspace((unsigned char)clauseText[pos])) pos++;
+        }
+
+        // Operator
+        bool found = false;
+        for (const auto& o : OPERATORS) {
+            if (clauseText.compare(pos, strlen(o.symbol), o.symbol) == 0) {
+                clause.op = o.op;
+                pos += strlen(o.symbol);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            error = "expected an operator after \"" + fieldName + "\"";
+            return false;
+        }
+
+        // Value
+        string value = unquote(trim(clauseText.substr(pos)));
+        if (value.empty()) {
+            error = "missing value in \"" + clauseText + "\"";
+            return false;
+        }
+        bool textField = clause.field == QUERY_NAME || clause.field == QUERY_NATIONAL_ID ||
+                         clause.field == QUERY_COURSE;
+        if (textField) {
+            bool allowed = clause.op == QUERY_EQ || clause.op == QUERY_NE ||
+                           (clause.op == QUERY_CONTAINS && clause.field != QUERY_COURSE);
+            if (!allowed) {
+                error = "operator not supported for \"" + fieldName + "\"";
+                return false;
+            }
+            clause.text = lowercase(value);
+        } else {
+            if (clause.op == QUERY_CONTAINS) {
+                error = "operator ~ needs a text field";
+                return false;
+            }
+            char* end = nullptr;
+            clause.number = strtod(value.c_str(), &end);
+            if (end == value.c_str() || *end != '\0') {
+                error = "expected a number in \"" + clauseText + "\"";
+                return false;
+            }
+        }
+        addClause(clause);
+    }
+    return true;
+}
+
+void StudentQuery::addClause(QueryClause clause) {
+    // A course name is looked up once here, so matching compares it with the
+    // lowercase spelling of each course slot's name as an integer. It is not
+    // interned: the names queried would pile up in courseNames for good, and
+    // a name that was never interned cannot be any student's course.
+    if (clause.field == QUERY_COURSE || (clause.field == QUERY_GRADE && !clause.text.empty())) {
+        clause.nameId = courseNames.find(clause.text);
+        if (clause.nameId == -1) clause.nameId = NO_SUCH_COURSE;
+    }
+    clauses.push_back(clause);
+}
+
+bool StudentQuery::clauseMatches(const QueryClause& clause, const StudentStore& store, int index) const {
+    const Student& s = store[index];
+    switch (clause.field) {
+        case QUERY_ID:
+            return compareValues((double)s.id, clause.op, clause.number);
+        case QUERY_NAME:
+            return compareText(s.name, clause.op, clause.text);
+        case QUERY_NATIONAL_ID:
+            return compareText(s.nationalId, clause.op, clause.text);
+        case QUERY_GPA:   // Compared as stored, so "gpa = 3.33" finds 3.33f
+            return compareValues(s.gpa, clause.op, (float)clause.number);
+        case QUERY_COURSES:
+            return compareValues((double)s.numCourses, clause.op, clause.number);
+        case QUERY_PLAN:
+            return compareValues((double)s.numStudyPlan, clause.op, clause.number);
+        case QUERY_COURSE: {
+            const Course* courses = store.courses(index);
+            bool enrolled = false;
+            for (int c = 0; c < s.numCourses && !enrolled; c++) {
+                enrolled = courseNames.folded(courses[c].nameId) == clause.nameId;
+            }
+            return clause.op == QUERY_EQ ? enrolled : !enrolled;
+        }
+        case QUERY_GRADE: {
+            const Course* courses = store.courses(index);
+            for (int c = 0; c < s.numCourses; c++) {
+                if (clause.nameId != -1 && courseNames.folded(courses[c].nameId) != clause.nameId) continue;
+                if (compareValues(courses[c].grade, clause.op, (float)clause.number)) return true;
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+bool StudentQuery::matches(const StudentStore& store, int index) const {
+    for (const QueryClause& clause : clauses) {
+        if (!clauseMatches(clause, store, index)) return false;
+    }
+    return true;
+}
+
+/**
+ * First position in [0, n) where pred turns false, for pred true on a prefix
+ */
+template <typename Pred>
+static int partitionPoint(int n, Pred pred) {
+    int low = 0, high = n;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (pred(middle)) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+QueryPlan StudentQuery::plan(StudentStore& store) const {
+    QueryPlan best;
+    int n = store.size();
+    best.candidates = n;
+    best.first = 0;
+    best.last = n;
+
+    for (int c = 0; c < (int)clauses.size(); c++) {
+        const QueryClause& clause = clauses[c];
+        QueryPlan option;
+        option.clause = c;
+
+        if (clause.field == QUERY_ID && clause.op == QUERY_EQ) {
+            option.access = QUERY_ACCESS_ID_LOOKUP;
+            int index = -1;
+            // Only a whole number within int range can be an ID, and only such
+            // a number may be converted to int
+            bool isId = clause.number >= INT_MIN && clause.number <= INT_MAX &&
+                        clause.number == (double)(int)clause.number;
+            if (isId) index = store.find((int)clause.number);
+            if (index != -1) option.indices.push_back(index);
+            option.candidates = (int)option.indices.size();
+        } else if ((clause.field == QUERY_ID || clause.field == QUERY_GPA) && clause.op != QUERY_NE) {
+            // Ascending IDs, or descending GPAs: find the positions satisfying the clause
+            bool byId = clause.field == QUERY_ID;
+            StudentOrderView view = store.ordered(byId ? ORDER_BY_ID : ORDER_BY_GPA);
+            auto key = [&](int p) {
+                return byId ? (double)store[view[p]].id : (double)store[view[p]].gpa;
+            };
+            double operand = byId ? clause.number : (double)(float)clause.number;
+            // below(p): key at p sorts before the operand; notAbove(p): key at p does not sort after it
+            auto below = [&](int p) { return byId ? key(p) < operand : key(p) > operand; };
+            auto notAbove = [&](int p) { return byId ? key(p) <= operand : key(p) >= operand; };
+            int lower = partitionPoint(n, below);
+            int upper = partitionPoint(n, notAbove);
+            // Keys in [lower, upper) equal the operand; "sorts before" means smaller ID or larger GPA
+            bool lessOp = clause.op == QUERY_LT || clause.op == QUERY_LE;
+            bool strict = clause.op == QUERY_LT || clause.op == QUERY_GT;
+            if (clause.op == QUERY_EQ) {
+                option.first = lower;
+                option.last = upper;
+            } else if (lessOp == byId) {   // Values before the operand in the order
+                option.first = 0;
+                option.last = strict ? lower : upper;
+            } else {                       // Values after the operand in the order
+                option.first = strict ? upper : lower;
+                option.last = n;
+            }
+            option.access = byId ? QUERY_ACCESS_ID_RANGE : QUERY_ACCESS_GPA_RANGE;
+            option.candidates = option.last - option.first;
+        } else if (clause.field == QUERY_NAME && clause.op != QUERY_NE && clause.text.size() >= 3) {
+            // The name index finds every name containing a query of three or more characters
+            option.access = QUERY_ACCESS_NAME_INDEX;
+            option.candidates = store.searchNames(clause.text, 0, INT_MAX, option.indices);
+        } else if ((clause.field == QUERY_COURSE && clause.op == QUERY_EQ) ||
+                   (clause.field == QUERY_GRADE && !clause.text.empty())) {
+            // Only the students on the course's roster can have a slot with it
+            option.access = QUERY_ACCESS_COURSE_INDEX;
+            int course = clause.nameId == NO_SUCH_COURSE ? -1 : store.courseCatalog().find(clause.nameId);
+            option.candidates = course == -1 ? 0 : store.courseRoster(course, option.indices);
+        } else {
+            continue;
+        }
+        if (best.access == QUERY_ACCESS_SCAN || option.candidates < best.candidates) best = option;
+    }
+
+    // Candidates reached through an index are visited out of memory order, so a
+    // broad index range loses to the sequential (and parallel) scan
+    if (best.access != QUERY_ACCESS_SCAN && best.access != QUERY_ACCESS_ID_LOOKUP &&
+        best.candidates > n / 8) {
+        QueryPlan scan;
+        scan.candidates = n;
+        scan.last = n;
+        return scan;
+    }
+    return best;
+}
+
+string QueryPlan::describe() const {
+    string count = to_string(candidates) + (candidates == 1 ? " student" : " students");
+    switch (access) {
+        case QUERY_ACCESS_ID_LOOKUP: return "ID index lookup (" + count + ")";
+        case QUERY_ACCESS_ID_RANGE: return "range of the ID order (" + count + ")";
+        case QUERY_ACCESS_GPA_RANGE: return "range of the GPA order (" + count + ")";
+        case QUERY_ACCESS_NAME_INDEX: return "name index (" + count + ")";
+        case QUERY_ACCESS_COURSE_INDEX: return "course roster (" + count + ")";
+        default: return "scan of all " + count;
+    }
+}
+
+int StudentQuery::run(StudentStore& store, const function<bool(int)>& emit, int threads) const {
+    return run(store, plan(store), emit, threads);
+}
+
+int StudentQuery::run(StudentStore& store, const QueryPlan& plan, const function<bool(int)>& emit,
+                      int threads) const {
+    int emitted = 0;
+    switch (plan.access) {
+        case QUERY_ACCESS_ID_LOOKUP:
+        case QUERY_ACCESS_NAME_INDEX:
+        case QUERY_ACCESS_COURSE_INDEX:
+            for (int index : plan.indices) {
+                if (!matches(store, index)) continue;
+                emitted++;
+                if (!emit(index)) break;
+            }
+            return emitted;
+        case QUERY_ACCESS_ID_RANGE:
+        case QUERY_ACCESS_GPA_RANGE: {
+            StudentOrderView view = store.ordered(plan.access == QUERY_ACCESS_ID_RANGE ? ORDER_BY_ID : ORDER_BY_GPA);
+            for (int p = plan.first; p < plan.last; p++) {
+                int index = view[p];
+                if (!matches(store, index)) continue;
+                emitted++;
+                if (!emit(index)) break;
+            }
+            return emitted;
+        }
+        default:
+            break;
+    }
+
+    int n = store.size();
+    if (threads < 1) threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(threads, n / MIN_PARALLEL_SLICE));
+    if (threads == 1) {
+        for (int i = 0; i < n; i++) {
+            if (!matches(store, i)) continue;
+            emitted++;
+            if (!emit(i)) break;
+        }
+        return emitted;
+    }
+
+    // Scan threads hand over batches of matches; the calling thread emits them
+    mutex queueLock;
+    condition_variable queueReady;
+    deque<vector<int>> queue;
+    int running = threads;
+    atomic<bool> stop(false);
+    const StudentStore& scanned = store;
+
+    auto scanSlice = [&](int begin, int end) {
+        vector<int> found;
+        auto handOver = [&]() {
+            lock_guard<mutex> guard(queueLock);
+            queue.push_back(std::move(found));
+            found.clear();
+            queueReady.notify_one();
+        };
+        for (int i = begin; i < end && !stop.load(memory_order_relaxed); i++) {
+            if (!matches(scanned, i)) continue;
+            found.push_back(i);
+            if (found.size() >= RESULT_BATCH) handOver();
+        }
+        lock_guard<mutex> guard(queueLock);
+        if (!found.empty()) queue.push_back(std::move(found));
+        running--;
+        queueReady.notify_one();
+    };
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(scanSlice, (int)((long long)n * t / threads), (int)((long long)n * (t + 1) / threads));
+    }
+
+    bool stopped = false;
+    while (!stopped) {
+        vector<int> batch;
+        {
+            unique_lock<mutex> guard(queueLock);
+            queueReady.wait(guard, [&]() { return !queue.empty() || running == 0; });
+            if (queue.empty()) break;
+            batch = std::move(queue.front());
+            queue.pop_front();
+        }
+        for (int index : batch) {
+            emitted++;
+            if (!emit(index)) {
+                stopped = true;
+                stop = true;
+                break;
+            }
+        }
+    }
+    for (thread& worker : workers) worker.join();
+    return emitted;
+}
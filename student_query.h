@@ -0,0 +1,121 @@
+/**
+ * student_query.h - Filter queries over students and their courses
+ *
+ * A query is a conjunction of clauses, written as text such as
+ *   gpa < 2.0 and course = Mathematics
+ *   courses = 0 and plan > 0
+ *   name ~ ali and grade(Physics) >= 90
+ *
+ * Fields and operators:
+ *   id, gpa, courses, plan     = != < <= > >=  (plan and courses count entries)
+ *   name, nationalid           = != ~          (~ is "contains"; case-insensitive)
+ *   course                     = !=            (enrolled / not enrolled; case-insensitive)
+ *   grade, grade(<course>)     = != < <= > >=  (some course, or the named course)
+ * Values containing spaces may be quoted; unquoted values run up to the next
+ * "and". Text values are compared case-insensitively.
+ *
+ * Planning picks the clause whose index yields the fewest candidates: an ID
+ * lookup, a range of the maintained ID or GPA order, the name index, or the
+ * roster of a course (for course = and grade(<course>) clauses). All
+ * clauses are then checked on those candidates. Without a usable index the
+ * store is scanned, in parallel slices for large stores.
+ */
+
+#ifndef STUDENT_QUERY_H
+#define STUDENT_QUERY_H
+
+#include "student.h"    // Include student structure definitions
+#include <functional>   // Include for the result callback
+
+/**
+ * Queryable fields
+ */
+enum QueryField {
+    QUERY_ID,
+    QUERY_NAME,
+    QUERY_NATIONAL_ID,
+    QUERY_GPA,
+    QUERY_COURSES,       // Number of courses
+    QUERY_PLAN,          // Number of study plan entries
+    QUERY_COURSE,        // Enrolled in a course
+    QUERY_GRADE          // Grade of any course, or of the course named in text
+};
+
+/**
+ * Comparison operators
+ */
+enum QueryOp {
+    QUERY_EQ,
+    QUERY_NE,
+    QUERY_LT,
+    QUERY_LE,
+    QUERY_GT,
+    QUERY_GE,
+    QUERY_CONTAINS
+};
+
+const int NO_SUCH_COURSE = -2;   // QueryClause::nameId of a course name no student had
+
+/**
+ * One condition of a query
+ */
+struct QueryClause {
+    QueryField field;
+    QueryOp op;
+    double number = 0.0;   // Value of numeric clauses
+    string text;           // Value of text clauses, lowercased; course name of QUERY_GRADE
+    int nameId = -1;       // ID of text in courseNames, for course clauses (set by addClause);
+                           // NO_SUCH_COURSE if no course was ever named so
+};
+
+/**
+ * How a query reaches its candidates
+ */
+enum QueryAccess {
+    QUERY_ACCESS_SCAN,        // Every student
+    QUERY_ACCESS_ID_LOOKUP,   // One student through the ID index
+    QUERY_ACCESS_ID_RANGE,    // Range of the maintained ID order
+    QUERY_ACCESS_GPA_RANGE,   // Range of the maintained GPA order
+    QUERY_ACCESS_NAME_INDEX,  // Candidates of the name index
+    QUERY_ACCESS_COURSE_INDEX // Roster of one course from the course catalog
+};
+
+struct QueryPlan {
+    QueryAccess access = QUERY_ACCESS_SCAN;
+    int clause = -1;          // Clause that drives the access, -1 for a scan
+    int candidates = 0;       // Students the plan will check
+    int first = 0, last = 0;  // Range positions for the order-based plans
+    vector<int> indices;      // Candidates of the lookup, name and course plans
+
+    string describe() const;  // One-line explanation for the user
+};
+
+/**
+ * StudentQuery - Parsed query that can be planned and run against a store
+ */
+class StudentQuery {
+public:
+    // Parse query text; returns false and describes the problem in error
+    bool parse(const string& text, string& error);
+
+    void addClause(QueryClause clause);   // Append a clause; text must be lowercased
+    const vector<QueryClause>& conditions() const { return clauses; }
+
+    bool matches(const StudentStore& store, int index) const;   // Whether a student satisfies every clause
+    QueryPlan plan(StudentStore& store) const;                  // Cheapest access path
+
+    // Run the query and pass each matching store index to emit as soon as it is
+    // found; emit returns false to stop early. emit is always called on the
+    // calling thread and must not modify the store. Results of a parallel scan
+    // arrive in no particular order. Returns the number of students emitted.
+    int run(StudentStore& store, const function<bool(int)>& emit, int threads = 0) const;
+    int run(StudentStore& store, const QueryPlan& plan, const function<bool(int)>& emit,
+            int threads = 0) const;
+
+private:
+    bool clauseMatches(const QueryClause& clause, const StudentStore& store, int index) const;
+
+    vector<QueryClause> clauses;
+};
+
+#endif // STUDENT_QUERY_H
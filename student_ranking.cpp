@@ -0,0 +1,290 @@
+/**
+ * GPA Ranking Module
+ *
+ * This file contains the GPA rankings, overall and per course, and the store
+ * code that keeps them in step with GPA and enrollment changes.
+ */
+
+#include "student.h"   // Include student structure definitions
+#include <algorithm>   // Include for sort and min
+#include <utility>     // Include for as_const
+
+// Best GPA first, then ascending ID; IDs are unique, so the order is total
+static bool rankedBefore(const GpaRanking::Entry& a, float gpa, int id) {
+    if (a.gpa != gpa) return a.gpa > gpa;
+    return a.id < id;
+}
+
+static size_t lowerBound(const vector<GpaRanking::Entry>& block, float gpa, int id) {
+    size_t low = 0, high = block.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (rankedBefore(block[middle], gpa, id)) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+size_t GpaRanking::Group::blockOf(float gpa, int id) const {
+    size_t low = 0, high = blocks.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (rankedBefore(blocks[middle].back(), gpa, id)) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+void GpaRanking::Group::insert(const Entry& entry) {
+    count++;
+    if (blocks.empty()) {
+        blocks.push_back(vector<Entry>{ entry });
+        return;
+    }
+    size_t b = std::min(blockOf(entry.gpa, entry.id), blocks.size() - 1);  // Past the end joins the last block
+    vector<Entry>& block = blocks[b];
+    block.insert(block.begin() + lowerBound(block, entry.gpa, entry.id), entry);
+    if ((int)block.size() > 2 * BLOCK_SIZE) {
+        // Split a full block in half
+        vector<Entry> upper(block.begin() + BLOCK_SIZE, block.end());
+        block.resize(BLOCK_SIZE);
+        blocks.insert(blocks.begin() + b + 1, std::move(upper));
+    }
+}
+
+bool GpaRanking::Group::erase(float gpa, int id) {
+    size_t b = blockOf(gpa, id);
+    if (b == blocks.size()) return false;
+    vector<Entry>& block = blocks[b];
+    size_t at = lowerBound(block, gpa, id);
+    if (at == block.size() || block[at].id != id) return false;
+    block.erase(block.begin() + at);
+    count--;
+    // Fold small neighbours together so deletions do not leave a trail of tiny blocks
+    if (b + 1 < blocks.size() && (int)(block.size() + blocks[b + 1].size()) <= BLOCK_SIZE) {
+        block.insert(block.end(), blocks[b + 1].begin(), blocks[b + 1].end());
+        blocks.erase(blocks.begin() + b + 1);
+    }
+    if (block.empty()) blocks.erase(blocks.begin() + b);
+    return true;
+}
+
+void GpaRanking::Group::rechunk(vector<Entry>& sorted) {
+    blocks.clear();
+    for (size_t start = 0; start < sorted.size(); start += BLOCK_SIZE) {
+        size_t end = std::min(sorted.size(), start + BLOCK_SIZE);
+        blocks.emplace_back(sorted.begin() + start, sorted.begin() + end);
+    }
+    count = (int)sorted.size();
+}
+
+GpaRanking::Group& GpaRanking::group(int id) {
+    if (id == OVERALL) return overall;
+    if (id >= (int)byCourse.size()) byCourse.resize(id + 1);
+    return byCourse[id];
+}
+
+const GpaRanking::Group* GpaRanking::findGroup(int id) const {
+    if (id == OVERALL) return &overall;
+    return id >= 0 && id < (int)byCourse.size() ? &byCourse[id] : nullptr;
+}
+
+int GpaRanking::size(int id) const {
+    const Group* g = findGroup(id);
+    return g ? g->count : 0;
+}
+
+void GpaRanking::best(int id, int k, vector<int>& handleEntries) const {
+    handleEntries.clear();
+    const Group* g = findGroup(id);
+    if (!g) return;
+    for (const vector<Entry>& block : g->blocks) {
+        for (const Entry& e : block) {
+            if ((int)handleEntries.size() >= k) return;
+            handleEntries.push_back(e.handleEntry);
+        }
+    }
+}
+
+void GpaRanking::worst(int id, int k, vector<int>& handleEntries) const {
+    handleEntries.clear();
+    const Group* g = findGroup(id);
+    if (!g) return;
+    for (auto block = g->blocks.rbegin(); block != g->blocks.rend(); ++block) {
+        for (auto e = block->rbegin(); e != block->rend(); ++e) {
+            if ((int)handleEntries.size() >= k) return;
+            handleEntries.push_back(e->handleEntry);
+        }
+    }
+}
+
+int GpaRanking::position(int id, float gpa, int studentId) const {
+    const Group* g = findGroup(id);
+    if (!g) return -1;
+    size_t b = g->blockOf(gpa, studentId);
+    if (b == g->blocks.size()) return -1;
+    const vector<Entry>& block = g->blocks[b];
+    size_t at = lowerBound(block, gpa, studentId);
+    if (at == block.size() || block[at].id != studentId) return -1;
+    int before = 0;
+    for (size_t i = 0; i < b; i++) before += (int)g->blocks[i].size();
+    return before + (int)at;
+}
+
+void GpaRanking::insert(int id, const Entry& entry) {
+    group(id).insert(entry);
+}
+
+void GpaRanking::erase(int id, float gpa, int studentId) {
+    group(id).erase(gpa, studentId);
+}
+
+void GpaRanking::move(int id, float oldGpa, const Entry& entry) {
+    Group& g = group(id);
+    if (g.erase(oldGpa, entry.id)) g.insert(entry);
+}
+
+void GpaRanking::append(int id, const Entry& entry) {
+    Group& g = group(id);
+    if (g.blocks.empty()) g.blocks.emplace_back();
+    g.blocks.back().push_back(entry);
+    g.count++;
+}
+
+void GpaRanking::sortAll() {
+    auto order = [](const Entry& a, const Entry& b) { return rankedBefore(a, b.gpa, b.id); };
+    auto sortGroup = [&order](Group& g) {
+        vector<Entry> run;
+        run.reserve(g.count);
+        for (const vector<Entry>& block : g.blocks) run.insert(run.end(), block.begin(), block.end());
+        std::sort(run.begin(), run.end(), order);
+        g.rechunk(run);
+    };
+    sortGroup(overall);
+    for (Group& g : byCourse) sortGroup(g);
+}
+
+void GpaRanking::withdrawAll(const vector<char>& leaving, const vector<int>& slots) {
+    auto gone = [&](const Entry& e) { return leaving[slots[e.handleEntry]] != 0; };
+    auto filter = [&gone](Group& g) {
+        vector<Entry> run;
+        run.reserve(g.count);
+        for (const vector<Entry>& block : g.blocks) {
+            for (const Entry& e : block) {
+                if (!gone(e)) run.push_back(e);
+            }
+        }
+        if ((int)run.size() != g.count) g.rechunk(run);
+    };
+    filter(overall);
+    for (Group& g : byCourse) filter(g);
+}
+
+void GpaRanking::clear() {
+    overall = Group();
+    byCourse.clear();
+}
+
+size_t GpaRanking::memoryUsage() const {
+    auto groupBytes = [](const Group& g) {
+        size_t bytes = g.blocks.capacity() * sizeof(vector<Entry>);
+        for (const vector<Entry>& block : g.blocks) bytes += block.capacity() * sizeof(Entry);
+        return bytes;
+    };
+    size_t bytes = groupBytes(overall) + byCourse.capacity() * sizeof(Group);
+    for (const Group& g : byCourse) bytes += groupBytes(g);
+    return bytes;
+}
+
+// A student is in the overall group while it has courses, and in the group
+// of each course it takes, once however many of its slots carry the name
+
+void StudentStore::rebuildRanking() {
+    courseCatalog();   // Course IDs come from the catalog
+    ranking.clear();
+    for (int i = 0; i < (int)records.size(); i++) {
+        const Student& s = records[i];
+        if (s.numCourses == 0) continue;
+        GpaRanking::Entry entry{ s.gpa, s.id, s.handleEntry };
+        ranking.append(GpaRanking::OVERALL, entry);
+        const Course* studentCourses = coursePool.data() + s.courseOffset;
+        for (int c = 0; c < s.numCourses; c++) {
+            int earlier = otherSlotOf(i, c);
+            if (earlier == -1 || earlier > c) ranking.append(catalog.find(studentCourses[c].nameId), entry);
+        }
+    }
+    ranking.sortAll();
+    rankingReady = true;
+}
+
+const GpaRanking& StudentStore::gpaRanking() {
+    if (!rankingReady) rebuildRanking();
+    return ranking;
+}
+
+void StudentStore::rerank(int index, float oldGpa) {
+    const Student& s = records[index];
+    if (!rankingReady || s.numCourses == 0 || s.gpa == oldGpa) return;
+    GpaRanking::Entry entry{ s.gpa, s.id, s.handleEntry };
+    ranking.move(GpaRanking::OVERALL, oldGpa, entry);
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    for (int c = 0; c < s.numCourses; c++) {
+        int earlier = otherSlotOf(index, c);
+        if (earlier == -1 || earlier > c) ranking.move(catalog.find(studentCourses[c].nameId), oldGpa, entry);
+    }
+}
+
+void StudentStore::unrank(int index) {
+    const Student& s = records[index];
+    if (!rankingReady || s.numCourses == 0) return;
+    ranking.erase(GpaRanking::OVERALL, s.gpa, s.id);
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    for (int c = 0; c < s.numCourses; c++) {
+        int earlier = otherSlotOf(index, c);
+        if (earlier == -1 || earlier > c) ranking.erase(catalog.find(studentCourses[c].nameId), s.gpa, s.id);
+    }
+}
+
+void StudentStore::rank(int index) {
+    const Student& s = records[index];
+    if (!rankingReady || s.numCourses == 0) return;
+    GpaRanking::Entry entry{ s.gpa, s.id, s.handleEntry };
+    ranking.insert(GpaRanking::OVERALL, entry);
+    const Course* studentCourses = coursePool.data() + s.courseOffset;
+    for (int c = 0; c < s.numCourses; c++) {
+        int earlier = otherSlotOf(index, c);
+        if (earlier == -1 || earlier > c) ranking.insert(catalog.find(studentCourses[c].nameId), entry);
+    }
+}
+
+int StudentStore::topStudents(int course, int k, vector<int>& indices) {
+    gpaRanking();
+    return std::as_const(*this).topStudents(course, k, indices);
+}
+
+int StudentStore::bottomStudents(int course, int k, vector<int>& indices) {
+    gpaRanking();
+    return std::as_const(*this).bottomStudents(course, k, indices);
+}
+
+int StudentStore::gpaRank(int index, int course) {
+    gpaRanking();
+    return std::as_const(*this).gpaRank(index, course);
+}
+
+int StudentStore::topStudents(int course, int k, vector<int>& indices) const {
+    ranking.best(course, k, indices);
+    for (int& entry : indices) entry = handleSlots[entry];
+    return ranking.size(course);
+}
+
+int StudentStore::bottomStudents(int course, int k, vector<int>& indices) const {
+    ranking.worst(course, k, indices);
+    for (int& entry : indices) entry = handleSlots[entry];
+    return ranking.size(course);
+}
+
+int StudentStore::gpaRank(int index, int course) const {
+    int position = ranking.position(course, records[index].gpa, records[index].id);
+    return position + 1;
+}
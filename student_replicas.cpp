@@ -0,0 +1,118 @@
+/**
+ * Student Replicas Module
+ *
+ * This file contains the two replicas that readers of a store read while
+ * one writer changes it: publishing, reader slots and the catching up of a
+ * replica with the writer's store.
+ */
+
+#include "student_replicas.h"   // Include replica declarations
+#include "student_journal.h"    // Include student images
+#include <thread>               // Include for yield
+
+void StudentReplicas::attach(StudentStore& store) {
+    // Before any reader enters
+    detach();
+    copies[0] = store;
+    copies[0].attachJournal(nullptr);
+    copies[0].attachChangeLog(nullptr);
+    copies[0].prepareForReaders();
+    copies[1] = copies[0];
+    master = &store;
+    changed.clear();
+    behind.clear();
+    master->attachChangeLog(&changed);
+}
+
+void StudentReplicas::detach() {
+    if (!master) return;
+    master->attachChangeLog(nullptr);
+    master = nullptr;
+}
+
+void StudentReplicas::waitForReaders(int replica) const {
+    for (const Slot& slot : slots) {
+        while (slot.replica.load(memory_order_seq_cst) == replica) this_thread::yield();
+    }
+}
+
+void StudentReplicas::bringUpToDate(int replica, vector<int>& ids) {
+    StudentStore& copy = copies[replica];
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    for (int id : ids) {
+        // The master's current state, whatever happened to the student meanwhile
+        int from = master->find(id);
+        int to = copy.find(id);
+        if (from == -1) {
+            if (to != -1) copy.remove(to);
+            continue;
+        }
+        const Student& s = (*master)[from];
+        StudentImage image;
+        image.student.id = s.id;
+        image.student.name = s.name;
+        image.student.nationalId = s.nationalId;
+        image.student.gpa = s.gpa;
+        const Course* courses = master->courses(from);
+        for (int c = 0; c < s.numCourses; c++) {
+            image.courses.emplace_back(string(courses[c].name()), courses[c].grade);
+        }
+        for (int p = 0; p < s.numStudyPlan; p++) {
+            image.studyPlan.emplace_back(master->studyPlanEntry(from, p));
+        }
+        applyStudentImage(copy, image);
+    }
+    copy.prepareForReaders();   // A large change can leave the name index due for a rebuild
+}
+
+void StudentReplicas::publish() {
+    if (!master || changed.empty()) return;
+    int standby = 1 - current.load(memory_order_relaxed);
+
+    // Readers that entered the standby before the last publish may still be in it
+    waitForReaders(standby);
+    vector<int> ids = behind;
+    ids.insert(ids.end(), changed.begin(), changed.end());
+    bringUpToDate(standby, ids);
+    current.store(standby, memory_order_seq_cst);
+    version.fetch_add(1, memory_order_release);
+
+    // The replica just left behind lacks only this publish's changes
+    behind.swap(changed);
+    changed.clear();
+}
+
+StudentReplicas::Reader::Reader(StudentReplicas& replicas) : replicas(replicas), slot(-1) {
+    while (true) {
+        for (int i = 0; i < MAX_READERS; i++) {
+            bool expected = false;
+            if (replicas.slots[i].taken.compare_exchange_strong(expected, true)) {
+                slot = i;
+                return;
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+StudentReplicas::Reader::~Reader() {
+    replicas.slots[slot].replica.store(-1, memory_order_release);
+    replicas.slots[slot].taken.store(false, memory_order_release);
+}
+
+const StudentStore& StudentReplicas::Reader::enter() {
+    Slot& s = replicas.slots[slot];
+    while (true) {
+        // Announce the replica, then check that it is still current: a writer
+        // that published meanwhile may have checked this slot before the
+        // announcement, and then it may change the replica; so try again
+        int replica = replicas.current.load(memory_order_seq_cst);
+        s.replica.store(replica, memory_order_seq_cst);
+        if (replicas.current.load(memory_order_seq_cst) == replica) return replicas.copies[replica];
+    }
+}
+
+void StudentReplicas::Reader::exit() {
+    replicas.slots[slot].replica.store(-1, memory_order_release);
+}
@@ -0,0 +1,105 @@
+/**
+ * student_replicas.h - Lock-free readers of a store that one thread changes
+ *
+ * The store itself is not thread-safe: a change may move records, grow the
+ * pools and rewrite the indexes under a reader's feet. StudentReplicas lets
+ * any number of threads read a consistent copy of a store while one writer
+ * keeps changing it, with neither side taking a lock.
+ *
+ * Readers never touch the writer's store. They read one of two replicas,
+ * each a complete StudentStore with every index built (prepareForReaders),
+ * through its const calls: find, searchNames, ordered, courseCatalog,
+ * topStudents and so on. The store records the IDs it changes, and publish()
+ * brings the replica readers are not using up to date and makes it the
+ * current one with a single atomic store (a left-right scheme). Readers that
+ * already hold the other replica keep a consistent, slightly older view.
+ * Before that replica is changed in its turn, at the next publish(), the
+ * writer waits until every reader has left it; each reader announces the
+ * replica it is in through a slot of its own, so readers never share a
+ * written cache line and never wait.
+ *
+ * Readers see whole publishes: every change made between two calls of
+ * publish() appears at once or not at all. The price is two more copies of
+ * the students in memory.
+ */
+
+#ifndef STUDENT_REPLICAS_H
+#define STUDENT_REPLICAS_H
+
+#include "student.h"   // Include student structure definitions
+#include <atomic>      // Include for the published replica and reader slots
+
+class StudentReplicas {
+public:
+    static const int MAX_READERS = 256;   // Readers at once; more wait for a free slot
+
+    StudentReplicas() {}
+    ~StudentReplicas() { detach(); }
+    StudentReplicas(const StudentReplicas&) = delete;
+    StudentReplicas& operator=(const StudentReplicas&) = delete;
+
+    // Copy a store into both replicas and record its changes from now on;
+    // before any reader enters. The store must not be cleared while attached.
+    void attach(StudentStore& store);
+    void detach();
+    bool attached() const { return master != nullptr; }
+
+    // Make the changes made to the store so far visible to readers. Writer
+    // only; waits only for readers still in a replica from two publishes ago.
+    void publish();
+    uint64_t publishes() const { return version.load(memory_order_acquire); }
+
+    /**
+     * A reader thread's slot; the replica it reads stays untouched between
+     * enter() and exit()
+     */
+    class Reader {
+    public:
+        explicit Reader(StudentReplicas& replicas);
+        ~Reader();
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const StudentStore& enter();   // Start reading the current replica
+        void exit();                   // Stop; the store from enter() must not be used any more
+
+    private:
+        StudentReplicas& replicas;
+        int slot;
+    };
+
+    /**
+     * Reads from entering to leaving the scope
+     */
+    class View {
+    public:
+        explicit View(Reader& reader) : store(reader.enter()), reader(reader) {}
+        ~View() { reader.exit(); }
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        const StudentStore& store;
+
+    private:
+        Reader& reader;
+    };
+
+private:
+    struct alignas(64) Slot {
+        atomic<bool> taken{ false };   // Whether a Reader holds the slot
+        atomic<int> replica{ -1 };     // Replica the reader is in, -1 between reads
+    };
+
+    void waitForReaders(int replica) const;                 // Until no reader is in a replica
+    void bringUpToDate(int replica, vector<int>& ids);      // Copy the students of ids from the master
+
+    StudentStore* master = nullptr;   // Store the writer changes
+    StudentStore copies[2];           // The replicas readers read
+    atomic<int> current{ 0 };         // Replica new readers enter
+    atomic<uint64_t> version{ 0 };    // Number of publishes
+    vector<int> changed;              // IDs the master changed since the last publish
+    vector<int> behind;               // IDs the other replica has not caught up with
+    Slot slots[MAX_READERS];
+};
+
+#endif // STUDENT_REPLICAS_H
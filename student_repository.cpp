@@ -0,0 +1,570 @@
+/**
+ * Student Repository Module
+ *
+ * This file contains the storage engines described in student_repository.h
+ * and the writer and reader of the page file.
+ */
+
+#include "student_repository.h"   // Include repository declarations
+#include "student_snapshot.h"     // Include the binary snapshot reader and writer
+#include <algorithm>              // Include for sort, lower_bound and upper_bound
+#include <charconv>               // Include for from_chars
+#include <cstddef>                // Include for offsetof
+#include <cstdio>                 // Include for rename and remove
+#include <cstring>                // Include for memcpy, memcmp and memchr
+#include <map>                    // Include for the memory engine
+#include <thread>                 // Include for hardware_concurrency
+#include <fcntl.h>                // Include for open
+#include <unistd.h>               // Include for pread, pwrite and fsync
+#include <sys/stat.h>             // Include for fstat
+
+static const char PAGE_FILE_MAGIC[8] = { 'S', 'I', 'S', 'P', 'A', 'G', 'E', '1' };
+static const int LEAF_CAPACITY = (PAGE_FILE_PAGE_SIZE - sizeof(PageHeader)) / sizeof(LeafEntry);
+static const int INNER_CAPACITY = (PAGE_FILE_PAGE_SIZE - sizeof(PageHeader)) / sizeof(InnerEntry);
+static const size_t RECORD_BLOCK_BYTES = 1 << 20;   // Records written at once
+
+/**
+ * Flush a file written by name to disk
+ */
+static bool syncPath(const char* path, bool directory) {
+    int fd = open(path, directory ? O_RDONLY | O_DIRECTORY : O_WRONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+/**
+ * Rename a finished temporary file over a repository's file, durably
+ */
+static bool replaceWith(const string& temporary, const string& path, string& error) {
+    if (!syncPath(temporary.c_str(), false) || rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+        error = "could not replace " + path;
+        return false;
+    }
+    size_t slash = path.rfind('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    syncPath(directory.c_str(), true);   // Make the rename itself durable
+    return true;
+}
+
+/**
+ * Image of a student in a store
+ */
+static void imageOf(const StudentStore& store, int index, StudentImage& image) {
+    string payload;
+    encodeStudentImage(payload, store, index);
+    decodeStudentImage(payload.data(), payload.size(), image);
+}
+
+/**
+ * students.txt format
+ */
+class TextRepository : public StudentRepository {
+public:
+    explicit TextRepository(const char* path) : path(path) {}
+    const char* name() const override { return "text"; }
+
+    bool loadAll(StudentStore& store, string& error, vector<ParseError>& skipped) override {
+        error.clear();
+        int threads = loaderThreads > 0 ? loaderThreads : (int)thread::hardware_concurrency();
+        return loadStudentsFromFile(path.c_str(), store, skipped, threads);
+    }
+
+    bool saveAll(const StudentStore& store, string& error) override {
+        string temporary = path + ".tmp";
+        if (!writeStudentsFile(temporary.c_str(), store)) {
+            remove(temporary.c_str());
+            error = "could not write " + temporary;
+            return false;
+        }
+        return replaceWith(temporary, path, error);
+    }
+
+    bool find(int id, StudentImage& image, string& error) override;
+
+private:
+    string path;
+};
+
+bool TextRepository::find(int id, StudentImage& image, string& error) {
+    error.clear();
+    MappedFile file;
+    if (!file.open(path.c_str())) {
+        error = "could not open " + path;
+        return false;
+    }
+    const char* end = file.data() + file.size();
+    int lineNumber = 1;
+    for (const char* line = file.data(); line < end; lineNumber++) {
+        const char* next = (const char*)memchr(line, '\n', end - line);
+        next = next ? next + 1 : end;
+
+        // Only the line with the ID is parsed; the first one wins, as in a load
+        int lineId;
+        from_chars_result result = from_chars(line, next, lineId);
+        if (result.ec != errc() || result.ptr == next || *result.ptr != ',' || lineId != id) {
+            line = next;
+            continue;
+        }
+        ParsedFile parsed;
+        parseStudentBuffer(line, next - line, lineNumber, parsed);
+        if (parsed.students.empty()) {
+            error = "line " + to_string(lineNumber) + ": " + parsed.errors[0].message;
+            return false;
+        }
+        const ParsedStudent& p = parsed.students[0];
+        image.student = Student();
+        image.student.id = p.id;
+        image.student.gpa = p.gpa;
+        image.student.name.assign(p.name);
+        image.student.nationalId.assign(p.nationalId);
+        image.courses.clear();
+        for (int c = 0; c < p.numCourses; c++) {
+            const ParsedCourse& course = parsed.courses[p.firstCourse + c];
+            image.courses.emplace_back(string(course.name), course.grade);
+        }
+        image.studyPlan.assign(parsed.studyPlan.begin() + p.firstPlanEntry,
+                               parsed.studyPlan.begin() + p.firstPlanEntry + p.numStudyPlan);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Binary snapshot
+ */
+class SnapshotRepository : public StudentRepository {
+public:
+    explicit SnapshotRepository(const char* path) : path(path) {}
+    const char* name() const override { return "snapshot"; }
+
+    bool loadAll(StudentStore& store, string& error, vector<ParseError>&) override {
+        return loadStudentSnapshot(path.c_str(), store, error);
+    }
+
+    bool saveAll(const StudentStore& store, string& error) override {
+        string temporary = path + ".tmp";
+        if (!writeStudentSnapshot(temporary.c_str(), store)) {
+            remove(temporary.c_str());
+            error = "could not write " + temporary;
+            return false;
+        }
+        return replaceWith(temporary, path, error);
+    }
+
+    bool find(int id, StudentImage& image, string& error) override {
+        StudentStore loaded;
+        if (!loadStudentSnapshot(path.c_str(), loaded, error)) {
+            if (error.empty()) error = "could not open " + path;
+            return false;
+        }
+        error.clear();
+        int index = loaded.find(id);
+        if (index == -1) return false;
+        imageOf(loaded, index, image);
+        return true;
+    }
+
+private:
+    string path;
+};
+
+/**
+ * Students held in memory, by ID
+ */
+class MemoryRepository : public StudentRepository {
+public:
+    const char* name() const override { return "memory"; }
+
+    bool loadAll(StudentStore& store, string& error, vector<ParseError>&) override {
+        error.clear();
+        for (const auto& entry : images) applyStudentImage(store, entry.second);
+        return true;
+    }
+
+    bool saveAll(const StudentStore& store, string&) override {
+        images.clear();
+        for (int i = 0; i < store.size(); i++) imageOf(store, i, images[store[i].id]);
+        return true;
+    }
+
+    bool find(int id, StudentImage& image, string& error) override {
+        error.clear();
+        auto found = images.find(id);
+        if (found == images.end()) return false;
+        image = found->second;
+        return true;
+    }
+
+private:
+    map<int, StudentImage> images;
+};
+
+/**
+ * Pages of each tree level for a number of students, leaves first
+ */
+static vector<uint64_t> levelSizes(uint64_t students) {
+    vector<uint64_t> sizes;
+    if (students == 0) return sizes;
+    uint64_t pages = (students + LEAF_CAPACITY - 1) / LEAF_CAPACITY;
+    sizes.push_back(pages);
+    while (pages > 1) {
+        pages = (pages + INNER_CAPACITY - 1) / INNER_CAPACITY;
+        sizes.push_back(pages);
+    }
+    return sizes;
+}
+
+static uint32_t pageCrc(const char* page) {
+    return crc32(page + sizeof(uint32_t), PAGE_FILE_PAGE_SIZE - sizeof(uint32_t));
+}
+
+/**
+ * Check the header of a page file against its size
+ */
+static bool checkPageFileHeader(const char* data, uint64_t size, PageFileHeader& header, string& error) {
+    if (size < PAGE_FILE_PAGE_SIZE || memcmp(data, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC)) != 0) {
+        error = "not a student page file";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.version == 0 || header.version > PAGE_FILE_VERSION) {
+        error = "unsupported page file version " + to_string(header.version);
+        return false;
+    }
+    if (header.crc != crc32((const char*)&header, offsetof(PageFileHeader, crc))) {
+        error = "corrupt header";
+        return false;
+    }
+    // The layout follows from the number of students alone
+    vector<uint64_t> levels = levelSizes(header.students);
+    uint64_t pages = 1;
+    for (uint64_t level : levels) pages += level;
+    if (header.pageSize != PAGE_FILE_PAGE_SIZE || header.dataOffset != pages * PAGE_FILE_PAGE_SIZE ||
+        header.dataOffset > size || header.height != levels.size() ||
+        header.leafPages != (levels.empty() ? 0 : levels[0]) || header.rootPage != (levels.empty() ? 0 : pages - 1)) {
+        error = "inconsistent header";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Check a tree page that has been read
+ */
+static bool checkPage(const char* page, PageKind kind, string& error) {
+    PageHeader header;
+    memcpy(&header, page, sizeof(header));
+    int capacity = kind == PAGE_LEAF ? LEAF_CAPACITY : INNER_CAPACITY;
+    if (header.crc != pageCrc(page) || header.kind != kind || header.count == 0 || header.count > capacity) {
+        error = "corrupt page";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes at given offsets of a file, remembering whether any write failed
+ */
+struct PageFileWriter {
+    int fd;
+    bool ok = true;
+
+    void write(const void* data, size_t size, uint64_t offset) {
+        const char* bytes = (const char*)data;
+        while (ok && size > 0) {
+            ssize_t n = pwrite(fd, bytes, size, (off_t)offset);
+            if (n <= 0) {
+                ok = false;
+                return;
+            }
+            bytes += n;
+            size -= n;
+            offset += n;
+        }
+    }
+};
+
+/**
+ * Page file with a B+-tree on ID
+ */
+class PageRepository : public StudentRepository {
+public:
+    explicit PageRepository(const char* path) : path(path) {}
+    ~PageRepository() override {
+        if (fd >= 0) close(fd);
+    }
+    const char* name() const override { return "pages"; }
+
+    bool loadAll(StudentStore& store, string& error, vector<ParseError>& skipped) override;
+    bool saveAll(const StudentStore& store, string& error) override;
+    bool find(int id, StudentImage& image, string& error) override;
+
+private:
+    bool openForReads(string& error);                   // Open the file and check its header, once
+    bool readPage(uint32_t page, PageKind kind, string& error);
+
+    string path;
+    int fd = -1;                    // Kept open for finds, -1 until the first
+    PageFileHeader header;          // Header of the open file
+    vector<char> page;              // Page being read
+};
+
+bool PageRepository::saveAll(const StudentStore& store, string& error) {
+    vector<pair<int, int>> byId(store.size());
+    for (int i = 0; i < store.size(); i++) byId[i] = { store[i].id, i };
+    sort(byId.begin(), byId.end());
+    vector<uint64_t> levels = levelSizes(byId.size());
+    uint64_t pages = 1;
+    for (uint64_t level : levels) pages += level;
+    if (pages > UINT32_MAX) {
+        error = "too many students for a page file";
+        return false;
+    }
+
+    string temporary = path + ".tmp";
+    PageFileWriter out{ open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+    if (out.fd < 0) {
+        error = "could not write " + temporary;
+        return false;
+    }
+
+    // Leaves and records in ID order; records are gathered into large blocks
+    vector<char> buffer(PAGE_FILE_PAGE_SIZE);
+    PageHeader pageHeader;
+    vector<int32_t> firstIds;          // Lowest ID of each page of the level just written
+    string records, payload;
+    uint64_t recordsOffset = pages * PAGE_FILE_PAGE_SIZE;   // File offset of records[0]
+    int count = 0;
+    for (size_t k = 0; k < byId.size(); k++) {
+        payload.clear();
+        encodeStudentImage(payload, store, byId[k].second);
+        uint32_t crc = crc32(payload.data(), payload.size());
+        LeafEntry entry{ byId[k].first, (uint32_t)payload.size(), recordsOffset + records.size() };
+        records.append((const char*)&crc, sizeof(crc));
+        records.append(payload);
+        if (records.size() >= RECORD_BLOCK_BYTES) {
+            out.write(records.data(), records.size(), recordsOffset);
+            recordsOffset += records.size();
+            records.clear();
+        }
+
+        if (count == 0) firstIds.push_back(entry.id);
+        memcpy(buffer.data() + sizeof(PageHeader) + count * sizeof(LeafEntry), &entry, sizeof(entry));
+        if (++count < LEAF_CAPACITY && k + 1 < byId.size()) continue;
+        memset(buffer.data() + sizeof(PageHeader) + count * sizeof(LeafEntry), 0,
+               PAGE_FILE_PAGE_SIZE - sizeof(PageHeader) - count * sizeof(LeafEntry));
+        pageHeader = PageHeader{ 0, PAGE_LEAF, (uint16_t)count };
+        memcpy(buffer.data(), &pageHeader, sizeof(pageHeader));
+        pageHeader.crc = pageCrc(buffer.data());
+        memcpy(buffer.data(), &pageHeader, sizeof(pageHeader));
+        out.write(buffer.data(), PAGE_FILE_PAGE_SIZE, (uint64_t)firstIds.size() * PAGE_FILE_PAGE_SIZE);
+        count = 0;
+    }
+    out.write(records.data(), records.size(), recordsOffset);
+
+    // Inner levels bottom up, each page listing its children with their lowest IDs
+    uint64_t below = 1;   // First page of the level below
+    for (size_t level = 1; level < levels.size(); level++) {
+        uint64_t first = below + levels[level - 1];
+        vector<int32_t> levelIds;
+        for (uint64_t p = 0; p < levels[level]; p++) {
+            uint64_t firstChild = p * INNER_CAPACITY;
+            count = (int)min<uint64_t>(INNER_CAPACITY, firstIds.size() - firstChild);
+            memset(buffer.data(), 0, PAGE_FILE_PAGE_SIZE);
+            for (int c = 0; c < count; c++) {
+                InnerEntry entry{ firstIds[firstChild + c], (uint32_t)(below + firstChild + c) };
+                memcpy(buffer.data() + sizeof(PageHeader) + c * sizeof(InnerEntry), &entry, sizeof(entry));
+            }
+            pageHeader = PageHeader{ 0, PAGE_INNER, (uint16_t)count };
+            memcpy(buffer.data(), &pageHeader, sizeof(pageHeader));
+            pageHeader.crc = pageCrc(buffer.data());
+            memcpy(buffer.data(), &pageHeader, sizeof(pageHeader));
+            out.write(buffer.data(), PAGE_FILE_PAGE_SIZE, (first + p) * PAGE_FILE_PAGE_SIZE);
+            levelIds.push_back(firstIds[firstChild]);
+        }
+        firstIds.swap(levelIds);
+        below = first;
+    }
+
+    PageFileHeader fileHeader = {};
+    memcpy(fileHeader.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+    fileHeader.version = PAGE_FILE_VERSION;
+    fileHeader.pageSize = PAGE_FILE_PAGE_SIZE;
+    fileHeader.students = byId.size();
+    fileHeader.leafPages = levels.empty() ? 0 : (uint32_t)levels[0];
+    fileHeader.rootPage = levels.empty() ? 0 : (uint32_t)(pages - 1);
+    fileHeader.height = (uint32_t)levels.size();
+    fileHeader.dataOffset = pages * PAGE_FILE_PAGE_SIZE;
+    fileHeader.crc = crc32((const char*)&fileHeader, offsetof(PageFileHeader, crc));
+    memset(buffer.data(), 0, PAGE_FILE_PAGE_SIZE);
+    memcpy(buffer.data(), &fileHeader, sizeof(fileHeader));
+    out.write(buffer.data(), PAGE_FILE_PAGE_SIZE, 0);
+
+    if (close(out.fd) != 0 || !out.ok) {
+        remove(temporary.c_str());
+        error = "could not write " + temporary;
+        return false;
+    }
+    // A reader of the old file must not mix it with the new one
+    if (fd >= 0) close(fd);
+    fd = -1;
+    return replaceWith(temporary, path, error);
+}
+
+bool PageRepository::loadAll(StudentStore& store, string& error, vector<ParseError>&) {
+    error.clear();
+    MappedFile file;
+    if (!file.open(path.c_str())) return false;
+    PageFileHeader fileHeader;
+    if (!checkPageFileHeader(file.data(), file.size(), fileHeader, error)) return false;
+
+    // Leaves are consecutive and hold every record in ID order, so the inner
+    // levels are not needed; each leaf and record is checked before the store
+    // is touched
+    StudentImage image;
+    uint64_t students = 0;
+    int64_t lastId = INT64_MIN;
+    for (uint32_t leaf = 1; leaf <= fileHeader.leafPages; leaf++) {
+        const char* data = file.data() + (uint64_t)leaf * PAGE_FILE_PAGE_SIZE;
+        if (!checkPage(data, PAGE_LEAF, error)) {
+            error += " " + to_string(leaf);
+            return false;
+        }
+        PageHeader leafHeader;
+        memcpy(&leafHeader, data, sizeof(leafHeader));
+        const LeafEntry* entries = (const LeafEntry*)(data + sizeof(PageHeader));
+        for (int e = 0; e < leafHeader.count; e++) {
+            const LeafEntry& entry = entries[e];
+            uint32_t crc;
+            if (entry.id <= lastId || entry.offset < fileHeader.dataOffset ||
+                entry.offset + sizeof(crc) + entry.length > file.size()) {
+                error = "invalid entry in page " + to_string(leaf);
+                return false;
+            }
+            const char* record = file.data() + entry.offset;
+            memcpy(&crc, record, sizeof(crc));
+            if (crc != crc32(record + sizeof(crc), entry.length) ||
+                !decodeStudentImage(record + sizeof(crc), entry.length, image) || image.student.id != entry.id) {
+                error = "corrupt record of student " + to_string(entry.id);
+                return false;
+            }
+            lastId = entry.id;
+            students++;
+        }
+    }
+    if (students != fileHeader.students) {
+        error = "missing students";
+        return false;
+    }
+
+    store.reserve(store.size() + (int)students, 0, 0);
+    for (uint32_t leaf = 1; leaf <= fileHeader.leafPages; leaf++) {
+        const char* data = file.data() + (uint64_t)leaf * PAGE_FILE_PAGE_SIZE;
+        PageHeader leafHeader;
+        memcpy(&leafHeader, data, sizeof(leafHeader));
+        const LeafEntry* entries = (const LeafEntry*)(data + sizeof(PageHeader));
+        for (int e = 0; e < leafHeader.count; e++) {
+            const char* record = file.data() + entries[e].offset + sizeof(uint32_t);
+            decodeStudentImage(record, entries[e].length, image);
+            applyStudentImage(store, image);
+        }
+    }
+    return true;
+}
+
+bool PageRepository::openForReads(string& error) {
+    if (fd >= 0) return true;
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "could not open " + path;
+        return false;
+    }
+    page.resize(PAGE_FILE_PAGE_SIZE);
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || pread(fd, page.data(), PAGE_FILE_PAGE_SIZE, 0) != (ssize_t)PAGE_FILE_PAGE_SIZE) {
+        memset(page.data(), 0, PAGE_FILE_PAGE_SIZE);   // Fails the magic check below
+    }
+    if (!checkPageFileHeader(page.data(), (uint64_t)info.st_size, header, error)) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool PageRepository::readPage(uint32_t number, PageKind kind, string& error) {
+    if (number == 0 || (uint64_t)number * PAGE_FILE_PAGE_SIZE >= header.dataOffset ||
+        pread(fd, page.data(), PAGE_FILE_PAGE_SIZE, (off_t)number * PAGE_FILE_PAGE_SIZE) !=
+            (ssize_t)PAGE_FILE_PAGE_SIZE) {
+        error = "could not read page " + to_string(number);
+        return false;
+    }
+    if (!checkPage(page.data(), kind, error)) {
+        error += " " + to_string(number);
+        return false;
+    }
+    return true;
+}
+
+bool PageRepository::find(int id, StudentImage& image, string& error) {
+    error.clear();
+    if (!openForReads(error)) return false;
+    if (header.students == 0) return false;
+
+    // Down the inner levels to the child whose range holds the ID
+    uint32_t number = header.rootPage;
+    PageHeader pageHeader;
+    for (uint32_t level = header.height; level > 1; level--) {
+        if (!readPage(number, PAGE_INNER, error)) return false;
+        memcpy(&pageHeader, page.data(), sizeof(pageHeader));
+        const InnerEntry* entries = (const InnerEntry*)(page.data() + sizeof(PageHeader));
+        const InnerEntry* child = upper_bound(entries, entries + pageHeader.count, id,
+                                              [](int value, const InnerEntry& e) { return value < e.firstId; });
+        if (child == entries) return false;   // Below the lowest ID
+        number = (child - 1)->page;
+    }
+    if (!readPage(number, PAGE_LEAF, error)) return false;
+    memcpy(&pageHeader, page.data(), sizeof(pageHeader));
+    const LeafEntry* entries = (const LeafEntry*)(page.data() + sizeof(PageHeader));
+    const LeafEntry* found = lower_bound(entries, entries + pageHeader.count, id,
+                                         [](const LeafEntry& e, int value) { return e.id < value; });
+    if (found == entries + pageHeader.count || found->id != id) return false;
+
+    LeafEntry entry = *found;
+    string record(sizeof(uint32_t) + entry.length, '\0');
+    uint32_t crc;
+    if (entry.offset < header.dataOffset ||
+        pread(fd, &record[0], record.size(), (off_t)entry.offset) != (ssize_t)record.size()) {
+        error = "could not read the record of student " + to_string(id);
+        return false;
+    }
+    memcpy(&crc, record.data(), sizeof(crc));
+    if (crc != crc32(record.data() + sizeof(crc), entry.length) ||
+        !decodeStudentImage(record.data() + sizeof(crc), entry.length, image)) {
+        error = "corrupt record of student " + to_string(id);
+        return false;
+    }
+    return true;
+}
+
+RepositoryKind repositoryKindOf(const char* path) {
+    string_view name(path);
+    auto endsWith = [&name](string_view suffix) {
+        return name.size() >= suffix.size() && name.substr(name.size() - suffix.size()) == suffix;
+    };
+    if (endsWith(".txt")) return REPOSITORY_TEXT;
+    if (endsWith(".pages")) return REPOSITORY_PAGES;
+    return REPOSITORY_SNAPSHOT;
+}
+
+unique_ptr<StudentRepository> makeStudentRepository(RepositoryKind kind, const char* path) {
+    switch (kind) {
+        case REPOSITORY_TEXT: return unique_ptr<StudentRepository>(new TextRepository(path));
+        case REPOSITORY_PAGES: return unique_ptr<StudentRepository>(new PageRepository(path));
+        case REPOSITORY_MEMORY: return unique_ptr<StudentRepository>(new MemoryRepository());
+        default: return unique_ptr<StudentRepository>(new SnapshotRepository(path));
+    }
+}
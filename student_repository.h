@@ -0,0 +1,146 @@
+/**
+ * student_repository.h - Storage engines behind one interface
+ *
+ * A StudentRepository keeps students outside the store. It can load them
+ * all into a StudentStore, replace its contents with those of a store, and
+ * find one student by ID. The engines are:
+ *
+ *   text       The students.txt format (student_parser.h). A find scans the
+ *              line starts of the mapped file and parses only the line of
+ *              the ID.
+ *   snapshot   The binary snapshot (student_snapshot.h) the program keeps
+ *              its students in. A find loads the whole snapshot.
+ *   pages      A page file with a B+-tree on ID (format below). A find reads
+ *              the header, one page per tree level and the record, so one
+ *              student of an archive of any size comes with a handful of
+ *              reads and without loading the file. Three levels hold over
+ *              60 million students.
+ *   memory     Students held in the repository object, for tests and tools
+ *
+ * makeStudentRepository() creates an engine, and repositoryKindOf() picks
+ * one by file extension: ".txt" for text, ".pages" for pages, anything else
+ * for snapshot. The program loads and checkpoints its data file through
+ * these engines, so the extension of SNAPSHOT_FILENAME chooses the engine.
+ * The journal works the same with any of them.
+ *
+ * File engines replace their file atomically. The new contents are written
+ * to "<file>.tmp", flushed and renamed over the old file, so a crash leaves
+ * either the old file or the new one.
+ *
+ * Page file layout (native byte order, pages of PAGE_FILE_PAGE_SIZE bytes):
+ *   page 0          PageFileHeader
+ *   leaves          pages 1 to leafPages: PageHeader, then LeafEntry records
+ *                   in ascending ID order, full except for the last leaf
+ *   inner levels    following the leaves, bottom up, root last: PageHeader,
+ *                   then InnerEntry records, one per page of the level below
+ *   records         from dataOffset, in ID order: the CRC-32 of the payload,
+ *                   then the payload in the journal's student image encoding
+ *
+ * Every page starts with the CRC-32 of the rest of the page, and the header
+ * has a CRC-32 of its own. The file is written in one go from a store; it is
+ * not updated in place.
+ */
+
+#ifndef STUDENT_REPOSITORY_H
+#define STUDENT_REPOSITORY_H
+
+#include "student.h"           // Include student structure definitions
+#include "student_parser.h"    // Include ParseError for skipped text lines
+#include "student_journal.h"   // Include StudentImage and its encoding
+#include <cstdint>             // Include for fixed-width integers
+#include <memory>              // Include for unique_ptr
+
+const uint32_t PAGE_FILE_VERSION = 1;      // Version written by this build
+const uint32_t PAGE_FILE_PAGE_SIZE = 4096;
+
+/**
+ * Page file header, at the start of page 0
+ */
+struct PageFileHeader {
+    char magic[8];           // "SISPAGE1"
+    uint32_t version;        // PAGE_FILE_VERSION of the writer
+    uint32_t pageSize;       // PAGE_FILE_PAGE_SIZE of the writer
+    uint64_t students;       // Number of records
+    uint32_t leafPages;      // Leaves are pages 1 to leafPages
+    uint32_t rootPage;       // 0 if there are no students
+    uint32_t height;         // Tree levels, 1 if the root is a leaf
+    uint32_t reserved;       // Zero
+    uint64_t dataOffset;     // Start of the records, right after the last page
+    uint32_t crc;            // CRC-32 of the fields above
+    uint32_t reserved2;      // Zero
+};
+
+/**
+ * Page kinds
+ */
+enum PageKind : uint16_t {
+    PAGE_LEAF = 1,
+    PAGE_INNER = 2
+};
+
+/**
+ * Start of every tree page
+ */
+struct PageHeader {
+    uint32_t crc;            // CRC-32 of the rest of the page
+    uint16_t kind;           // PageKind
+    uint16_t count;          // Entries that follow
+};
+
+/**
+ * Leaf entry: where a student's record is
+ */
+struct LeafEntry {
+    int32_t id;
+    uint32_t length;         // Payload bytes, after the 4-byte CRC
+    uint64_t offset;         // Start of the record (its CRC) in the file
+};
+
+/**
+ * Inner entry: a page of the level below and the lowest ID under it
+ */
+struct InnerEntry {
+    int32_t firstId;
+    uint32_t page;
+};
+
+/**
+ * Storage engines
+ */
+enum RepositoryKind {
+    REPOSITORY_TEXT,
+    REPOSITORY_SNAPSHOT,
+    REPOSITORY_PAGES,
+    REPOSITORY_MEMORY,
+    NUM_REPOSITORY_KINDS
+};
+
+/**
+ * Students kept by one storage engine
+ */
+class StudentRepository {
+public:
+    virtual ~StudentRepository() {}
+    virtual const char* name() const = 0;   // Engine name, as listed above
+
+    // Add every student to a store. Returns false if there is nothing to load
+    // (error left empty) or the data is invalid (error says why, and the
+    // store is unchanged). On success error may hold a warning, and the
+    // lines of a text file that could not be read are listed in skipped.
+    virtual bool loadAll(StudentStore& store, string& error, vector<ParseError>& skipped) = 0;
+
+    // Replace the contents with every student of a store
+    virtual bool saveAll(const StudentStore& store, string& error) = 0;
+
+    // One student by ID. False with error left empty if there is no such
+    // student, with the reason if the data cannot be read.
+    virtual bool find(int id, StudentImage& image, string& error) = 0;
+};
+
+// Engine for a file name, by its extension
+RepositoryKind repositoryKindOf(const char* path);
+
+// Create an engine on a file (not opened until used; ignored for memory)
+unique_ptr<StudentRepository> makeStudentRepository(RepositoryKind kind, const char* path = "");
+
+#endif // STUDENT_REPOSITORY_H
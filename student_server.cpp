@@ -0,0 +1,750 @@
+/**
+ * Student Information System - Server
+ *
+ * Owns the student store and serves it to its clients over a Unix-domain
+ * socket (protocol in student_protocol.h):
+ *   student_server [--readers N] [socket]
+ * The console and ncurses programs become clients with --connect. The store
+ * is loaded, journaled and checkpointed exactly as by those programs when
+ * they run on their own, so they must not run on the same files meanwhile.
+ *
+ * One thread serves every client through an epoll loop. Each round reads
+ * whatever the clients sent, handles every complete request in order, makes
+ * the round's changes durable with one journal commit and only then sends
+ * the replies, one write per client.
+ *
+ * Reads (GET and SEARCH) are answered by reader threads instead (--readers,
+ * by default one fewer than the CPUs), from a StudentReplicas copy of the
+ * store as published at the end of the last round, while the loop thread
+ * goes on with the changes and the commit. The replies are put back in
+ * request order. A client that made or was sent a change within the round
+ * has its reads answered by the loop thread, so no client reads older data
+ * than it has already seen. With no reader threads every read is answered
+ * by the loop thread and the replicas are not kept.
+ */
+
+#include "student.h"            // Include student structure definitions
+#include "student_protocol.h"   // Include the client protocol
+#include "student_replicas.h"   // Include the copies the reader threads read
+#include <iostream>             // Include for console output
+#include <unordered_map>        // Include for the connections by descriptor
+#include <thread>               // Include for the reader threads
+#include <mutex>                // Include for handing rounds of reads to them
+#include <condition_variable>   // Include for waking them
+#include <cstdlib>              // Include for atoi
+#include <cerrno>               // Include for errno
+#include <csignal>              // Include for stopping on SIGINT and SIGTERM
+#include <cstdio>               // Include for remove
+#include <sys/epoll.h>          // Include for the event loop
+#include <sys/socket.h>         // Include for sockets
+#include <sys/un.h>             // Include for Unix-domain addresses
+#include <unistd.h>             // Include for read, write and close
+
+// Global store served to the clients
+StudentStore students;
+
+// A client is dropped once this much output waits for it; a subscriber that
+// stops reading would otherwise hold every change made meanwhile
+static const size_t MAX_PENDING_OUTPUT = 256 << 20;
+static const int MAX_EVENTS = 256;
+static const int MAX_SEARCH_RESULTS = 10000;   // Students in one search reply
+
+/**
+ * A connected client
+ */
+struct Connection {
+    int fd;
+    string in;                // Received bytes not handled yet
+    string out;               // Replies and pushes not sent yet
+    size_t sent = 0;          // Bytes at the start of out already sent
+    bool subscribed = false;  // Whether the client is sent other clients' changes
+    bool writing = false;     // Whether the epoll set waits for the socket to take more
+    bool queued = false;      // Whether the connection is in the round's flush list
+    uint64_t changedIn = 0;   // Last round in which the client made or was sent a change
+};
+
+/**
+ * A read handed to the reader threads
+ */
+struct ReadTask {
+    int fd;                   // Connection
+    size_t at;                // Where the reply goes in the connection's output
+    string request;           // Request frame
+    string reply;             // Reply frame, once answered
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+static int epollFd = -1;
+static unordered_map<int, Connection> connections;
+static vector<int> flushList;        // Connections with output to send this round
+static uint64_t roundNumber = 0;     // Number of the current round
+
+// Reader threads; the tasks are only touched while readers are busy or by
+// the loop thread while none is
+static StudentReplicas replicas;
+static vector<thread> readerThreads;
+static mutex readMutex;
+static condition_variable readWake;    // A round of reads is ready, or the readers stop
+static condition_variable readIdle;    // The round's reads are answered
+static vector<ReadTask> readRound;     // Reads being answered
+static atomic<size_t> nextRead{ 0 };   // Next task a reader takes
+static size_t readsAnswered = 0;
+static int busyReaders = 0;
+static uint64_t readGeneration = 0;    // Bumped for each round of reads
+static bool readersStop = false;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+static void queueOutput(Connection& c) {
+    if (c.queued) return;
+    c.queued = true;
+    flushList.push_back(c.fd);
+}
+
+static void closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+/**
+ * Send a change to every subscriber but the client that caused it
+ */
+static void broadcastStudent(int index, const Connection* except) {
+    string push;
+    FrameWriter out(push, MSG_CHANGED, 0);
+    out.putStudent(students, index);
+    out.finish();
+    for (auto& entry : connections) {
+        Connection& c = entry.second;
+        if (!c.subscribed || &c == except) continue;
+        c.out += push;
+        c.changedIn = roundNumber;
+        queueOutput(c);
+    }
+}
+
+static void broadcastDelete(int id, const Connection* except) {
+    string push;
+    FrameWriter out(push, MSG_DELETED, 0);
+    out.putInt(id);
+    out.finish();
+    for (auto& entry : connections) {
+        Connection& c = entry.second;
+        if (!c.subscribed || &c == except) continue;
+        c.out += push;
+        c.changedIn = roundNumber;
+        queueOutput(c);
+    }
+}
+
+// Tell every subscriber to fetch all students again after a bulk change
+static void broadcastReload() {
+    string push;
+    FrameWriter out(push, MSG_RELOAD, 0);
+    out.finish();
+    for (auto& entry : connections) {
+        Connection& c = entry.second;
+        if (!c.subscribed) continue;
+        c.out += push;
+        c.changedIn = roundNumber;
+        queueOutput(c);
+    }
+}
+
+static void putError(string& out, uint32_t tag, const string& message) {
+    FrameWriter error(out, MSG_ERROR, tag);
+    error.putString(message);
+    error.finish();
+}
+
+static void replyError(Connection& c, uint32_t tag, const string& message) {
+    putError(c.out, tag, message);
+}
+
+// Reply with a student after changing it, and tell the subscribers
+static void replyChanged(Connection& c, uint32_t tag, int index) {
+    FrameWriter out(c.out, MSG_OK, tag);
+    out.putStudent(students, index);
+    out.finish();
+    broadcastStudent(index, &c);
+}
+
+/**
+ * First course slot of a student with exactly this name, or -1
+ */
+static int courseSlot(int index, string_view name) {
+    int nameId = courseNames.find(name);
+    const Course* courses = students.courses(index);
+    for (int c = 0; c < students[index].numCourses; c++) {
+        if (courses[c].nameId == nameId) return c;
+    }
+    return -1;
+}
+
+static int planSlot(int index, string_view entry) {
+    int nameId = courseNames.find(entry);
+    const int* studyPlan = students.studyPlan(index);
+    for (int p = 0; p < students[index].numStudyPlan; p++) {
+        if (studyPlan[p] == nameId) return p;
+    }
+    return -1;
+}
+
+static bool isRead(uint8_t kind) {
+    return kind == REQUEST_GET || kind == REQUEST_SEARCH;
+}
+
+/**
+ * Answer a read from a store that nobody changes meanwhile
+ */
+static void answerRead(const StudentStore& store, const Frame& frame, string& out) {
+    FrameReader in(frame);
+    if (frame.kind == REQUEST_GET) {
+        int id = in.getInt();
+        if (in.atEnd()) {
+            int index = store.find(id);
+            if (index == -1) {
+                putError(out, frame.tag, "Student not found");
+                return;
+            }
+            FrameWriter reply(out, MSG_OK, frame.tag);
+            reply.putStudent(store, index);
+            reply.finish();
+            return;
+        }
+    } else {
+        string query(in.getString());
+        int offset = in.getInt();
+        int limit = in.getInt();
+        if (in.atEnd() && offset >= 0 && limit >= 0) {
+            vector<int> matches;
+            int total = store.searchNames(query, offset, min(limit, MAX_SEARCH_RESULTS), matches);
+            FrameWriter reply(out, MSG_OK, frame.tag);
+            reply.putInt(total);
+            reply.putInt((int)matches.size());
+            for (int match : matches) reply.putStudent(store, match);
+            reply.finish();
+            return;
+        }
+    }
+    putError(out, frame.tag, "malformed request");
+}
+
+/**
+ * Handle one request and append its reply
+ */
+static void handleRequest(Connection& c, const Frame& frame) {
+    FrameReader in(frame);
+    uint32_t tag = frame.tag;
+    if (frame.kind < REQUEST_SUBSCRIBE || frame.kind > REQUEST_EDIT) {
+        replyError(c, tag, "unknown request");
+        return;
+    }
+    if (isRead(frame.kind)) {
+        students.prepareForReaders();   // The const calls want the indexes current
+        answerRead(students, frame, c.out);
+        return;
+    }
+    c.changedIn = roundNumber;
+
+    // Every request but these starts with the ID of an existing student
+    int index = -1;
+    bool needsStudent = frame.kind != REQUEST_SUBSCRIBE && frame.kind != REQUEST_ADD &&
+                        frame.kind != REQUEST_IMPORT_GRADES;
+    int id = needsStudent ? in.getInt() : 0;
+
+    switch (frame.kind) {
+        case REQUEST_SUBSCRIBE: {
+            if (!in.atEnd()) break;
+            // Every student as a push of its own, so no frame grows with the store
+            c.subscribed = true;
+            FrameWriter start(c.out, MSG_SNAPSHOT, 0);
+            start.finish();
+            for (int i = 0; i < students.size(); i++) {
+                FrameWriter push(c.out, MSG_CHANGED, 0);
+                push.putStudent(students, i);
+                push.finish();
+            }
+            FrameWriter out(c.out, MSG_OK, tag);
+            out.putInt(students.size());
+            out.finish();
+            return;
+        }
+        case REQUEST_ADD: {
+            Student s;
+            s.id = in.getInt();
+            s.name = string(in.getString());
+            s.nationalId = string(in.getString());
+            if (!in.atEnd()) break;
+            index = students.add(s);
+            if (index == -1) {
+                replyError(c, tag, "ID already exists");
+                return;
+            }
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_IMPORT_GRADES: {
+            int count = in.getInt();
+            if (!in.ok || count < 0 || count > (in.end - in.pos) / 8) break;
+            vector<GradeSheet> sheets(count);
+            for (GradeSheet& sheet : sheets) {
+                sheet.path = string(in.getString());
+                sheet.course = string(in.getString());
+            }
+            if (!in.atEnd()) break;
+            GradeImportReport report = importGradeSheets(sheets, students);
+            // The reply carries no students, so the importing client is told
+            // too, before the reply so that it has them once the reply comes.
+            // A bulk import would queue more than a slow subscriber may hold,
+            // so then everyone reloads once instead.
+            if ((int)report.updatedIds.size() > MAX_CHANGE_PUSHES) {
+                broadcastReload();
+            } else {
+                for (int updated : report.updatedIds) broadcastStudent(students.find(updated), nullptr);
+            }
+            FrameWriter out(c.out, MSG_OK, tag);
+            putImportReport(out, report);
+            out.finish();
+            return;
+        }
+        default:
+            break;
+    }
+    if (!needsStudent || !in.ok) {
+        replyError(c, tag, "malformed request");
+        return;
+    }
+    index = students.find(id);
+    if (index == -1) {
+        replyError(c, tag, "Student not found");
+        return;
+    }
+
+    switch (frame.kind) {
+        case REQUEST_DELETE: {
+            if (!in.atEnd()) break;
+            students.remove(index);
+            FrameWriter out(c.out, MSG_OK, tag);
+            out.finish();
+            broadcastDelete(id, &c);
+            return;
+        }
+        case REQUEST_EDIT: {
+            vector<EditChange> changes;
+            if (!getEditChanges(in, changes) || !in.atEnd()) break;
+            vector<Course> courses;
+            vector<int> plan;
+            string error;
+            if (!replayEdit(students, index, changes, courses, plan, error)) {
+                replyError(c, tag, error);
+                return;
+            }
+            students.setCoursesAndPlan(index, courses.data(), (int)courses.size(), plan.data(), (int)plan.size());
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_SET_NAME: {
+            string_view name = in.getString();
+            if (!in.atEnd()) break;
+            students.setName(index, string(name));
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_SET_NATIONAL_ID: {
+            string_view nationalId = in.getString();
+            if (!in.atEnd()) break;
+            students.setNationalId(index, string(nationalId));
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_ADD_COURSE:
+        case REQUEST_SET_GRADE: {
+            string_view name = in.getString();
+            float grade = in.getFloat();
+            if (!in.atEnd()) break;
+            if (!(grade >= 0.0f && grade <= 100.0f)) {
+                replyError(c, tag, "Grade must be between 0 and 100");
+                return;
+            }
+            Course course(name, grade);
+            bool adds = frame.kind == REQUEST_ADD_COURSE;
+            if (!adds) {
+                // Regrades the course if the student takes it under any spelling
+                adds = true;
+                const Course* courses = students.courses(index);
+                for (int k = 0; k < students[index].numCourses && adds; k++) {
+                    adds = courseNames.folded(courses[k].nameId) != courseNames.folded(course.nameId);
+                }
+            }
+            if (adds && students[index].numCourses >= MAX_COURSES) {
+                replyError(c, tag, "Maximum courses reached");
+                return;
+            }
+            if (frame.kind == REQUEST_ADD_COURSE) students.addCourse(index, course);
+            else students.setCourseGrades(index, &course, 1);
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_REMOVE_COURSE: {
+            string_view name = in.getString();
+            if (!in.atEnd()) break;
+            int slot = courseSlot(index, name);
+            if (slot == -1) {
+                replyError(c, tag, "Course not found");
+                return;
+            }
+            students.removeCourse(index, slot);
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_ADD_PLAN_ENTRY: {
+            string_view entry = in.getString();
+            if (!in.atEnd()) break;
+            if (students[index].numStudyPlan >= MAX_STUDY_PLAN) {
+                replyError(c, tag, "Study plan is full");
+                return;
+            }
+            students.addStudyPlanEntry(index, entry);
+            replyChanged(c, tag, index);
+            return;
+        }
+        case REQUEST_REMOVE_PLAN_ENTRY: {
+            string_view entry = in.getString();
+            if (!in.atEnd()) break;
+            int slot = planSlot(index, entry);
+            if (slot == -1) {
+                replyError(c, tag, "Study plan entry not found");
+                return;
+            }
+            students.removeStudyPlanEntry(index, slot);
+            replyChanged(c, tag, index);
+            return;
+        }
+        default:
+            break;
+    }
+    replyError(c, tag, "malformed request");
+}
+
+/**
+ * Read what a client sent and handle its complete requests; returns false
+ * if the connection has to be closed
+ */
+static bool readRequests(Connection& c, vector<ReadTask>& reads) {
+    char chunk[65536];
+    while (true) {
+        ssize_t n = read(c.fd, chunk, sizeof(chunk));
+        if (n > 0) {
+            c.in.append(chunk, n);
+            continue;
+        }
+        if (n == 0) return false;   // The client hung up
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        return false;
+    }
+
+    size_t used = 0;
+    Frame frame;
+    int result;
+    while ((result = parseFrame(c.in.data() + used, c.in.size() - used, frame)) == 1) {
+        // The replicas are a round behind: a client that has made or been
+        // sent a change this round reads from the store itself
+        if (!readerThreads.empty() && isRead(frame.kind) && c.changedIn != roundNumber) {
+            reads.push_back({ c.fd, c.out.size(), string(c.in.data() + used, frame.frameBytes), string() });
+        } else {
+            handleRequest(c, frame);
+        }
+        used += frame.frameBytes;
+    }
+    c.in.erase(0, used);
+    if (!c.out.empty()) queueOutput(c);
+    return result == 0;   // -1: not a frame, the client does not speak the protocol
+}
+
+/**
+ * Reader thread: answers the reads of each round from the current replica
+ */
+static void answerReads() {
+    StudentReplicas::Reader reader(replicas);
+    uint64_t seen = 0;
+    unique_lock<mutex> lock(readMutex);
+    while (true) {
+        readWake.wait(lock, [&] { return readersStop || readGeneration != seen; });
+        if (readersStop) return;
+        seen = readGeneration;
+        busyReaders++;
+        lock.unlock();
+
+        size_t answered = 0;
+        {
+            StudentReplicas::View view(reader);
+            size_t next;
+            while ((next = nextRead.fetch_add(1, memory_order_relaxed)) < readRound.size()) {
+                ReadTask& task = readRound[next];
+                Frame frame;
+                parseFrame(task.request.data(), task.request.size(), frame);
+                answerRead(view.store, frame, task.reply);
+                answered++;
+            }
+        }
+
+        lock.lock();
+        busyReaders--;
+        readsAnswered += answered;
+        if (busyReaders == 0) readIdle.notify_all();
+    }
+}
+
+/**
+ * Hand a round of reads to the reader threads
+ */
+static void startReads(vector<ReadTask>& reads) {
+    if (reads.empty()) return;
+    unique_lock<mutex> lock(readMutex);
+    readIdle.wait(lock, [] { return busyReaders == 0; });   // Late wakers of the last round
+    readRound.swap(reads);
+    nextRead.store(0, memory_order_relaxed);
+    readsAnswered = 0;
+    readGeneration++;
+    readWake.notify_all();
+}
+
+/**
+ * Wait for the reads of the round and put each reply where its request was
+ */
+static void finishReads(vector<ReadTask>& reads) {
+    {
+        unique_lock<mutex> lock(readMutex);
+        readIdle.wait(lock, [] { return readsAnswered == readRound.size() && busyReaders == 0; });
+        reads.swap(readRound);
+        readRound.clear();
+        readsAnswered = 0;
+    }
+    // A connection's reads are next to each other, in request order
+    for (size_t first = 0, last; first < reads.size(); first = last) {
+        int fd = reads[first].fd;
+        for (last = first; last < reads.size() && reads[last].fd == fd; last++) {}
+        auto found = connections.find(fd);
+        if (found == connections.end()) continue;   // Closed this round
+        Connection& c = found->second;
+        string out;
+        size_t copied = 0;
+        for (size_t t = first; t < last; t++) {
+            out.append(c.out, copied, reads[t].at - copied);
+            out += reads[t].reply;
+            copied = reads[t].at;
+        }
+        out.append(c.out, copied, string::npos);
+        c.out.swap(out);
+        queueOutput(c);
+    }
+    reads.clear();
+}
+
+static void stopReaders() {
+    {
+        lock_guard<mutex> lock(readMutex);
+        readersStop = true;
+    }
+    readWake.notify_all();
+    for (thread& t : readerThreads) t.join();
+    readerThreads.clear();
+}
+
+/**
+ * Send as much pending output as the socket takes; returns false if the
+ * connection has to be closed
+ */
+static bool writeOutput(Connection& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+    if (c.sent == c.out.size()) {
+        c.out.clear();
+        c.sent = 0;
+    } else if (c.out.size() - c.sent > MAX_PENDING_OUTPUT) {
+        return false;
+    } else if (c.sent > (1 << 20)) {
+        c.out.erase(0, c.sent);   // Do not let sent bytes pile up at the front
+        c.sent = 0;
+    }
+
+    // Wait for the socket to drain only while output is left over
+    bool pending = !c.out.empty();
+    if (pending != c.writing) {
+        epoll_event event = {};
+        event.events = pending ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = c.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &event);
+        c.writing = pending;
+    }
+    return true;
+}
+
+static void acceptClients(int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;   // EAGAIN once every pending client is accepted
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        connections[fd].fd = fd;
+    }
+}
+
+/**
+ * Create the listening socket, replacing a stale socket file but not a live server
+ */
+static int listenOn(const char* path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        cout << "Error: Socket path " << path << " is too long.\n";
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (sockaddr*)&address, sizeof(address)) == 0) {
+        close(probe);
+        cout << "Error: A server is already running on " << path << ".\n";
+        return -1;
+    }
+    if (probe >= 0) close(probe);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        cout << "Error: Could not listen on " << path << ": " << strerror(errno) << ".\n";
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Main function - serves clients until SIGINT or SIGTERM
+ */
+int main(int argc, char* argv[]) {
+    // A reader thread per CPU the loop thread leaves; none on a single CPU,
+    // where they could only take turns with it
+    int numReaders = max(0, (int)thread::hardware_concurrency() - 1);
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "--readers") == 0) {
+        numReaders = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg > 1 || numReaders < 0) {
+        cout << "Usage: " << argv[0] << " [--readers N] [socket]\n";
+        return 2;
+    }
+    const char* path = arg < argc ? argv[arg] : SERVER_SOCKET_FILENAME;
+
+    struct sigaction action = {};
+    action.sa_handler = requestStop;   // No SA_RESTART: epoll_wait returns at once
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    loadStudents();
+    int listenFd = listenOn(path);
+    if (listenFd < 0) return 1;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event listenEvent = {};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent);
+    if (numReaders > 0) {
+        replicas.attach(students);
+        for (int r = 0; r < numReaders; r++) readerThreads.emplace_back(answerReads);
+    }
+    cout << "Serving " << students.size() << " students on " << path << " with " << numReaders
+         << " reader threads.\n";
+    cout.flush();
+
+    epoll_event events[MAX_EVENTS];
+    vector<ReadTask> reads;
+    while (!stopRequested) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        if (ready < 0 && errno != EINTR) {
+            cout << "Error: epoll_wait failed: " << strerror(errno) << ".\n";
+            break;
+        }
+        roundNumber++;
+
+        vector<int> closing;
+        for (int e = 0; e < ready; e++) {
+            int fd = events[e].data.fd;
+            if (fd == listenFd) {
+                acceptClients(listenFd);
+                continue;
+            }
+            auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            Connection& c = found->second;
+            if ((events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readRequests(c, reads)) {
+                closing.push_back(fd);
+                continue;
+            }
+            if (events[e].events & EPOLLOUT) queueOutput(c);
+        }
+        for (int fd : closing) closeConnection(fd);
+
+        // One commit makes the whole round durable before anyone hears of it;
+        // the reads are answered meanwhile, and then the round's changes are
+        // published for the next one
+        startReads(reads);
+        bool committed = flushList.empty() || commitChanges();
+        if (committed && replicas.attached()) replicas.publish();
+        finishReads(reads);
+        if (!committed) {
+            // Neither the journal nor a snapshot could be written. Nobody may
+            // hear of the round's changes, so the clients that made or were
+            // sent one are dropped unanswered and the server stops.
+            cout << "Error: Could not save changes, stopping.\n";
+            vector<int> changed;
+            for (auto& entry : connections) {
+                if (entry.second.changedIn == roundNumber) changed.push_back(entry.first);
+            }
+            for (int fd : changed) closeConnection(fd);
+            stopRequested = 1;
+        }
+        vector<int> flushing;
+        flushing.swap(flushList);
+        for (int fd : flushing) {
+            auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            found->second.queued = false;
+            if (!writeOutput(found->second)) closeConnection(fd);
+        }
+        checkpointIfNeeded();
+    }
+
+    stopReaders();
+    replicas.detach();
+    for (auto& entry : connections) close(entry.first);
+    connections.clear();
+    close(listenFd);
+    unlink(path);
+    saveStudents();
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * Student Snapshot Module
+ *
+ * This file contains the writer and the memory-mapped reader of the
+ * binary snapshot format described in student_snapshot.h.
+ */
+
+#include "student_snapshot.h"   // Include snapshot declarations
+#include "student_parser.h"     // Include MappedFile
+#include "student_journal.h"    // Include crc32
+#include <fstream>              // Include for writing the snapshot
+#include <cstring>              // Include for memcpy and memcmp
+#include <string_view>          // Include for views of the string section
+
+static const char SNAPSHOT_MAGIC[8] = { 'S', 'I', 'S', 'S', 'N', 'A', 'P', '1' };
+static const int SNAPSHOT_SECTIONS = 4;
+
+/**
+ * Round a file offset up to the section alignment
+ */
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+/**
+ * Builds the STRINGS section
+ *
+ * Course names and study plan entries repeat across students, so each
+ * interned name is stored once; names and national IDs are nearly always
+ * unique and are appended without a lookup.
+ */
+struct StringTable {
+    string bytes;                                          // Section contents
+    vector<SnapshotString> names;                          // Reference per courseNames ID, if written
+    vector<char> written;                                  // Whether names[id] is set
+    bool overflow = false;                                 // Set when offsets no longer fit 32 bits
+
+    SnapshotString append(string_view value) {
+        SnapshotString ref;
+        if (bytes.size() + value.size() > UINT32_MAX) {
+            overflow = true;
+            ref.offset = ref.length = 0;
+            return ref;
+        }
+        ref.offset = (uint32_t)bytes.size();
+        ref.length = (uint32_t)value.size();
+        bytes.append(value);
+        return ref;
+    }
+
+    SnapshotString name(int nameId) {
+        if (nameId >= (int)names.size()) {
+            names.resize(courseNames.size());
+            written.resize(courseNames.size(), 0);
+        }
+        if (!written[nameId]) {
+            names[nameId] = append(courseNames.view(nameId));
+            written[nameId] = 1;
+        }
+        return names[nameId];
+    }
+};
+
+bool writeStudentSnapshot(const char* path, const StudentStore& store) {
+    StringTable strings;
+    vector<SnapshotStudent> records(store.size());
+    vector<SnapshotCourse> courses;
+    vector<SnapshotString> studyPlan;
+
+    for (int i = 0; i < store.size(); i++) {
+        const Student& s = store[i];
+        const Course* studentCourses = store.courses(i);
+        const int* studentPlan = store.studyPlan(i);
+
+        SnapshotStudent& r = records[i];
+        r.id = s.id;
+        r.gpa = s.gpa;
+        r.name = strings.append(s.name);
+        r.nationalId = strings.append(s.nationalId);
+        r.firstCourse = (uint32_t)courses.size();
+        r.numCourses = (uint32_t)s.numCourses;
+        r.firstPlanEntry = (uint32_t)studyPlan.size();
+        r.numStudyPlan = (uint32_t)s.numStudyPlan;
+        for (int c = 0; c < s.numCourses; c++) {
+            courses.push_back(SnapshotCourse{ strings.name(studentCourses[c].nameId),
+                                              studentCourses[c].grade });
+        }
+        for (int p = 0; p < s.numStudyPlan; p++) {
+            studyPlan.push_back(strings.name(studentPlan[p]));
+        }
+    }
+    if (strings.overflow) return false;
+
+    // Section table, then the sections in table order
+    const char* contents[SNAPSHOT_SECTIONS] = {
+        strings.bytes.data(), (const char*)records.data(),
+        (const char*)courses.data(), (const char*)studyPlan.data()
+    };
+    SnapshotSection sections[SNAPSHOT_SECTIONS] = {
+        { SNAPSHOT_STRINGS, 0, 0, strings.bytes.size(), strings.bytes.size() },
+        { SNAPSHOT_STUDENTS, 0, 0, records.size() * sizeof(SnapshotStudent), records.size() },
+        { SNAPSHOT_COURSES, 0, 0, courses.size() * sizeof(SnapshotCourse), courses.size() },
+        { SNAPSHOT_PLAN, 0, 0, studyPlan.size() * sizeof(SnapshotString), studyPlan.size() }
+    };
+    uint64_t offset = alignSection(sizeof(SnapshotHeader) + sizeof(sections));
+    for (SnapshotSection& section : sections) {
+        section.offset = offset;
+        section.crc = crc32(contents[&section - sections], section.size);
+        offset = alignSection(offset + section.size);
+    }
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.sectionCount = SNAPSHOT_SECTIONS;
+    header.tableCrc = crc32((const char*)sections, sizeof(sections));
+    header.reserved = 0;
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)sections, sizeof(sections));
+    uint64_t written = sizeof(header) + sizeof(sections);
+    static const char padding[8] = {};
+    for (int i = 0; i < SNAPSHOT_SECTIONS; i++) {
+        file.write(padding, sections[i].offset - written);
+        file.write(contents[i], sections[i].size);
+        written = sections[i].offset + sections[i].size;
+    }
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * Whether a string reference lies inside the STRINGS section
+ */
+static bool validString(const SnapshotString& ref, uint64_t stringBytes) {
+    return (uint64_t)ref.offset + ref.length <= stringBytes;
+}
+
+bool loadStudentSnapshot(const char* path, StudentStore& store, string& error) {
+    error.clear();
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* data = file.data();
+    uint64_t size = file.size();
+
+    SnapshotHeader header;
+    if (size < sizeof(header) || memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        error = "not a student snapshot";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.version == 0 || header.version > SNAPSHOT_VERSION) {
+        error = "unsupported snapshot version " + to_string(header.version);
+        return false;
+    }
+    uint64_t tableBytes = (uint64_t)header.sectionCount * sizeof(SnapshotSection);
+    if (tableBytes > size - sizeof(header) ||
+        crc32(data + sizeof(header), tableBytes) != header.tableCrc) {
+        error = "corrupt section table";
+        return false;
+    }
+
+    // Locate the known sections; unknown tags are skipped
+    const SnapshotSection* table = (const SnapshotSection*)(data + sizeof(header));
+    const SnapshotSection* found[SNAPSHOT_SECTIONS + 1] = {};
+    const uint64_t recordSize[SNAPSHOT_SECTIONS + 1] = {
+        0, 1, sizeof(SnapshotStudent), sizeof(SnapshotCourse), sizeof(SnapshotString)
+    };
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+        const SnapshotSection& section = table[i];
+        if (section.tag < SNAPSHOT_STRINGS || section.tag > SNAPSHOT_PLAN) continue;
+        if (section.offset % 8 != 0 || section.offset > size || section.size > size - section.offset ||
+            section.count != section.size / recordSize[section.tag] ||
+            section.size % recordSize[section.tag] != 0) {
+            error = "section " + to_string(section.tag) + " out of bounds";
+            return false;
+        }
+        if (crc32(data + section.offset, section.size) != section.crc) {
+            error = "checksum mismatch in section " + to_string(section.tag);
+            return false;
+        }
+        found[section.tag] = &section;
+    }
+    for (uint32_t tag = SNAPSHOT_STRINGS; tag <= SNAPSHOT_PLAN; tag++) {
+        if (found[tag] == nullptr) {
+            error = "missing section " + to_string(tag);
+            return false;
+        }
+    }
+
+    // Sections are 8-byte aligned in a page-aligned mapping, so records are read in place
+    const char* strings = data + found[SNAPSHOT_STRINGS]->offset;
+    uint64_t stringBytes = found[SNAPSHOT_STRINGS]->size;
+    const SnapshotStudent* records = (const SnapshotStudent*)(data + found[SNAPSHOT_STUDENTS]->offset);
+    uint64_t numRecords = found[SNAPSHOT_STUDENTS]->count;
+    const SnapshotCourse* courses = (const SnapshotCourse*)(data + found[SNAPSHOT_COURSES]->offset);
+    uint64_t numCourses = found[SNAPSHOT_COURSES]->count;
+    const SnapshotString* studyPlan = (const SnapshotString*)(data + found[SNAPSHOT_PLAN]->offset);
+    uint64_t numPlan = found[SNAPSHOT_PLAN]->count;
+
+    // Check every reference before touching the store
+    for (uint64_t i = 0; i < numRecords; i++) {
+        const SnapshotStudent& r = records[i];
+        if (!validString(r.name, stringBytes) || !validString(r.nationalId, stringBytes) ||
+            (uint64_t)r.firstCourse + r.numCourses > numCourses ||
+            (uint64_t)r.firstPlanEntry + r.numStudyPlan > numPlan) {
+            error = "invalid student record " + to_string(i);
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < numCourses; i++) {
+        if (!validString(courses[i].name, stringBytes)) {
+            error = "invalid course record " + to_string(i);
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < numPlan; i++) {
+        if (!validString(studyPlan[i], stringBytes)) {
+            error = "invalid study plan record " + to_string(i);
+            return false;
+        }
+    }
+
+    store.reserve(store.size() + (int)numRecords, (int)numCourses, (int)numPlan);
+    int duplicates = 0;
+    for (uint64_t i = 0; i < numRecords; i++) {
+        const SnapshotStudent& r = records[i];
+        Student s;
+        s.id = r.id;
+        s.gpa = r.gpa;
+        s.name.assign(strings + r.name.offset, r.name.length);
+        s.nationalId.assign(strings + r.nationalId.offset, r.nationalId.length);
+        int index = store.add(std::move(s));
+        if (index == -1) {
+            duplicates++;
+            continue;
+        }
+        for (uint32_t c = 0; c < r.numCourses; c++) {
+            const SnapshotCourse& course = courses[r.firstCourse + c];
+            store.addCourse(index, Course(string_view(strings + course.name.offset, course.name.length),
+                                          course.grade));
+        }
+        for (uint32_t p = 0; p < r.numStudyPlan; p++) {
+            const SnapshotString& entry = studyPlan[r.firstPlanEntry + p];
+            store.addStudyPlanEntry(index, string_view(strings + entry.offset, entry.length));
+        }
+    }
+    if (duplicates > 0) error = to_string(duplicates) + " duplicate student IDs skipped";
+    return true;
+}
@@ -0,0 +1,102 @@
+/**
+ * student_snapshot.h - Versioned binary snapshot of the student store
+ *
+ * Unlike the students.txt format, the snapshot has no delimiters to escape
+ * and stores grades as raw floats. The file is memory-mapped and read in
+ * place: loading walks fixed-width records and copies out the strings, with
+ * no tokenising or number parsing.
+ *
+ * File layout (native byte order, every section aligned to 8 bytes):
+ *   header:         SnapshotHeader, followed by sectionCount SnapshotSections
+ *   STRINGS:        bytes of every string, back to back (repeated course
+ *                   names and study plan entries are stored once)
+ *   STUDENTS:       SnapshotStudent records
+ *   COURSES:        SnapshotCourse records, grouped by student
+ *   PLAN:           SnapshotString records, grouped by student
+ *
+ * The section table is covered by a CRC-32 in the header and each section by
+ * its own CRC-32. Readers skip sections with unknown tags, so new sections can
+ * be added without a version change; the version is only raised when existing
+ * records change meaning, and readers refuse versions newer than their own.
+ */
+
+#ifndef STUDENT_SNAPSHOT_H
+#define STUDENT_SNAPSHOT_H
+
+#include "student.h"   // Include student structure definitions
+#include <cstdint>     // Include for fixed-width integers
+
+const uint32_t SNAPSHOT_VERSION = 1;   // Version written by this build
+
+/**
+ * File header
+ */
+struct SnapshotHeader {
+    char magic[8];           // "SISSNAP1"
+    uint32_t version;        // SNAPSHOT_VERSION of the writer
+    uint32_t sectionCount;   // Entries in the section table that follows
+    uint32_t tableCrc;       // CRC-32 of the section table
+    uint32_t reserved;       // Zero
+};
+
+/**
+ * Section tags
+ */
+enum SnapshotSectionTag : uint32_t {
+    SNAPSHOT_STRINGS = 1,
+    SNAPSHOT_STUDENTS = 2,
+    SNAPSHOT_COURSES = 3,
+    SNAPSHOT_PLAN = 4
+};
+
+/**
+ * Entry of the section table
+ */
+struct SnapshotSection {
+    uint32_t tag;            // SnapshotSectionTag
+    uint32_t crc;            // CRC-32 of the section bytes
+    uint64_t offset;         // Start of the section in the file
+    uint64_t size;           // Length of the section in bytes
+    uint64_t count;          // Number of records (bytes for STRINGS)
+};
+
+/**
+ * Reference to a string in the STRINGS section
+ */
+struct SnapshotString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * Fixed-width student record
+ */
+struct SnapshotStudent {
+    int32_t id;
+    float gpa;
+    SnapshotString name;
+    SnapshotString nationalId;
+    uint32_t firstCourse;    // Index into the COURSES section
+    uint32_t numCourses;
+    uint32_t firstPlanEntry; // Index into the PLAN section
+    uint32_t numStudyPlan;
+};
+
+/**
+ * Fixed-width course record
+ */
+struct SnapshotCourse {
+    SnapshotString name;
+    float grade;
+};
+
+// Write a store as a binary snapshot, returns false if the file cannot be written
+bool writeStudentSnapshot(const char* path, const StudentStore& store);
+
+// Load a binary snapshot into a store. Returns false if the file is missing
+// (error left empty) or invalid (error describes why; nothing is loaded then,
+// since every record is checked before the store is touched). Duplicate IDs
+// are skipped and reported in error while still returning true.
+bool loadStudentSnapshot(const char* path, StudentStore& store, string& error);
+
+#endif // STUDENT_SNAPSHOT_H
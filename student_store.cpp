@@ -0,0 +1,643 @@
+/**
+ * Student Store Module
+ *
+ * This file contains the implementation of the growable student store
+ * and the block management of its shared course and study plan pools.
+ */
+
+#include "student.h"   // Include student structure definitions
+#include "student_journal.h" // Include the journal the store reports changes to
+#include <utility>     // Include for std::move
+#include <algorithm>   // Include for lower_bound, rotate and remove_if
+
+/**
+ * Append a value to a block of a shared pool
+ *
+ * A block that is already at the end of the pool simply grows in place.
+ * Otherwise it is moved to the end of the pool and its old slots are
+ * counted as waste until the next compaction.
+ */
+template <typename T>
+static void appendToBlock(vector<T>& pool, int& offset, int& count, int& capacity,
+                          int& wasted, T value) {
+    if (count == capacity) {
+        if (offset + capacity == (int)pool.size()) {
+            pool.resize(pool.size() + 1);          // Tail block: extend in place
+        } else {
+            int newOffset = (int)pool.size();      // Move the block to the end
+            pool.resize(pool.size() + count + 1);
+            for (int i = 0; i < count; i++) {
+                pool[newOffset + i] = std::move(pool[offset + i]);
+            }
+            wasted += capacity;
+            offset = newOffset;
+            capacity = count;
+        }
+        capacity++;
+    }
+    pool[offset + count++] = std::move(value);
+}
+
+/**
+ * Remove one entry from a block, keeping the order of the remaining entries
+ */
+template <typename T>
+static void removeFromBlock(vector<T>& pool, int offset, int& count, int position) {
+    for (int i = position; i < count - 1; i++) {
+        pool[offset + i] = std::move(pool[offset + i + 1]);
+    }
+    pool[offset + count - 1] = T();   // Release the moved-from slot
+    count--;
+}
+
+/**
+ * Approximate heap bytes owned by a string (zero while it fits the small buffer)
+ */
+static size_t stringHeapBytes(const string& s) {
+    static const size_t inlineCapacity = string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+int StudentStore::add(Student s) {
+    if (idIndex.find(s.id) != -1) return -1;   // IDs are unique
+
+    s.numCourses = 0;
+    s.numStudyPlan = 0;
+    s.courseOffset = (int)coursePool.size();  // Empty blocks start at the pool ends
+    s.courseCapacity = 0;
+    s.planOffset = (int)planPool.size();
+    s.planCapacity = 0;
+    int index = (int)records.size();
+    s.handleEntry = takeHandle(index);
+    idIndex.insert(s.id, index);
+    if (nameIndexReady) nameIndex.insert(s.handleEntry, s.name);
+    records.push_back(std::move(s));
+    insertIntoOrders(index);
+    if (journal) journal->logStudent(JOURNAL_ADD, *this, index);
+    noteChange(index);
+    return index;
+}
+
+int StudentStore::takeHandle(int index) {
+    // Reuse a freed handle entry when possible
+    if (!freeHandles.empty()) {
+        int entry = freeHandles.back();
+        freeHandles.pop_back();
+        handleSlots[entry] = index;
+        return entry;
+    }
+    handleSlots.push_back(index);
+    handleGenerations.push_back(0);
+    return (int)handleSlots.size() - 1;
+}
+
+int StudentStore::appendBuilt(vector<Student>& batch, const Course* courses, const int* plan,
+                              vector<int>& rejected) {
+    // A fresh store maintains nothing yet, so appending is copying
+    bool maintained = nameIndexReady || catalogReady || rankingReady;
+    for (bool ready : orderReady) maintained = maintained || ready;
+
+    int appended = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        Student& s = batch[i];
+        const Course* studentCourses = courses;
+        const int* studentPlan = plan;
+        courses += s.numCourses;
+        plan += s.numStudyPlan;
+        if (idIndex.find(s.id) != -1) {   // IDs are unique
+            rejected.push_back((int)i);
+            continue;
+        }
+
+        s.courseOffset = (int)coursePool.size();
+        s.courseCapacity = s.numCourses;
+        coursePool.insert(coursePool.end(), studentCourses, studentCourses + s.numCourses);
+        s.planOffset = (int)planPool.size();
+        s.planCapacity = s.numStudyPlan;
+        planPool.insert(planPool.end(), studentPlan, studentPlan + s.numStudyPlan);
+        int index = (int)records.size();
+        s.handleEntry = takeHandle(index);
+        idIndex.insert(s.id, index);
+        records.push_back(std::move(s));
+        if (maintained) {
+            if (nameIndexReady) nameIndex.insert(records[index].handleEntry, records[index].name);
+            insertIntoOrders(index);
+            if (catalogReady) enrollInCatalog(index);
+            rank(index);
+        }
+        if (journal) journal->logStudent(JOURNAL_ADD, *this, index);
+        noteChange(index);
+        appended++;
+    }
+    return appended;
+}
+
+void StudentStore::releaseStudent(Student& s) {
+    for (int i = 0; i < s.numCourses; i++) coursePool[s.courseOffset + i] = Course();
+    for (int i = 0; i < s.numStudyPlan; i++) planPool[s.planOffset + i] = 0;
+    wastedCourses += s.courseCapacity;
+    wastedPlanEntries += s.planCapacity;
+    idIndex.erase(s.id);
+    if (nameIndexReady) nameIndex.erase(s.name);
+
+    handleSlots[s.handleEntry] = -1;
+    handleGenerations[s.handleEntry]++;   // Outstanding handles become stale
+    freeHandles.push_back(s.handleEntry);
+}
+
+void StudentStore::remove(int index) {
+    if (journal) journal->logDelete(records[index].id);
+    noteChange(index);
+    eraseFromOrders(index);
+    unrank(index);
+    withdrawFromCatalog(index);
+    releaseStudent(records[index]);
+
+    // Swap-and-pop: the last student moves into the freed slot
+    int last = (int)records.size() - 1;
+    if (index != last) {
+        records[index] = std::move(records[last]);
+        handleSlots[records[index].handleEntry] = index;
+        idIndex.insert(records[index].id, index);
+    }
+    records.pop_back();
+    compactIfWasteful();
+}
+
+int StudentStore::removeBatch(const vector<int>& ids) {
+    // Mark the students to delete through the ID index
+    vector<char> doomed(records.size(), 0);
+    int marked = 0;
+    for (int id : ids) {
+        int index = idIndex.find(id);
+        if (index != -1 && !doomed[index]) {
+            doomed[index] = 1;
+            marked++;
+        }
+    }
+    if (marked == 0) return 0;
+
+    // Filter the maintained orders in one pass each instead of erasing one by one
+    for (int by = 0; by < NUM_STUDENT_ORDERS; by++) {
+        if (!orderReady[by]) continue;
+        vector<int>& order = orders[by];
+        order.erase(std::remove_if(order.begin(), order.end(),
+                                   [&](int entry) { return doomed[handleSlots[entry]] != 0; }),
+                    order.end());
+    }
+    if (catalogReady) {
+        for (int i = 0; i < (int)records.size(); i++) {
+            if (!doomed[i]) continue;
+            const Course* studentCourses = coursePool.data() + records[i].courseOffset;
+            for (int c = 0; c < records[i].numCourses; c++) {
+                catalog.withdraw(catalog.find(studentCourses[c].nameId), records[i].handleEntry,
+                                 studentCourses[c].grade, false);
+            }
+        }
+        catalog.withdrawAll(doomed, handleSlots);
+    }
+    if (rankingReady) ranking.withdrawAll(doomed, handleSlots);
+
+    // One linear pass: survivors slide down, keeping their relative order
+    int kept = 0;
+    for (int i = 0; i < (int)records.size(); i++) {
+        if (doomed[i]) {
+            if (journal) journal->logDelete(records[i].id);
+            noteChange(i);
+            releaseStudent(records[i]);
+            continue;
+        }
+        if (kept != i) {
+            records[kept] = std::move(records[i]);
+            handleSlots[records[kept].handleEntry] = kept;
+            idIndex.insert(records[kept].id, kept);
+        }
+        kept++;
+    }
+    records.resize(kept);
+    compactIfWasteful();
+    return marked;
+}
+
+StudentHandle StudentStore::handleOf(int index) const {
+    int entry = records[index].handleEntry;
+    return ((StudentHandle)handleGenerations[entry] << 32) | (unsigned)entry;
+}
+
+int StudentStore::indexOf(StudentHandle handle) const {
+    if (handle == INVALID_HANDLE) return -1;
+    unsigned entry = (unsigned)(handle & 0xffffffffu);
+    unsigned generation = (unsigned)(handle >> 32);
+    if (entry >= handleSlots.size() || handleGenerations[entry] != generation) return -1;
+    return handleSlots[entry];
+}
+
+void StudentStore::findBatch(const vector<int>& ids, vector<int>& indices) const {
+    indices.resize(ids.size());
+    if (!ids.empty()) idIndex.findBatch(ids.data(), (int)ids.size(), indices.data());
+}
+
+void StudentStore::clear() {
+    for (const Student& s : records) {
+        handleSlots[s.handleEntry] = -1;
+        handleGenerations[s.handleEntry]++;
+        freeHandles.push_back(s.handleEntry);
+    }
+    records.clear();
+    coursePool.clear();
+    planPool.clear();
+    idIndex.clear();
+    nameIndex.clear();
+    nameIndexReady = false;
+    for (int by = 0; by < NUM_STUDENT_ORDERS; by++) {
+        orders[by].clear();
+        orderReady[by] = false;
+    }
+    catalog.clear();
+    catalogReady = false;
+    ranking.clear();
+    rankingReady = false;
+    wastedCourses = 0;
+    wastedPlanEntries = 0;
+}
+
+void StudentStore::reserve(int numStudents, int numCourses, int numPlanEntries) {
+    records.reserve(numStudents);
+    idIndex.reserve(numStudents);
+    handleSlots.reserve(numStudents);
+    handleGenerations.reserve(numStudents);
+    coursePool.reserve(numCourses);
+    planPool.reserve(numPlanEntries);
+}
+
+// The GPA is kept current from a running sum of grade points, so course
+// changes cost O(1) instead of a walk over all of the student's courses
+
+void StudentStore::addCourse(int index, Course course) {
+    Student& s = records[index];
+    OrderKey before = orderKey(index);
+    double points = convertGradeTo4Scale(course.grade);
+    appendToBlock(coursePool, s.courseOffset, s.numCourses, s.courseCapacity,
+                  wastedCourses, std::move(course));
+    s.gradePoints += points;
+    s.gpa = calculateGPA(s.gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    if (catalogReady) {
+        const Course& added = coursePool[s.courseOffset + s.numCourses - 1];
+        bool newCourse = otherSlotOf(index, s.numCourses - 1) == -1;
+        int course = catalog.intern(added.nameId);
+        catalog.enroll(course, s.handleEntry, added.grade, newCourse);
+        // New groups are joined at the old GPA, then every group moves together
+        GpaRanking::Entry entry{ before.gpa, s.id, s.handleEntry };
+        if (rankingReady && newCourse) ranking.insert(course, entry);
+        if (rankingReady && s.numCourses == 1) ranking.insert(GpaRanking::OVERALL, entry);
+        rerank(index, before.gpa);
+    }
+    compactIfWasteful();
+    if (journal) journal->logStudent(JOURNAL_COURSE_ADD, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::removeCourse(int index, int courseIndex) {
+    Student& s = records[index];
+    OrderKey before = orderKey(index);
+    if (catalogReady) {
+        const Course& removed = coursePool[s.courseOffset + courseIndex];
+        bool lastSlot = otherSlotOf(index, courseIndex) == -1;
+        catalog.withdraw(catalog.find(removed.nameId), s.handleEntry, removed.grade, lastSlot);
+        if (rankingReady && lastSlot) ranking.erase(catalog.find(removed.nameId), s.gpa, s.id);
+        if (rankingReady && s.numCourses == 1) ranking.erase(GpaRanking::OVERALL, s.gpa, s.id);
+    }
+    s.gradePoints -= convertGradeTo4Scale(coursePool[s.courseOffset + courseIndex].grade);
+    removeFromBlock(coursePool, s.courseOffset, s.numCourses, courseIndex);
+    if (s.numCourses == 0) s.gradePoints = 0.0;   // Drop accumulated rounding error
+    s.gpa = calculateGPA(s.gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    rerank(index, before.gpa);
+    if (journal) journal->logStudent(JOURNAL_COURSE_REMOVE, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setCourseGrade(int index, int courseIndex, float grade) {
+    Student& s = records[index];
+    Course& course = coursePool[s.courseOffset + courseIndex];
+    OrderKey before = orderKey(index);
+    s.gradePoints += convertGradeTo4Scale(grade) - convertGradeTo4Scale(course.grade);
+    if (catalogReady) catalog.regrade(catalog.find(course.nameId), course.grade, grade);
+    course.grade = grade;
+    s.gpa = calculateGPA(s.gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    rerank(index, before.gpa);
+    if (journal) journal->logStudent(JOURNAL_MODIFY, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setCourseGrades(int index, const Course* grades, int count) {
+    Student& s = records[index];
+    OrderKey before = orderKey(index);
+    for (int g = 0; g < count; g++) {
+        const Course& update = grades[g];
+        int lowercaseId = courseNames.folded(update.nameId);
+        Course* studentCourses = coursePool.data() + s.courseOffset;
+        int slot = 0;
+        while (slot < s.numCourses && courseNames.folded(studentCourses[slot].nameId) != lowercaseId) slot++;
+
+        if (slot < s.numCourses) {
+            Course& course = studentCourses[slot];
+            s.gradePoints += convertGradeTo4Scale(update.grade) - convertGradeTo4Scale(course.grade);
+            if (catalogReady) catalog.regrade(catalog.find(course.nameId), course.grade, update.grade);
+            course.grade = update.grade;
+            continue;
+        }
+        appendToBlock(coursePool, s.courseOffset, s.numCourses, s.courseCapacity, wastedCourses, update);
+        s.gradePoints += convertGradeTo4Scale(update.grade);
+        if (catalogReady) {
+            int course = catalog.intern(update.nameId);
+            catalog.enroll(course, s.handleEntry, update.grade, true);
+            // New groups are joined at the old GPA; rerank() below moves them all
+            GpaRanking::Entry entry{ before.gpa, s.id, s.handleEntry };
+            if (rankingReady) ranking.insert(course, entry);
+            if (rankingReady && s.numCourses == 1) ranking.insert(GpaRanking::OVERALL, entry);
+        }
+    }
+    s.gpa = calculateGPA(s.gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    rerank(index, before.gpa);
+    compactIfWasteful();
+    if (journal) journal->logStudent(JOURNAL_COURSE_ADD, *this, index);
+    noteChange(index);
+}
+
+// First slot of a list with a course, by case-insensitive name, or -1
+static int slotOfCourse(const Course* list, int count, int lowercaseId) {
+    for (int c = 0; c < count; c++) {
+        if (courseNames.folded(list[c].nameId) == lowercaseId) return c;
+    }
+    return -1;
+}
+
+void StudentStore::setCoursesAndPlan(int index, const Course* newCourses, int numCourses,
+                                     const int* plan, int numPlan) {
+    Student& s = records[index];
+    OrderKey before = orderKey(index);
+    unrank(index);   // Ranked again below, at the new GPA and in the groups of the new courses
+    if (catalogReady) {
+        // Grades leave and join slot by slot, but a roster entry only leaves
+        // with a course the student no longer takes and only joins with one
+        // it did not take: removing an entry costs a scan of the roster
+        const Course* oldCourses = coursePool.data() + s.courseOffset;
+        for (int c = 0; c < s.numCourses; c++) {
+            int lowercaseId = courseNames.folded(oldCourses[c].nameId);
+            bool leaves = slotOfCourse(oldCourses, s.numCourses, lowercaseId) == c &&
+                          slotOfCourse(newCourses, numCourses, lowercaseId) == -1;
+            catalog.withdraw(catalog.find(oldCourses[c].nameId), s.handleEntry, oldCourses[c].grade, leaves);
+        }
+        for (int c = 0; c < numCourses; c++) {
+            int lowercaseId = courseNames.folded(newCourses[c].nameId);
+            bool joins = slotOfCourse(newCourses, numCourses, lowercaseId) == c &&
+                         slotOfCourse(oldCourses, s.numCourses, lowercaseId) == -1;
+            catalog.enroll(catalog.intern(newCourses[c].nameId), s.handleEntry, newCourses[c].grade, joins);
+        }
+    }
+
+    // Both blocks are refilled in place, growing only if they have to
+    s.numCourses = 0;
+    s.gradePoints = 0.0;
+    for (int c = 0; c < numCourses; c++) {
+        appendToBlock(coursePool, s.courseOffset, s.numCourses, s.courseCapacity, wastedCourses, newCourses[c]);
+        s.gradePoints += convertGradeTo4Scale(newCourses[c].grade);
+    }
+    s.numStudyPlan = 0;
+    for (int p = 0; p < numPlan; p++) {
+        appendToBlock(planPool, s.planOffset, s.numStudyPlan, s.planCapacity, wastedPlanEntries, plan[p]);
+    }
+    s.gpa = calculateGPA(s.gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    rank(index);
+    compactIfWasteful();
+    if (journal) journal->logStudent(JOURNAL_EDIT, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::addStudyPlanEntry(int index, string_view entry) {
+    Student& s = records[index];
+    appendToBlock(planPool, s.planOffset, s.numStudyPlan, s.planCapacity,
+                  wastedPlanEntries, courseNames.intern(entry));
+    compactIfWasteful();
+    if (journal) journal->logStudent(JOURNAL_PLAN_CHANGE, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::removeStudyPlanEntry(int index, int planIndex) {
+    Student& s = records[index];
+    removeFromBlock(planPool, s.planOffset, s.numStudyPlan, planIndex);
+    if (journal) journal->logStudent(JOURNAL_PLAN_CHANGE, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setName(int index, const string& name) {
+    if (nameIndexReady) {
+        nameIndex.erase(records[index].name);
+        nameIndex.insert(records[index].handleEntry, name);
+    }
+    string oldName;
+    OrderKey before = orderKey(index);
+    if (orderReady[ORDER_BY_NAME]) {
+        oldName = records[index].name;
+        before.name = &oldName;
+    }
+    records[index].name = name;
+    reorder(ORDER_BY_NAME, index, before);
+    if (journal) journal->logStudent(JOURNAL_MODIFY, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setNationalId(int index, const string& nationalId) {
+    records[index].nationalId = nationalId;
+    if (journal) journal->logStudent(JOURNAL_MODIFY, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setGpa(int index, float gpa) {
+    if (records[index].gpa == gpa) return;   // Nothing to record
+    OrderKey before = orderKey(index);
+    records[index].gpa = gpa;
+    reorder(ORDER_BY_GPA, index, before);
+    rerank(index, before.gpa);
+    if (journal) journal->logStudent(JOURNAL_MODIFY, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::setGradePoints(int index, double gradePoints) {
+    Student& s = records[index];
+    float oldGpa = s.gpa;
+    OrderKey before = orderKey(index);
+    s.gradePoints = gradePoints;
+    s.gpa = calculateGPA(gradePoints, s.numCourses);
+    reorder(ORDER_BY_GPA, index, before);
+    rerank(index, oldGpa);
+    if (s.gpa == oldGpa) return;
+    if (journal) journal->logStudent(JOURNAL_MODIFY, *this, index);
+    noteChange(index);
+}
+
+void StudentStore::compact() {
+    vector<Course> newCourses;
+    vector<int> newPlan;
+    newCourses.reserve(coursePool.size() - wastedCourses);
+    newPlan.reserve(planPool.size() - wastedPlanEntries);
+
+    // Lay out every block back to back in record order, trimmed to its size
+    for (Student& s : records) {
+        int courseOffset = (int)newCourses.size();
+        for (int i = 0; i < s.numCourses; i++) {
+            newCourses.push_back(coursePool[s.courseOffset + i]);
+        }
+        s.courseOffset = courseOffset;
+        s.courseCapacity = s.numCourses;
+
+        int planOffset = (int)newPlan.size();
+        for (int i = 0; i < s.numStudyPlan; i++) {
+            newPlan.push_back(planPool[s.planOffset + i]);
+        }
+        s.planOffset = planOffset;
+        s.planCapacity = s.numStudyPlan;
+    }
+
+    coursePool.swap(newCourses);
+    planPool.swap(newPlan);
+    wastedCourses = 0;
+    wastedPlanEntries = 0;
+
+    // Give back record memory left over from mass deletions
+    if (records.capacity() > 1024 && records.size() < records.capacity() / 4) {
+        records.shrink_to_fit();
+    }
+}
+
+void StudentStore::compactIfWasteful() {
+    const int minimumPool = 1024;   // Small pools are not worth compacting
+    bool coursesWasteful = coursePool.size() > (size_t)minimumPool &&
+                           wastedCourses * 2 > (int)coursePool.size();
+    bool planWasteful = planPool.size() > (size_t)minimumPool &&
+                        wastedPlanEntries * 2 > (int)planPool.size();
+    if (coursesWasteful || planWasteful) compact();
+}
+
+void StudentStore::permute(const vector<int>& order) {
+    vector<Student> reordered;
+    reordered.reserve(records.capacity());
+    for (int index : order) reordered.push_back(std::move(records[index]));
+    records.swap(reordered);
+    rebuildIndex();
+}
+
+void StudentStore::rebuildIndex() {
+    idIndex.clear();
+    idIndex.reserve((int)records.size());
+    for (int i = 0; i < (int)records.size(); i++) {
+        idIndex.insert(records[i].id, i);
+        handleSlots[records[i].handleEntry] = i;
+    }
+}
+
+// Maintained orders hold handle entries, which survive swap-and-pop and
+// sorting of the records; positions are found by binary search on the keys
+
+bool StudentStore::orderLess(StudentOrder by, const OrderKey& a, const OrderKey& b) {
+    switch (by) {
+        case ORDER_BY_NAME:
+            if (*a.name != *b.name) return *a.name < *b.name;
+            break;
+        case ORDER_BY_GPA:
+            if (a.gpa != b.gpa) return a.gpa > b.gpa;
+            break;
+        default:
+            break;
+    }
+    return a.id < b.id;   // IDs are unique, so every order is total
+}
+
+int StudentStore::orderPosition(StudentOrder by, const OrderKey& key, int moving,
+                                const OrderKey* movingKey) const {
+    const vector<int>& order = orders[by];
+    auto position = std::lower_bound(order.begin(), order.end(), key,
+        [&](int entry, const OrderKey& probe) {
+            if (entry == moving) return orderLess(by, *movingKey, probe);
+            return orderLess(by, orderKey(handleSlots[entry]), probe);
+        });
+    return (int)(position - order.begin());
+}
+
+StudentOrderView StudentStore::ordered(StudentOrder by) {
+    if (!orderReady[by]) {
+        // Sort record indices, then store the handle entries they map to
+        vector<int>& order = orders[by];
+        order.resize(records.size());
+        for (int i = 0; i < (int)records.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return orderLess(by, orderKey(a), orderKey(b));
+        });
+        for (int& index : order) index = records[index].handleEntry;
+        orderReady[by] = true;
+    }
+    return StudentOrderView(orders[by], handleSlots);
+}
+
+void StudentStore::prepareForReaders() {
+    for (int by = 0; by < NUM_STUDENT_ORDERS; by++) ordered((StudentOrder)by);
+    if (!nameIndexReady || nameIndex.wantsRebuild()) rebuildNameIndex();
+    courseCatalog();
+    gpaRanking();
+}
+
+void StudentStore::insertIntoOrders(int index) {
+    for (int by = 0; by < NUM_STUDENT_ORDERS; by++) {
+        if (!orderReady[by]) continue;
+        // The new student is not in the order yet, so it is never compared to itself
+        int position = orderPosition((StudentOrder)by, orderKey(index));
+        orders[by].insert(orders[by].begin() + position, records[index].handleEntry);
+    }
+}
+
+void StudentStore::eraseFromOrders(int index) {
+    for (int by = 0; by < NUM_STUDENT_ORDERS; by++) {
+        if (!orderReady[by]) continue;
+        int position = orderPosition((StudentOrder)by, orderKey(index));
+        orders[by].erase(orders[by].begin() + position);
+    }
+}
+
+void StudentStore::reorder(StudentOrder by, int index, const OrderKey& before) {
+    if (!orderReady[by]) return;
+    OrderKey after = orderKey(index);
+    if (!orderLess(by, before, after) && !orderLess(by, after, before)) return;
+
+    // Both searches see the student at its old key, which is where it still sits
+    int entry = records[index].handleEntry;
+    int from = orderPosition(by, before, entry, &before);
+    int to = orderPosition(by, after, entry, &before);
+    vector<int>& order = orders[by];
+    if (to > from) {
+        std::rotate(order.begin() + from, order.begin() + from + 1, order.begin() + to);
+    } else {
+        std::rotate(order.begin() + to, order.begin() + from, order.begin() + from + 1);
+    }
+}
+
+size_t StudentStore::memoryUsage() const {
+    size_t bytes = records.capacity() * sizeof(Student)
+                 + idIndex.memoryUsage()
+                 + nameIndex.memoryUsage()
+                 + catalog.memoryUsage()
+                 + ranking.memoryUsage()
+                 + (orders[ORDER_BY_ID].capacity() + orders[ORDER_BY_NAME].capacity()
+                    + orders[ORDER_BY_GPA].capacity()) * sizeof(int)
+                 + (handleSlots.capacity() + handleGenerations.capacity() + freeHandles.capacity()) * sizeof(int)
+                 + coursePool.capacity() * sizeof(Course)
+                 + planPool.capacity() * sizeof(int);
+    for (const Student& s : records) {
+        bytes += stringHeapBytes(s.name) + stringHeapBytes(s.nationalId);
+    }
+    return bytes;
+}